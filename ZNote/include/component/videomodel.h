@@ -39,11 +39,17 @@ public:
 	// ������/�еȲ���
 	void addTask(const DownloadTask& task);
 
+	// 一次插入一批任务，只通知视图一次
+	void addTasks(const QList<DownloadTask>& tasks);
+
 	// �����Ƴ�����ķ���
 	void removeTasks(const QList<int>& rows);
 
 	QList<DownloadTask*> getTasks() { return taskItems; }
 	
+	// 用按需解析得到的完整信息更新同一ID的行，保留保存路径和勾选状态
+	void updateTask(const DownloadTask& task);
+	
 	// 清空所有任务
 	void clear();
 
@@ -0,0 +1,85 @@
+/**
+ * @file concurrencycontroller.h
+ * @brief Throughput-driven concurrency tuning
+ *
+ * Adjusts the number of simultaneous downloads from measured aggregate
+ * throughput instead of a fixed guess.
+ */
+
+#ifndef CONCURRENCYCONTROLLER_H
+#define CONCURRENCYCONTROLLER_H
+
+#include <QString>
+
+/**
+ * @class ConcurrencyController
+ * @brief AIMD controller for the download concurrency level
+ *
+ * Samples are grouped into windows. After each window:
+ * - Any failed task halves the level (multiplicative decrease)
+ * - While the queue is saturated, the level is probed one step up
+ *   (additive increase); the probe is kept only if throughput improved
+ *   by at least 10%, otherwise it is reverted and probing pauses for a while
+ * - A probe that made throughput drop backs off by a quarter
+ *
+ * The first window after each change is discarded while new downloads ramp up.
+ * Every change records a human-readable reason.
+ */
+class ConcurrencyController
+{
+public:
+    ConcurrencyController();
+
+    /**
+     * @brief Set the allowed concurrency range
+     * @param minLevel Lowest level (at least 1)
+     * @param maxLevel Highest level
+     */
+    void setRange(int minLevel, int maxLevel);
+
+    /**
+     * @brief Restart tuning from a given level
+     * @param level Starting level (clamped to the range)
+     */
+    void reset(int level);
+
+    /**
+     * @brief Get the current level
+     * @return Concurrency level
+     */
+    int level() const;
+
+    /**
+     * @brief Get the reason for the last level change
+     * @return Description of the last decision
+     */
+    QString reason() const;
+
+    /**
+     * @brief Feed one throughput sample
+     * @param bytesPerSecond Aggregate download speed
+     * @param failures Tasks that failed since the previous sample
+     * @param saturated true if every slot was busy and tasks were waiting
+     * @return true if the level changed
+     */
+    bool addSample(qint64 bytesPerSecond, int failures, bool saturated);
+
+private:
+    bool evaluate(double throughput, int failures, bool saturated);
+    void changeLevel(int level, const QString &reason);
+
+    int m_level;                 ///< Current concurrency level
+    int m_min;                   ///< Lower bound
+    int m_max;                   ///< Upper bound
+    int m_samples;               ///< Samples in the current window
+    double m_sum;                ///< Throughput sum of the current window
+    int m_failures;              ///< Failures in the current window
+    bool m_saturated;            ///< Saturated during the whole window
+    double m_baseline;           ///< Throughput before the current probe
+    bool m_probing;              ///< Last change was a probe upwards
+    int m_settle;                ///< Windows to discard after a change
+    int m_cooldown;              ///< Windows to wait before probing again
+    QString m_reason;            ///< Reason for the last change
+};
+
+#endif // CONCURRENCYCONTROLLER_H
@@ -0,0 +1,148 @@
+/**
+ * @file downloaderpool.h
+ * @brief Pool of long-lived download workers
+ *
+ * Keeps a set of worker threads, each hosting one reusable VideoDownloader,
+ * so that the task queue does not create and destroy a thread per task.
+ */
+
+#ifndef DOWNLOADERPOOL_H
+#define DOWNLOADERPOOL_H
+
+#include "core/download/task.h"
+#include <QObject>
+#include <QList>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+
+class QThread;
+class VideoDownloader;
+class ProcessReactor;
+
+/**
+ * @class DownloaderPool
+ * @brief Fixed-size (resizable) pool of downloader workers
+ *
+ * Features:
+ * - Workers are created lazily and reused across tasks
+ * - Live resize: idle workers are retired immediately, busy ones on release
+ * - Downloader signals are forwarded once, no per-task connections
+ * - Optional reactor mode: all downloaders share one I/O thread whose event
+ *   loop multiplexes every child pipe, and events arrive in batches
+ *
+ * The pool itself is not thread-safe and must be used from its owner thread.
+ */
+class DownloaderPool : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Construct DownloaderPool
+     * @param size Maximum number of workers
+     * @param parent Parent QObject
+     */
+    explicit DownloaderPool(int size, QObject *parent = nullptr);
+    ~DownloaderPool() override;
+
+    /**
+     * @brief Change the maximum number of workers
+     * @param size New worker count (at least 1)
+     */
+    void resize(int size);
+
+    /**
+     * @brief Get the maximum number of workers
+     * @return Worker limit
+     */
+    int size() const;
+
+    /**
+     * @brief Get number of workers currently running a task
+     * @return Busy worker count
+     */
+    int busyCount() const;
+
+    /**
+     * @brief Switch between thread-per-worker and single I/O thread mode
+     *
+     * Idle workers are rebuilt in the new mode immediately, busy ones when
+     * their current task finishes.
+     *
+     * @param enabled true to host all downloaders on one reactor thread
+     */
+    void setReactorMode(bool enabled);
+
+    /**
+     * @brief Check if reactor mode is active
+     * @return true if downloaders share one I/O thread
+     */
+    bool isReactorMode() const;
+
+    /**
+     * @brief Take an idle worker, spawning one if below the limit
+     * @return Downloader ready for dispatch, or nullptr if none available
+     */
+    VideoDownloader *acquire();
+
+    /**
+     * @brief Return a worker to the pool after its task finished
+     * @param downloader Worker previously obtained from acquire()
+     */
+    void release(VideoDownloader *downloader);
+
+    /**
+     * @brief Start a task on an acquired worker (runs in the worker thread)
+     * @param downloader Acquired worker
+     * @param task Task to download
+     */
+    void dispatch(VideoDownloader *downloader, const DownloadTask &task);
+
+    /**
+     * @brief Start several tasks in one yt-dlp process on an acquired worker
+     * @param downloader Acquired worker
+     * @param tasks Tasks sharing save path, format and rate limit
+     */
+    void dispatch(VideoDownloader *downloader, const QList<DownloadTask> &tasks);
+
+signals:
+    /**
+     * @brief Forwarded log lines from any worker
+     *
+     * Each batch delivered by a worker (or the reactor) arrives as one
+     * message with one line per log entry.
+     *
+     * @param msg Log message
+     */
+    void logMessage(const QString &msg);
+
+    /**
+     * @brief Forwarded progress from any worker
+     * @param downloader Worker reporting progress
+     * @param progress Parsed yt-dlp progress
+     */
+    void progressUpdated(VideoDownloader *downloader, const DownloadProgress &progress);
+
+    /**
+     * @brief Forwarded task completion from any worker
+     * @param downloader Worker that finished
+     * @param task Completed task
+     */
+    void taskFinished(VideoDownloader *downloader, const DownloadTask &task);
+
+private:
+    void onLogBatch(const QStringList &messages);
+    VideoDownloader *spawnWorker();
+    void retireWorker(VideoDownloader *downloader);
+    QThread *ensureIoThread();
+
+    QThread *m_ioThread;                           ///< Shared thread in reactor mode
+    ProcessReactor *m_reactor;                     ///< Event batcher on m_ioThread
+    QHash<VideoDownloader*, QThread*> m_threads;   ///< Worker -> hosting thread
+    QList<VideoDownloader*> m_idle;                ///< Workers waiting for a task
+    QSet<VideoDownloader*> m_busy;                 ///< Workers running a task
+    int m_size;                                    ///< Worker limit
+    bool m_reactorMode;                            ///< Share one I/O thread
+};
+
+#endif // DOWNLOADERPOOL_H
@@ -0,0 +1,96 @@
+/**
+ * @file entryresolver.h
+ * @brief On-demand metadata resolution for flat playlist entries
+ *
+ * A flat playlist listing (yt-dlp --flat-playlist) only carries IDs, titles
+ * and links. EntryResolver fetches the full metadata (formats, sizes,
+ * thumbnails) of the entries the user is looking at or has selected,
+ * several at a time, instead of resolving the whole playlist up front.
+ */
+
+#ifndef ENTRYRESOLVER_H
+#define ENTRYRESOLVER_H
+
+#include "core/download/task.h"
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QProcess>
+#include <QSet>
+
+/**
+ * @class EntryResolver
+ * @brief Bounded pool of single-video yt-dlp resolutions
+ *
+ * setWanted() replaces the set of entries to resolve: selected entries are
+ * resolved first, then visible ones. Entries that scrolled out of view
+ * before their turn are dropped; running resolutions are never interrupted.
+ * An entry that is already running is not started again, and a failed one
+ * is logged and not retried until cancel(), since yt-dlp resolves the
+ * entry again when it is downloaded. Several listings (parse requests) can
+ * feed the same resolver.
+ *
+ * Each resolution runs "yt-dlp -J --no-playlist <url>" under the Parse
+ * process policy. Signals from the thread it lives in (the parse thread,
+ * see ParseWorker).
+ */
+class EntryResolver : public QObject
+{
+    Q_OBJECT
+public:
+    explicit EntryResolver(QObject *parent = nullptr);
+
+    /**
+     * @brief Kill running resolutions
+     */
+    ~EntryResolver() override;
+
+    /**
+     * @brief Set how many entries are resolved at once
+     * @param jobs Concurrent yt-dlp processes (at least 1)
+     */
+    void setMaxJobs(int jobs);
+
+    /**
+     * @brief Replace the entries waiting for resolution
+     * @param selected Entries selected for download (resolved first)
+     * @param visible Entries currently shown
+     */
+    void setWanted(const QList<ParsedEntry> &selected, const QList<ParsedEntry> &visible);
+
+    /**
+     * @brief Forget all entries (including failures) and kill running resolutions
+     */
+    void cancel();
+
+    /**
+     * @brief Check if nothing is queued or running
+     * @return true when idle
+     */
+    bool isIdle() const;
+
+signals:
+    /**
+     * @brief Full metadata of an entry is available
+     * @param entry Resolved entry (playlist position copied from the flat entry)
+     */
+    void entryResolved(const ParsedEntry &entry);
+
+    /**
+     * @brief Diagnostic output
+     * @param msg Log message
+     */
+    void logMessage(const QString &msg);
+
+private:
+    void startNext();
+    void onFinished(QProcess *process, int exitCode, QProcess::ExitStatus exitStatus);
+
+    QList<ParsedEntry> m_selected;              ///< Waiting, selected
+    QList<ParsedEntry> m_visible;               ///< Waiting, visible
+    QHash<QProcess *, ParsedEntry> m_running;   ///< Running process -> flat entry
+    QSet<QString> m_started;                    ///< IDs running or failed since the last cancel()
+    int m_maxJobs;                              ///< Concurrency limit
+};
+
+#endif // ENTRYRESOLVER_H
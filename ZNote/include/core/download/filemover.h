@@ -0,0 +1,105 @@
+/**
+ * @file filemover.h
+ * @brief Background transfer of finished downloads out of the staging area
+ *
+ * Moves files from the staging directory (a fast local disk) to the task's
+ * save path on worker threads, so slow destinations such as network shares
+ * never see interleaved in-flight writes.
+ */
+
+#ifndef FILEMOVER_H
+#define FILEMOVER_H
+
+#include "core/download/task.h"
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <atomic>
+#include <functional>
+
+/**
+ * @class FileMover
+ * @brief Moves DownloadTask::files into DownloadTask::savePath
+ *
+ * A file on the same filesystem is renamed. Otherwise it is copied
+ * (copy_file_range() on Linux, chunked read/write elsewhere) into a
+ * temporary name next to the destination, which is renamed into place
+ * once complete, so the final path never holds a partial file. The source
+ * is removed only after a successful copy.
+ *
+ * Jobs run on a private thread pool whose size is the I/O concurrency
+ * limit. finished() and progress() are delivered in the thread that
+ * created the mover.
+ */
+class FileMover : public QObject
+{
+    Q_OBJECT
+public:
+    explicit FileMover(QObject *parent = nullptr);
+
+    /**
+     * @brief Abort running copies (the sources stay in staging) and wait for the workers
+     */
+    ~FileMover() override;
+
+    /**
+     * @brief Set how many tasks are moved at once
+     * @param jobs Concurrent move jobs (at least 1)
+     */
+    void setMaxJobs(int jobs);
+
+    /**
+     * @brief Queue a task's files for moving
+     * @param task Task with DownloadTask::files in the staging directory
+     */
+    void enqueue(const DownloadTask &task);
+
+    /**
+     * @brief Check if no job is queued or running
+     * @return true when idle
+     */
+    bool isIdle() const;
+
+    /**
+     * @brief Move one file (blocking)
+     * @param from Source path
+     * @param to Destination path (replaced if it exists; kept if the move fails)
+     * @param progress Called with bytes moved and total bytes
+     * @param stop Aborts a copy when set
+     * @param error Set on failure
+     * @return true on success
+     */
+    static bool moveFile(const QString &from, const QString &to,
+                         const std::function<void(qint64, qint64)> &progress,
+                         const std::atomic<bool> &stop, QString *error);
+
+signals:
+    /**
+     * @brief A task's files were moved (or the move failed)
+     * @param task Task with updated DownloadTask::files and status
+     */
+    void finished(const DownloadTask &task);
+
+    /**
+     * @brief Move progress of one task (throttled)
+     * @param taskId Task ID
+     * @param moved Bytes moved
+     * @param total Bytes to move
+     */
+    void progress(const QString &taskId, qint64 moved, qint64 total);
+
+    /**
+     * @brief Diagnostic output
+     * @param msg Log message
+     */
+    void logMessage(const QString &msg);
+
+private:
+    void run(DownloadTask task);
+
+    QThreadPool m_pool;                 ///< I/O workers
+    std::atomic<bool> m_stopping;       ///< Set on destruction
+    int m_active;                       ///< Jobs not yet reported (owner thread only)
+};
+
+#endif // FILEMOVER_H
@@ -0,0 +1,109 @@
+/**
+ * @file hostadmission.h
+ * @brief Per-host concurrency limits and request-rate admission
+ *
+ * Decides whether a task may start now based on how many downloads are
+ * already running against its host and a per-host token bucket.
+ */
+
+#ifndef HOSTADMISSION_H
+#define HOSTADMISSION_H
+
+#include <QHash>
+#include <QString>
+
+/**
+ * @class HostAdmission
+ * @brief Per-host slot counting plus token-bucket rate limiting
+ *
+ * A task is admitted when its host is below the per-host concurrency limit
+ * and the host's bucket holds a token. Buckets refill continuously at the
+ * configured rate up to the burst size. A limit or rate of 0 disables the
+ * corresponding check.
+ *
+ * Not thread-safe; TaskQueue guards it with its own mutex.
+ */
+class HostAdmission
+{
+public:
+    HostAdmission();
+
+    /**
+     * @brief Set the maximum number of concurrent downloads per host
+     * @param max Limit (0 = unlimited)
+     */
+    void setMaxPerHost(int max);
+
+    /**
+     * @brief Configure the per-host token bucket
+     * @param perSecond Download starts allowed per second (0 = unlimited)
+     * @param burst Maximum tokens a host can accumulate (at least 1)
+     */
+    void setRequestRate(double perSecond, int burst);
+
+    /**
+     * @brief Check whether any per-host check is active
+     * @return true if a limit or a rate is configured
+     */
+    bool isEnabled() const;
+
+    /**
+     * @brief Try to admit one download for a host
+     *
+     * On success a slot and a token are consumed. On failure nothing is
+     * consumed and retryInMs tells when a token will be available
+     * (-1 if the host is blocked by its concurrency limit instead).
+     *
+     * @param host Host key from hostOf()
+     * @param nowMs Current monotonic time in milliseconds
+     * @param retryInMs Output: wait before retrying, or -1
+     * @return true if the download may start
+     */
+    bool tryAcquire(const QString &host, qint64 nowMs, qint64 *retryInMs = nullptr);
+
+    /**
+     * @brief Release the slot of a finished download
+     * @param host Host key from hostOf()
+     */
+    void release(const QString &host);
+
+    /**
+     * @brief Undo a successful tryAcquire() whose download never started
+     *
+     * Releases the slot and puts the consumed token back into the bucket.
+     *
+     * @param host Host key from hostOf()
+     */
+    void refund(const QString &host);
+
+    /**
+     * @brief Get number of running downloads for a host
+     * @param host Host key from hostOf()
+     * @return Running count
+     */
+    int running(const QString &host) const;
+
+    /**
+     * @brief Derive the admission key for a video URL
+     * @param url Video page URL
+     * @return Lower-case host without "www."/"m." prefix
+     */
+    static QString hostOf(const QString &url);
+
+private:
+    struct Bucket
+    {
+        double tokens = 0.0;
+        qint64 lastRefillMs = 0;
+    };
+
+    void refill(Bucket &bucket, qint64 nowMs) const;
+
+    QHash<QString, int> m_running;       ///< Host -> running downloads
+    QHash<QString, Bucket> m_buckets;    ///< Host -> token bucket
+    int m_maxPerHost;                    ///< Concurrency limit per host
+    double m_rate;                       ///< Tokens per second
+    int m_burst;                         ///< Bucket capacity
+};
+
+#endif // HOSTADMISSION_H
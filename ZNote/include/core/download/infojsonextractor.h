@@ -0,0 +1,47 @@
+/**
+ * @file infojsonextractor.h
+ * @brief Single-pass extraction of the fields UrlParser needs from yt-dlp info JSON
+ *
+ * A yt-dlp info line is often hundreds of kilobytes, mostly formats,
+ * thumbnails and HTTP headers. Building a full QJsonDocument for it costs
+ * far more than the dozen fields a parsed entry actually uses.
+ */
+
+#ifndef INFOJSONEXTRACTOR_H
+#define INFOJSONEXTRACTOR_H
+
+#include <QByteArrayView>
+#include <QJsonObject>
+#include <QString>
+
+/**
+ * @class InfoJsonExtractor
+ * @brief Scans an info JSON object and keeps only the fields parseSingleEntry() reads
+ *
+ * The scanner walks the raw bytes once. Values of unneeded keys are skipped
+ * without being decoded (strings are not unescaped, numbers not converted,
+ * nested objects not built). Of "formats" only format_id, ext, vcodec,
+ * acodec, height, filesize and filesize_approx are kept per format.
+ *
+ * The result is a small QJsonObject with the same keys, values and null
+ * entries the full document would have, so UrlParser::parseSingleEntry()
+ * produces identical entries from it. The NaN, Infinity and -Infinity
+ * tokens that Python's json module writes for non-finite floats are
+ * accepted and read as null (QJsonDocument rejects the whole line).
+ * Stateless and thread-safe.
+ */
+class InfoJsonExtractor
+{
+public:
+    /**
+     * @brief Extract the needed fields of one info object
+     * @param json One JSON object (e.g. a --dump-json line), surrounding whitespace allowed
+     * @param info Set to the projected object on success
+     * @param error Set to a description with the byte offset on failure (may be null)
+     * @return true if json is an object; skipped values are only checked for
+     *         terminated strings and balanced brackets
+     */
+    static bool extract(QByteArrayView json, QJsonObject *info, QString *error = nullptr);
+};
+
+#endif // INFOJSONEXTRACTOR_H
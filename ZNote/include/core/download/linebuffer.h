@@ -0,0 +1,81 @@
+/**
+ * @file linebuffer.h
+ * @brief Allocation-free line splitting for child process output
+ *
+ * Reads pipe data into a fixed buffer and hands out complete lines as
+ * views into that buffer, so hot output such as progress ticks is parsed
+ * without creating a QByteArray or QString per line.
+ */
+
+#ifndef LINEBUFFER_H
+#define LINEBUFFER_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+
+class QIODevice;
+
+/**
+ * @class LineBuffer
+ * @brief Fixed-capacity byte buffer that yields '\n'-terminated lines
+ *
+ * Usage:
+ * @code
+ * while (buffer.readFrom(device) > 0) {
+ *     QByteArrayView line;
+ *     while (buffer.nextLine(&line)) {
+ *         // line is valid until the next readFrom()
+ *     }
+ * }
+ * @endcode
+ *
+ * Consumed bytes are reclaimed by moving the unread tail to the front
+ * before each read. The buffer grows (doubling) only while a single line
+ * does not fit, up to the maximum capacity; a line longer than that is
+ * returned in maximum-sized pieces.
+ */
+class LineBuffer
+{
+public:
+    /**
+     * @brief Construct LineBuffer
+     * @param capacity Initial buffer size in bytes
+     * @param maxCapacity Largest size the buffer may grow to (0 = capacity)
+     */
+    explicit LineBuffer(int capacity = 64 * 1024, int maxCapacity = 0);
+
+    /**
+     * @brief Read as much as fits from a device
+     * @param device Source (e.g. a QProcess read channel)
+     * @return Bytes read; 0 if nothing was available or the buffer is full
+     */
+    qint64 readFrom(QIODevice *device);
+
+    /**
+     * @brief Take the next complete line (without the newline)
+     * @param line Output view into the buffer
+     * @return true if a line was available
+     */
+    bool nextLine(QByteArrayView *line);
+
+    /**
+     * @brief Take whatever is left, complete line or not
+     * @param line Output view into the buffer
+     * @return true if any bytes were left
+     */
+    bool takeRemainder(QByteArrayView *line);
+
+    /**
+     * @brief Drop all buffered bytes
+     */
+    void clear();
+
+private:
+    QByteArray m_data;      ///< Storage, reallocated only to fit a long line
+    qsizetype m_max;        ///< Growth limit
+    qsizetype m_begin;      ///< First unconsumed byte
+    qsizetype m_scan;       ///< Where the next newline search starts
+    qsizetype m_end;        ///< One past the last valid byte
+};
+
+#endif // LINEBUFFER_H
@@ -0,0 +1,160 @@
+/**
+ * @file parsecache.h
+ * @brief On-disk cache of URL parse results
+ *
+ * Keeps the compact ParsedEntry fields of every parsed video, keyed by
+ * normalised URL and video ID, so parsing a URL again does not re-run
+ * yt-dlp and re-download megabytes of metadata.
+ */
+
+#ifndef PARSECACHE_H
+#define PARSECACHE_H
+
+#include "core/download/task.h"
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+
+class QJsonObject;
+
+/**
+ * @class ParseCache
+ * @brief TTL- and size-bounded metadata cache with LRU eviction
+ *
+ * A URL record stores the video IDs (and playlist positions) that the URL
+ * expanded to; a video record stores the per-video fields. A playlist and
+ * the single-video URLs of its entries therefore share video records.
+ *
+ * Entries older than the TTL are reported as stale; callers may show them
+ * and re-parse in the background. When more than the maximum number of
+ * videos are cached, the least recently used ones are evicted, and URL
+ * records that reference an evicted video become misses.
+ *
+ * Flat playlist listings are stored unresolved; storing one never replaces
+ * a video's resolved metadata.
+ *
+ * The file is a single JSON document, loaded on first use and rewritten
+ * atomically (QSaveFile) by store() and on destruction. Thread-safe.
+ */
+class ParseCache
+{
+public:
+    /**
+     * @brief Result of a lookup
+     */
+    enum class Lookup
+    {
+        Miss,       ///< Not cached (or incomplete after eviction)
+        Fresh,      ///< Cached within the TTL
+        Stale       ///< Cached, but older than the TTL
+    };
+
+    /**
+     * @brief Construct ParseCache
+     * @param path Cache file path (empty = defaultPath())
+     */
+    explicit ParseCache(const QString &path = QString());
+    ~ParseCache();
+
+    /**
+     * @brief Set how long parse results stay fresh
+     * @param seconds Time to live (0 = results never expire)
+     */
+    void setTtl(qint64 seconds);
+
+    /**
+     * @brief Set the size cap
+     * @param videos Maximum cached videos (at least 1)
+     */
+    void setMaxEntries(int videos);
+
+    /**
+     * @brief Look up the entries a URL expands to
+     * @param url URL as entered by the user
+     * @param entries Set to the cached entries on a hit
+     * @return Miss, Fresh or Stale
+     */
+    Lookup lookup(const QString &url, QList<ParsedEntry> *entries);
+
+    /**
+     * @brief Record a successful parse (replaces the URL's previous record)
+     * @param url URL as entered by the user
+     * @param entries Parsed entries
+     */
+    void store(const QString &url, const QList<ParsedEntry> &entries);
+
+    /**
+     * @brief Replace the metadata of one video, e.g. after resolving a flat entry
+     *
+     * Written by the next store() or save(), not immediately.
+     *
+     * @param entry Resolved entry
+     */
+    void update(const ParsedEntry &entry);
+
+    /**
+     * @brief Write the cache file if it changed
+     * @return true on success (or nothing to write)
+     */
+    bool save();
+
+    /**
+     * @brief Normalise a URL for use as a cache key
+     *
+     * Lower-cases the scheme and host, drops a leading "www." or "m.", the
+     * fragment, tracking parameters (utm_*, si, feature) and a trailing
+     * slash, and sorts the remaining query parameters.
+     *
+     * @param url URL
+     * @return Cache key
+     */
+    static QString normalizeUrl(const QString &url);
+
+    /**
+     * @brief Get default cache path (next to the history file)
+     * @return Cache file path
+     */
+    static QString defaultPath();
+
+private:
+    struct Position
+    {
+        QString id;
+        int index = 1;
+    };
+
+    struct UrlRecord
+    {
+        QList<Position> entries;    // 展开得到的视频（按播放列表顺序）
+        UrlType type = UrlType::Single;
+        QString playlistTitle;
+        int playlistCount = 1;
+        qint64 fetched = 0;         // 解析时间（毫秒）
+        qint64 used = 0;            // 最近一次使用（毫秒）
+    };
+
+    struct VideoRecord
+    {
+        ParsedEntry entry;          // 与播放列表无关的字段
+        qint64 used = 0;
+    };
+
+    void loadLocked();
+    bool saveLocked();
+    void evictLocked();
+
+    static QJsonObject videoToJson(const VideoRecord &video);
+    static VideoRecord videoFromJson(const QJsonObject &json);
+
+    QString m_path;                         ///< Cache file path
+    QHash<QString, UrlRecord> m_urls;       ///< Normalised URL -> expansion
+    QHash<QString, VideoRecord> m_videos;   ///< Video ID -> metadata
+    qint64 m_ttl;                           ///< Freshness in milliseconds (0 = forever)
+    int m_maxEntries;                       ///< Maximum cached videos
+    bool m_loaded;                          ///< File read
+    bool m_dirty;                           ///< Changed since the last save
+    mutable QMutex m_mutex;                 ///< Guards all state
+};
+
+#endif // PARSECACHE_H
@@ -0,0 +1,143 @@
+/**
+ * @file parseworker.h
+ * @brief URL parsing on a dedicated thread
+ *
+ * Parsing a large playlist produces thousands of entries in a few seconds.
+ * ParseWorker runs the whole parse pipeline (yt-dlp processes, line
+ * splitting, JSON decoding and on-demand resolution) on its own thread and
+ * hands the results to the owner thread in batches, so the GUI thread only
+ * ever sees a few events per interval.
+ */
+
+#ifndef PARSEWORKER_H
+#define PARSEWORKER_H
+
+#include "core/download/task.h"
+#include <QAtomicInt>
+#include <QList>
+#include <QObject>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+
+class QTimer;
+class UrlParserPool;
+class EntryResolver;
+class ParseCache;
+
+/**
+ * @class ParseWorker
+ * @brief Owns the UrlParserPool and EntryResolver on the parse thread
+ *
+ * Configure the worker (pool(), resolver(), setCache()) before moving it to
+ * its thread; the pool and resolver are children and move with it. After
+ * that only parse(), cancel() and setWanted() may be called from other
+ * threads; they queue the work to the parse thread.
+ *
+ * Parsed entries and log lines are buffered and flushed at most once per
+ * interval, split into batches of bounded size so that handling one batch
+ * stays cheap on the receiving thread. An error or the end of a request
+ * flushes pending entries first, so per request the order of entries,
+ * errors and finished() is preserved.
+ */
+class ParseWorker : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Construct ParseWorker
+     * @param flushIntervalMs Maximum delay before buffered entries are delivered
+     * @param parent Parent QObject (must be null to move the worker to a thread)
+     */
+    explicit ParseWorker(int flushIntervalMs = 50, QObject *parent = nullptr);
+
+    /**
+     * @brief Parser pool, to be configured before the worker is moved
+     * @return Pool owned by the worker
+     */
+    UrlParserPool *pool() const;
+
+    /**
+     * @brief Entry resolver, to be configured before the worker is moved
+     * @return Resolver owned by the worker
+     */
+    EntryResolver *resolver() const;
+
+    /**
+     * @brief Set the cache updated with resolved entries
+     * @param cache Cache (not owned, nullptr = none); must outlive the worker
+     */
+    void setCache(ParseCache *cache);
+
+    /**
+     * @brief Queue URLs for parsing (thread-safe)
+     * @param urls URLs
+     * @return One request ID per URL, valid before any signal for it
+     */
+    QStringList parse(const QStringList &urls);
+
+    /**
+     * @brief Drop a queued request or stop a running one (thread-safe)
+     * @param requestId Request ID
+     */
+    void cancel(const QString &requestId);
+
+    /**
+     * @brief Replace the flat entries waiting for resolution (thread-safe)
+     * @param selected Entries selected for download (resolved first)
+     * @param visible Entries currently shown
+     */
+    void setWanted(const QList<ParsedEntry> &selected, const QList<ParsedEntry> &visible);
+
+signals:
+    /**
+     * @brief Entries of one request parsed since the last flush
+     * @param requestId Request ID
+     * @param entries Entries in output order
+     */
+    void entriesParsed(const QString &requestId, const QList<ParsedEntry> &entries);
+
+    /**
+     * @brief A request failed (or part of it)
+     * @param requestId Request ID
+     * @param error Error message
+     */
+    void errorOccurred(const QString &requestId, const QString &error);
+
+    /**
+     * @brief A request ended, after all its entries and errors
+     * @param requestId Request ID
+     */
+    void finished(const QString &requestId);
+
+    /**
+     * @brief Full metadata of a flat entry is available (already cached)
+     * @param entry Resolved entry
+     */
+    void entryResolved(const ParsedEntry &entry);
+
+    /**
+     * @brief Log lines collected since the last flush
+     * @param messages Log lines in arrival order
+     */
+    void logBatch(const QStringList &messages);
+
+private:
+    void onEntryParsed(const QString &requestId, const ParsedEntry &entry);
+    void onErrorOccurred(const QString &requestId, const QString &error);
+    void onFinished(const QString &requestId);
+    void onEntryResolved(const ParsedEntry &entry);
+    void onLogMessage(const QString &message);
+    void scheduleFlush();
+    void flush();
+
+    UrlParserPool *m_pool;                  ///< Parses the queued URLs
+    EntryResolver *m_resolver;              ///< Resolves flat entries on demand
+    ParseCache *m_cache;                    ///< Updated with resolved entries (may be null)
+    QAtomicInt m_requestCount;              ///< Requests issued, for IDs
+    QList<QPair<QString, QList<ParsedEntry>>> m_pendingEntries; ///< Request ID -> entries, in arrival order
+    QStringList m_pendingLogs;              ///< Lines waiting for the next flush
+    QTimer *m_flushTimer;                   ///< Single-shot flush timer (parse thread)
+};
+
+#endif // PARSEWORKER_H
@@ -0,0 +1,142 @@
+/**
+ * @file postprocessor.h
+ * @brief CPU-bound post-processing stage of the download pipeline
+ *
+ * Merges separately downloaded video and audio streams, embeds thumbnails
+ * and subtitles and optionally transcodes, with ffmpeg processes that run
+ * outside the download slots.
+ */
+
+#ifndef POSTPROCESSOR_H
+#define POSTPROCESSOR_H
+
+#include "core/download/task.h"
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+class QProcess;
+
+/**
+ * @class PostProcessor
+ * @brief Queue of ffmpeg jobs with its own concurrency limit
+ *
+ * When post-processing is deferred (see shouldDefer()), yt-dlp downloads
+ * each format to its own file and exits as soon as the bytes have arrived,
+ * so TaskQueue can hand the network slot to the next task. The finished
+ * task, with DownloadTask::files filled in, is then enqueued here; one
+ * ffmpeg call per task remuxes the streams (and sidecar thumbnail and
+ * subtitle files) into the final container and removes the inputs.
+ *
+ * Up to Settings::maxJobs jobs run at once (default: one per core). When
+ * transcoding, ffmpeg's own threads are divided between the jobs so the
+ * stage as a whole stays at about one thread per core.
+ *
+ * Lives in the thread that created it.
+ */
+class PostProcessor : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Process-wide post-processing configuration
+     */
+    struct Settings
+    {
+        bool enabled = false;           ///< Defer merging to this stage
+        int maxJobs = 0;                ///< Concurrent ffmpeg jobs (0 = number of cores)
+        QString mergeFormat = "mp4";    ///< Output container
+        bool embedThumbnail = false;    ///< Download and embed the thumbnail
+        bool embedSubtitles = false;    ///< Download and embed subtitles
+        QString transcodeArgs;          ///< Extra ffmpeg codec arguments (empty = stream copy)
+    };
+
+    /**
+     * @brief Replace the settings used for tasks dispatched from now on
+     * @param settings New settings
+     */
+    static void setSettings(const Settings &settings);
+
+    /**
+     * @brief Get the current settings (thread-safe)
+     * @return Settings
+     */
+    static Settings settings();
+
+    /**
+     * @brief Get the ffmpeg found by ToolRegistry
+     * @return Executable path, or empty if not found
+     */
+    static QString ffmpegPath();
+
+    /**
+     * @brief Check if a task's post-processing should run in this stage
+     *
+     * True when the stage is enabled, ffmpeg is available, the task uses
+     * the yt-dlp backend and it needs merging, embedding or transcoding.
+     *
+     * @param task Task about to be dispatched
+     * @return true to download the streams separately
+     */
+    static bool shouldDefer(const DownloadTask &task);
+
+    explicit PostProcessor(QObject *parent = nullptr);
+    ~PostProcessor() override;
+
+    /**
+     * @brief Queue a downloaded task for post-processing
+     * @param task Task with DownloadTask::files
+     */
+    void enqueue(const DownloadTask &task);
+
+    /**
+     * @brief Drop queued jobs and kill running ones
+     *
+     * Every affected task is reported through finished() as canceled; the
+     * downloaded stream files are kept.
+     */
+    void cancelAll();
+
+    /**
+     * @brief Check if no job is queued or running
+     * @return true when idle
+     */
+    bool isIdle() const;
+
+signals:
+    /**
+     * @brief A task left the stage
+     * @param task Task with its final status; on success DownloadTask::files
+     *             holds only the output file
+     */
+    void finished(const DownloadTask &task);
+
+    /**
+     * @brief Diagnostic output
+     * @param msg Log message
+     */
+    void logMessage(const QString &msg);
+
+private:
+    struct Job
+    {
+        DownloadTask task;
+        QString output;         // 最终文件
+        QString temp;           // ffmpeg 写入的临时文件
+        QStringList inputs;     // 成功后删除的输入文件
+        QByteArray errors;      // ffmpeg 的错误输出
+        bool canceled = false;
+    };
+
+    void startNext();
+    void run(const DownloadTask &task);
+    void handleFinished(QProcess *process);
+    void complete(DownloadTask task, DownloadStatus status);
+
+    QList<DownloadTask> m_queue;        ///< Waiting for a free job slot
+    QHash<QProcess*, Job> m_running;    ///< Running ffmpeg processes
+};
+
+#endif // POSTPROCESSOR_H
@@ -0,0 +1,127 @@
+/**
+ * @file processpolicy.h
+ * @brief Resource limits for spawned yt-dlp, helper and ffmpeg processes
+ *
+ * Lowers the CPU and I/O priority of child processes, optionally pins
+ * them to a CPU set and places them in a cgroup v2 with memory and CPU
+ * caps, so a full download queue does not starve the GUI.
+ */
+
+#ifndef PROCESSPOLICY_H
+#define PROCESSPOLICY_H
+
+#include <QList>
+#include <QString>
+
+class QProcess;
+
+/**
+ * @class ProcessPolicy
+ * @brief Per-stage policy applied to child processes before exec
+ *
+ * apply() installs a child process modifier that runs in the forked child:
+ * it moves the child into its own process group (so suspend/resume reach
+ * the ffmpeg processes it starts), then applies the stage's nice level,
+ * I/O priority (Linux ioprio_set()), CPU affinity (Linux
+ * sched_setaffinity()) and cgroup placement. Grandchildren inherit all of
+ * these. Failures are ignored in the child, e.g. raising the priority
+ * without privileges simply has no effect.
+ *
+ * Cgroups are created by setSettings() as <cgroupRoot>/<stage> with the
+ * configured memory.max and cpu.max; the root must be a delegated, writable
+ * cgroup v2 directory that holds no processes itself.
+ *
+ * On Windows apply() does nothing.
+ */
+class ProcessPolicy
+{
+public:
+    /**
+     * @brief Pipeline stage a process belongs to
+     */
+    enum class Stage
+    {
+        Download,       ///< yt-dlp downloads, direct-URL resolution and download helpers
+        Parse,          ///< URL parsing and parse helpers
+        PostProcess     ///< ffmpeg merge/embed/transcode jobs
+    };
+
+    /**
+     * @brief Linux I/O scheduling class
+     */
+    enum class IoClass
+    {
+        None = 0,       ///< Inherit from the application
+        Realtime = 1,   ///< Needs CAP_SYS_ADMIN
+        BestEffort = 2, ///< Default class; ioLevel sets the priority within it
+        Idle = 3        ///< Only served when no other process needs the disk
+    };
+
+    /**
+     * @brief Limits for the processes of one stage
+     */
+    struct Policy
+    {
+        int nice = 0;                       ///< Nice level (0 = inherit, 1-19 = lower priority)
+        IoClass ioClass = IoClass::None;    ///< I/O scheduling class
+        int ioLevel = 4;                    ///< Priority within the class, 0 (highest) to 7
+        QList<int> cpus;                    ///< Allowed CPUs (empty = all)
+        bool cgroup = false;                ///< Place processes in <cgroupRoot>/<stage>
+        QString memoryMax;                  ///< cgroup memory.max, e.g. "2G" (empty = unlimited)
+        QString cpuMax;                     ///< cgroup cpu.max, e.g. "200000 100000" (empty = unlimited)
+    };
+
+    /**
+     * @brief Process-wide configuration
+     */
+    struct Settings
+    {
+        Policy download;        ///< Stage::Download
+        Policy parse;           ///< Stage::Parse
+        Policy postProcess;     ///< Stage::PostProcess
+        QString cgroupRoot;     ///< Delegated cgroup v2 directory (empty = no cgroups)
+    };
+
+    /**
+     * @brief Replace the settings used for processes started from now on
+     *
+     * Creates and configures the cgroups of stages that use one; a stage
+     * whose cgroup cannot be set up runs without it.
+     *
+     * @param settings New settings
+     */
+    static void setSettings(const Settings &settings);
+
+    /**
+     * @brief Get the current settings (thread-safe)
+     * @return Settings
+     */
+    static Settings settings();
+
+    /**
+     * @brief Install the stage's policy on a process
+     *
+     * Call before every QProcess::start(); replaces any child process
+     * modifier set earlier.
+     *
+     * @param process Process about to be started
+     * @param stage Stage the process belongs to
+     */
+    static void apply(QProcess *process, Stage stage);
+
+    /**
+     * @brief Parse an I/O class name ("realtime", "best-effort", "idle")
+     * @param name Class name
+     * @return Class, or IoClass::None for anything else
+     */
+    static IoClass ioClassFromString(const QString &name);
+
+    /**
+     * @brief Parse a CPU list such as "0-3,6"
+     * @param list CPU list
+     * @return CPU numbers (empty if the list is empty or invalid)
+     */
+    static QList<int> cpuListFromString(const QString &list);
+};
+
+#endif // PROCESSPOLICY_H
@@ -0,0 +1,80 @@
+/**
+ * @file processreactor.h
+ * @brief Event batching for downloaders sharing one I/O thread
+ *
+ * In reactor mode every VideoDownloader lives on a single I/O thread whose
+ * event loop multiplexes all yt-dlp pipes. The reactor sits on that thread,
+ * collects downloader events and hands them to the owner thread in batches.
+ */
+
+#ifndef PROCESSREACTOR_H
+#define PROCESSREACTOR_H
+
+#include "core/download/task.h"
+#include <QObject>
+#include <QHash>
+#include <QPair>
+#include <QStringList>
+
+class QTimer;
+class VideoDownloader;
+
+/**
+ * @class ProcessReactor
+ * @brief Collects events of all downloaders on the I/O thread
+ *
+ * Log lines are buffered and flushed at most once per interval, so a burst
+ * of yt-dlp output costs one cross-thread event instead of one per line.
+ * Progress updates are coalesced to the latest value per task.
+ * Task completion flushes pending lines first to keep ordering intact.
+ */
+class ProcessReactor : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Construct ProcessReactor
+     * @param flushIntervalMs Maximum delay before buffered lines are delivered
+     * @param parent Parent QObject
+     */
+    explicit ProcessReactor(int flushIntervalMs = 100, QObject *parent = nullptr);
+
+    /**
+     * @brief Route a downloader's events through the reactor
+     * @param downloader Downloader living on the reactor's thread
+     */
+    void attach(VideoDownloader *downloader);
+
+signals:
+    /**
+     * @brief Emitted with all log lines collected since the last flush
+     * @param messages Log lines in arrival order
+     */
+    void logBatch(const QStringList &messages);
+
+    /**
+     * @brief Emitted on flush with the latest progress of a task
+     * @param downloader Worker reporting progress
+     * @param progress Most recent progress since the last flush
+     */
+    void progressUpdated(VideoDownloader *downloader, const DownloadProgress &progress);
+
+    /**
+     * @brief Emitted when a downloader finished its task
+     * @param downloader Worker that finished
+     * @param task Completed task
+     */
+    void taskFinished(VideoDownloader *downloader, const DownloadTask &task);
+
+private:
+    void onLogBatch(const QStringList &messages);
+    void onProgressUpdated(VideoDownloader *downloader, const DownloadProgress &progress);
+    void onTaskFinished(VideoDownloader *downloader, const DownloadTask &task);
+    void flush();
+
+    QStringList m_pendingLogs;   ///< Lines waiting for the next flush
+    QHash<QString, QPair<VideoDownloader*, DownloadProgress>> m_pendingProgress; ///< Task ID -> latest progress
+    QTimer *m_flushTimer;        ///< Single-shot flush timer (I/O thread)
+};
+
+#endif // PROCESSREACTOR_H
@@ -0,0 +1,202 @@
+/**
+ * @file segmenteddownloader.h
+ * @brief Built-in segmented HTTP download engine
+ *
+ * Downloads a direct media URL over several parallel range requests into
+ * a preallocated file, without starting a yt-dlp process for the transfer.
+ */
+
+#ifndef SEGMENTEDDOWNLOADER_H
+#define SEGMENTEDDOWNLOADER_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QUrl>
+#include <QVector>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+class QNetworkRequest;
+class QTimer;
+
+/**
+ * @class SegmentedDownloader
+ * @brief Fetches one file with N parallel HTTP range requests
+ *
+ * A probe request for the first byte tells whether the server supports
+ * ranges and how large the file is. The "<file>.part" file is then resized
+ * to the full size and split into equal segments, each fetched by its own
+ * request and written at its offset. A failed segment is retried from the
+ * position it reached (with exponential backoff); the download fails only
+ * when one segment exhausts its retries or the server answers with a
+ * permanent error. Servers without range support are downloaded over a
+ * single connection.
+ *
+ * When a ranged download is canceled (paused by re-queueing, or the queue
+ * was stopped), the .part file is kept together with the offset each
+ * segment reached ("<file>.part.segments"). The next start() for the same
+ * file resumes every segment from there if the server still reports the
+ * same size and validator (ETag or Last-Modified); otherwise it starts
+ * over. Failed downloads remove both files.
+ *
+ * Rate limiting and suspension stop reading from the replies; the bounded
+ * read buffer of each reply then throttles the server through TCP flow
+ * control. Connections dropped while suspended are re-requested on resume.
+ *
+ * QNetworkAccessManager opens at most six HTTP/1.1 connections per host,
+ * so at most maxSegments() segments are used; start() logs when it uses
+ * fewer connections than requested.
+ *
+ * Lives in the thread that created it.
+ */
+class SegmentedDownloader : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief What to download
+     */
+    struct Source
+    {
+        QUrl url;                                   ///< Direct media URL
+        QHash<QByteArray, QByteArray> headers;      ///< Request headers (User-Agent, Referer, ...)
+        QString filePath;                           ///< Final file path
+        qint64 sizeHint = 0;                        ///< Expected size if the server does not report one
+    };
+
+    explicit SegmentedDownloader(QObject *parent = nullptr);
+    ~SegmentedDownloader() override;
+
+    /**
+     * @brief Start a download (aborts the current one without finished())
+     * @param source URL, headers and target file
+     * @param segments Parallel connections (<= 0 = default); clamped to
+     *                 maxSegments()
+     */
+    void start(const Source &source, int segments);
+
+    /**
+     * @brief Get the most parallel connections one download uses
+     * @return Connection limit per host of QNetworkAccessManager
+     */
+    static int maxSegments();
+
+    /**
+     * @brief Check if a download is in progress
+     * @return true between start() and finished()
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief Get the target file of the current (or last) download
+     * @return Final file path
+     */
+    QString filePath() const;
+
+public slots:
+    /**
+     * @brief Abort the download
+     *
+     * With range support the partial file and the segment offsets are kept
+     * so that start() can resume; otherwise the partial file is removed.
+     * finished(false, ...) is emitted asynchronously.
+     */
+    void cancel();
+
+    /**
+     * @brief Stop reading from all connections
+     */
+    void suspend();
+
+    /**
+     * @brief Continue after suspend()
+     */
+    void resume();
+
+    /**
+     * @brief Limit the total download rate
+     * @param bytesPerSecond Limit for all segments together (0 = unlimited)
+     */
+    void setRateLimit(qint64 bytesPerSecond);
+
+signals:
+    /**
+     * @brief Download progress (at most once per tick)
+     * @param downloaded Bytes written
+     * @param total Total size, 0 if unknown
+     * @param speed Bytes per second
+     */
+    void progress(qint64 downloaded, qint64 total, qint64 speed);
+
+    /**
+     * @brief Diagnostic output
+     * @param msg Log message
+     */
+    void logMessage(const QString &msg);
+
+    /**
+     * @brief The download ended
+     * @param success true if the file was completed and renamed
+     * @param error Description when not successful
+     */
+    void finished(bool success, const QString &error);
+
+private:
+    struct Segment
+    {
+        qint64 begin = 0;               // 起始偏移
+        qint64 end = -1;                // 结束偏移（含），-1 表示读到连接结束
+        qint64 pos = 0;                 // 下一个要写入的偏移
+        int retries = 0;                // 连续失败次数
+        QNetworkReply *reply = nullptr;
+        bool replyFinished = false;     // 连接已结束，缓冲中的数据读完后处理
+        bool waiting = false;           // 等待重试或恢复
+        bool done = false;
+    };
+
+    QNetworkRequest makeRequest() const;
+    QString partPath() const;
+    QString statePath() const;
+    bool restoreState();
+    void saveState();
+    void handleProbeMetaData();
+    void handleProbeFinished();
+    void beginTransfer();
+    void startSegment(int index);
+    void readSegment(int index);
+    void finishSegment(int index);
+    void checkCompleted();
+    void tick();
+    void reportProgress(bool force);
+    void fail(const QString &error);
+    void abortTransfer(bool keepPartial);
+    void abortReplies();
+
+    QNetworkAccessManager *m_manager;   ///< Created on first start
+    QNetworkReply *m_probe;             ///< First-byte request
+    QTimer *m_tickTimer;                ///< Rate budget refill and progress
+    QElapsedTimer m_sampleTimer;        ///< Speed measurement window
+    QFile m_file;                       ///< The .part file
+    QByteArray m_buffer;                ///< Read buffer shared by all segments
+    Source m_source;
+    QByteArray m_validator;             ///< ETag or Last-Modified from the probe, checked before resuming
+    QVector<Segment> m_segments;
+    qint64 m_total;                     ///< File size, 0 if unknown
+    qint64 m_reported;                  ///< Bytes in the last progress signal
+    qint64 m_speed;
+    qint64 m_sampleBytes;               ///< Bytes at the start of the speed window
+    qint64 m_rateLimit;
+    qint64 m_budget;                    ///< Bytes that may still be read this tick
+    int m_segmentCount;                 ///< Requested parallel connections
+    int m_generation;                   ///< Invalidates pending retries after an abort
+    int m_nextRead;                     ///< First segment served by the next tick
+    bool m_ranged;                      ///< Server supports range requests
+    bool m_suspended;
+    bool m_running;
+};
+
+#endif // SEGMENTEDDOWNLOADER_H
@@ -2,6 +2,7 @@
 #define TASK_H
 
 #include <QString>
+#include <QList>
 #include <QVector>
 #include <QMap>
 #include <QDateTime>
@@ -14,6 +15,12 @@ enum class UrlType
 	Single
 };
 
+enum class DownloadBackend
+{
+	YtDlp = 0,		// yt-dlp 进程（或常驻助手）
+	Native			// 内置分段下载，只用于可直接下载的单个文件，否则回退到 yt-dlp
+};
+
 enum class DownloadStatus
 {
 	Success = 0,
@@ -51,10 +58,20 @@ struct VideoEntry {
 	QString playlistTitle;
 	QString ext = "mp4";
 	QString formatId;  // 格式ID，用于下载时指定格式
+	int duration = 0;  // 时长（秒），未知为 0
+	qint64 filesize = 0;  // 预计下载大小（字节），未知为 0
+	bool resolved = true;	// 已获取完整信息（格式、大小）；扁平列表中的条目为 false，下载时由 yt-dlp 选择格式
 	QVector<VideoFormat> videoFormats;
 	QMap<QString, QString> subtitles; // lang -> url
 };
 
+// 下载阶段产生的一个媒体文件，由后处理阶段合并/嵌入
+struct DownloadedFile
+{
+	QString path;
+	bool hasVideo = true;		// 含视频流（否则为纯音频）
+};
+
 struct DownloadTask
 {
 	QString id;				
@@ -67,12 +84,35 @@ struct DownloadTask
 	QDateTime startTime;
 	QDateTime endTime;
 
+	int priority = 0;			// 调度优先级，越大越先下载
+	QDateTime deadline;			// 可选截止时间，同优先级内越早越先下载
+	QString groupId;			// 所属提交批次/播放列表，公平调度时按组轮转
+	QString host;				// 准入控制的主机键（HostAdmission::hostOf），入队时计算一次
+	qint64 rateLimit = 0;		// 下载限速（字节/秒），0 表示不限速
+	DownloadBackend backend = DownloadBackend::YtDlp;	// 下载后端
+	int connections = 0;		// 单个任务的并行连接数（分段数），0 表示默认值
+	bool deferPostProcess = false;	// 合并、嵌入等后处理交给独立的后处理阶段，不在 yt-dlp 进程中进行
+	QList<DownloadedFile> files;	// 推迟后处理或使用暂存目录时下载阶段产生的文件
+	QString stagingPath;		// 下载时使用的暂存目录，完成后再移动到 savePath；为空表示直接写入 savePath
+	DownloadStatus status = DownloadStatus::Success;	// 结束状态，由下载器在任务结束时设置
 
 	bool isSelected = false;
 	bool isFinished = false;
 };
 
 
+// 下载进度，解析自 yt-dlp 的进度行（--progress-template）
+struct DownloadProgress
+{
+	QString taskId;				// 所属任务
+	double percent = 0.0;		// 0 - 100
+	qint64 downloadedBytes = 0;	// 已下载字节数（包括同一任务中已完成的视频/音频流）
+	qint64 totalBytes = 0;		// 总大小（可能为估计值），未知为 0
+	qint64 speed = 0;			// 当前速度（字节/秒），未知为 0
+	int eta = -1;				// 剩余时间（秒），未知为 -1
+};
+
+
 struct ParsedEntry
 {
 	QString id;
@@ -84,13 +124,17 @@ struct ParsedEntry
 	int index = 1;
 	int playlistCount;
 	int duration = 0;          // 视频时长（秒）
+	qint64 filesize = 0;       // 所选格式的预计大小（字节），未知为 0
 	QString thumbnail;        // 缩略图URL
 	QString formatId;         // 格式ID
 	QString ext;              // 文件扩展名
+	bool resolved = true;     // 已获取完整信息；--flat-playlist 列出的条目只有 ID、标题和链接
 };
 
 
 Q_DECLARE_METATYPE(DownloadTask)
+Q_DECLARE_METATYPE(DownloadProgress)
+Q_DECLARE_METATYPE(ParsedEntry)
 
 
 #endif // TASK_H
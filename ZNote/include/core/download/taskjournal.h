@@ -0,0 +1,144 @@
+/**
+ * @file taskjournal.h
+ * @brief Write-ahead journal for the download queue
+ *
+ * Records queue changes in an append-only file so that queued and
+ * interrupted tasks survive a crash or forced exit.
+ */
+
+#ifndef TASKJOURNAL_H
+#define TASKJOURNAL_H
+
+#include "core/download/task.h"
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <map>
+
+class QJsonObject;
+
+/**
+ * @class TaskJournal
+ * @brief Append-only JSON-lines log of enqueue/start/finish/cancel events
+ *
+ * Each record is one JSON object per line. Records are written and flushed
+ * immediately, so they survive the application being killed (but not a
+ * power loss before the OS writes them back).
+ *
+ * Replay reads the file once and rebuilds the set of unfinished tasks in
+ * enqueue order; partially written trailing lines are ignored. The live set
+ * is also kept in memory so compaction can rewrite the file (atomically,
+ * via QSaveFile) without re-reading it. Compaction runs after replay and
+ * whenever the file holds more than twice as many records as live tasks.
+ *
+ * Thread-safe.
+ */
+class TaskJournal
+{
+public:
+    /**
+     * @brief Construct TaskJournal
+     * @param path Journal file path (empty = defaultPath())
+     */
+    explicit TaskJournal(const QString &path = QString());
+    ~TaskJournal();
+
+    /**
+     * @brief Get the journal file path
+     * @return Absolute file path
+     */
+    QString path() const;
+
+    /**
+     * @brief Load the journal and return the unfinished tasks
+     *
+     * Tasks that were started but never finished are included so they can
+     * be resumed. The file is compacted afterwards.
+     *
+     * @return Unfinished tasks in queue order
+     */
+    QList<DownloadTask> replay();
+
+    /**
+     * @brief Record queued tasks (re-recording a task replaces it)
+     * @param tasks Tasks added to the queue
+     */
+    void recordEnqueue(const QList<DownloadTask> &tasks);
+
+    /**
+     * @brief Record that a task was moved to the head of the queue
+     * @param taskId Task ID
+     */
+    void recordMoveToFront(const QString &taskId);
+
+    /**
+     * @brief Record that a task started downloading
+     * @param taskId Task ID
+     */
+    void recordStart(const QString &taskId);
+
+    /**
+     * @brief Record that a task completed (successfully or not)
+     * @param taskId Task ID
+     */
+    void recordFinish(const QString &taskId);
+
+    /**
+     * @brief Record that a task was removed by the user
+     * @param taskId Task ID
+     */
+    void recordCancel(const QString &taskId);
+
+    /**
+     * @brief Record that several tasks were removed by the user
+     *
+     * Used when the queue is cleared: tasks that are running at that moment
+     * stay in the journal until they finish.
+     *
+     * @param taskIds Task IDs
+     */
+    void recordCancel(const QStringList &taskIds);
+
+    /**
+     * @brief Rewrite the journal with only the live tasks
+     * @return true on success
+     */
+    bool compact();
+
+    /**
+     * @brief Get default journal path (next to the history file)
+     * @return Journal file path
+     */
+    static QString defaultPath();
+
+private:
+    struct Entry
+    {
+        DownloadTask task;
+        qint64 sequence;
+        bool started;
+    };
+
+    bool apply(const QJsonObject &record);
+    void append(const QByteArray &lines, int records);
+    bool openForAppend();
+    bool compactLocked();
+    void compactIfNeeded();
+
+    static QJsonObject taskToJson(const DownloadTask &task);
+    static DownloadTask taskFromJson(const QJsonObject &json);
+
+    QString m_path;                        ///< Journal file path
+    QFile m_file;                          ///< Open for append
+    QHash<QString, Entry> m_live;          ///< Task ID -> unfinished task
+    std::map<qint64, QString> m_order;     ///< Queue order -> task ID
+    qint64 m_backSequence;                 ///< Next sequence for enqueue
+    qint64 m_frontSequence;                ///< Next sequence for move-to-front
+    int m_records;                         ///< Records currently in the file
+    mutable QMutex m_mutex;                ///< Guards all state
+};
+
+#endif // TASKJOURNAL_H
@@ -8,12 +8,22 @@
 #ifndef TASKQUEUE_H
 #define TASKQUEUE_H
 
+#include "core/download/taskscheduler.h"
+#include "core/download/hostadmission.h"
+#include "core/download/concurrencycontroller.h"
 #include <QObject>
-#include <QQueue>
 #include <QList>
+#include <QHash>
+#include <QSet>
 #include <QMutex>
+#include <QElapsedTimer>
+#include <QPair>
 
+class QTimer;
 class VideoDownloader;
+class DownloaderPool;
+class PostProcessor;
+class FileMover;
 struct DownloadTask;
 
 /**
@@ -21,15 +31,39 @@ struct DownloadTask;
  * @brief Thread-safe task queue for managing concurrent downloads
  * 
  * Features:
+ * - Priority and deadline ordering of pending tasks (FIFO within a rank)
+ * - Optional fair-share round-robin between playlists/submissions
+ * - Optional shortest-job-first ordering by estimated download size
+ * - Per-host concurrency limits and token-bucket admission; tasks for
+ *   other hosts fill the slots a throttled host cannot use
+ * - Optional global bandwidth cap split evenly across running downloads
+ * - Optional adaptive concurrency tuned from measured throughput
+ * - Optional batching of several same-site tasks into one yt-dlp process
+ * - Optional connection budget split between running tasks and the
+ *   parallel connections (fragments/segments) of each task
+ * - Optional separate post-processing stage (see PostProcessor): merging
+ *   runs after the download slot has been released
+ * - Optional staging directory: downloads are written to a fast local disk
+ *   and moved to the save path in the background (see FileMover)
  * - Configurable maximum concurrent downloads
+ * - Persistent worker pool, resized live with the concurrency limit
  * - Thread-safe operations
- * - Pause/resume support
+ * - Pause/resume that keeps download progress (suspend or requeue)
  * - Automatic task scheduling
  */
 class TaskQueue : public QObject
 {
     Q_OBJECT
 public:
+    /**
+     * @brief How running downloads are paused
+     */
+    enum class PauseMode
+    {
+        Suspend,    ///< Stop the child process group (SIGSTOP/SIGCONT); POSIX only
+        Requeue     ///< Kill the child and re-queue the task at the front; resumes from the .part file
+    };
+
     /**
      * @brief Construct TaskQueue
      * @param max Maximum concurrent downloads (default: 2)
@@ -43,16 +77,73 @@ public:
      */
     void enqueue(const DownloadTask &task);
 
+    /**
+     * @brief Change the priority of a queued task
+     * @param taskId Task ID
+     * @param priority New priority (higher runs first)
+     * @return true if the task was still pending
+     */
+    bool setTaskPriority(const QString &taskId, int priority);
+
+    /**
+     * @brief Change or clear the deadline of a queued task
+     * @param taskId Task ID
+     * @param deadline New deadline (invalid = none)
+     * @return true if the task was still pending
+     */
+    bool setTaskDeadline(const QString &taskId, const QDateTime &deadline);
+
+    /**
+     * @brief Move a queued task to the head of the queue
+     * @param taskId Task ID
+     * @return true if the task was still pending
+     */
+    bool moveTaskToFront(const QString &taskId);
+
+    /**
+     * @brief Remove a task that has not started yet
+     * @param taskId Task ID
+     * @return true if the task was still pending
+     */
+    bool removeTask(const QString &taskId);
+
+    /**
+     * @brief Remove all pending tasks (running tasks are not affected)
+     * @return IDs of the removed tasks
+     */
+    QStringList clear();
+
     /**
      * @brief Start processing the queue
      */
     void startQueue();
 
     /**
-     * @brief Pause queue processing
+     * @brief Pause queue processing and running downloads
+     * 
+     * Running downloads keep their progress: they are suspended, or killed
+     * and re-queued at the front so yt-dlp continues the partial file
+     * (see setPauseMode()). startQueue() resumes them.
      */
     void pauseQueue();
 
+    /**
+     * @brief Stop queue processing and cancel running downloads
+     * 
+     * Canceled tasks finish with DownloadStatus::Canceled and are not
+     * re-queued; pending tasks stay queued.
+     */
+    void stopQueue();
+
+    /**
+     * @brief Choose how pauseQueue() treats running downloads
+     * 
+     * Suspend falls back to Requeue on platforms without SIGSTOP.
+     * 
+     * @param mode Pause mode
+     */
+    void setPauseMode(PauseMode mode);
+
     /**
      * @brief Check if queue is paused
      * @return true if paused
@@ -67,10 +158,137 @@ public:
     
     /**
      * @brief Set maximum concurrent downloads
+     * 
+     * Resizes the worker pool live: extra slots are filled immediately,
+     * surplus workers are retired as soon as their current task finishes.
+     * While adaptive concurrency is enabled, calling it again with an
+     * unchanged value is a no-op, so the level chosen by the controller
+     * survives re-applying the settings.
+     * 
      * @param max Maximum concurrent count
      */
     void setMaxConcurrent(int max);
 
+    /**
+     * @brief Enable or disable reactor mode
+     * 
+     * In reactor mode all downloaders run on one I/O thread instead of one
+     * thread each, so the thread count no longer grows with the limit.
+     * 
+     * @param enabled true to use a single I/O thread
+     */
+    void setReactorMode(bool enabled);
+
+    /**
+     * @brief Enable or disable fair-share scheduling
+     * 
+     * Keeps one sub-queue per DownloadTask::groupId (playlist or submission)
+     * and rotates between them when filling free slots.
+     * 
+     * @param enabled true to rotate between groups
+     */
+    void setFairShare(bool enabled);
+
+    /**
+     * @brief Enable or disable shortest-job-first ordering
+     * 
+     * Orders tasks of equal priority and deadline by estimated size
+     * (filesize, or duration when no size is known), smallest first.
+     * 
+     * @param enabled true to run short jobs first
+     */
+    void setShortestJobFirst(bool enabled);
+
+    /**
+     * @brief Set how many tasks may share one yt-dlp process
+     * 
+     * With a size above 1, queued tasks for the same site with the same save
+     * path and format are grouped into one process (batch file plus a
+     * per-item completion marker), saving the interpreter and extractor
+     * startup per file. taskFinished is still emitted for every task; the
+     * batch occupies one concurrency slot.
+     * 
+     * @param size Maximum tasks per process (1 = no batching)
+     */
+    void setBatchSize(int size);
+
+    /**
+     * @brief Configure per-host admission control
+     * 
+     * A task only starts when its host (see HostAdmission::hostOf) is below
+     * maxPerHost running downloads and its token bucket has a token. Blocked
+     * tasks keep their place in the queue while other hosts are served.
+     * 
+     * @param maxPerHost Concurrent downloads per host (0 = unlimited)
+     * @param requestsPerSecond Download starts per second per host (0 = unlimited)
+     * @param burst Starts a host may make back to back
+     */
+    void setHostLimits(int maxPerHost, double requestsPerSecond, int burst);
+
+    /**
+     * @brief Set the global bandwidth budget
+     * 
+     * The budget is divided evenly between running downloads. New tasks start
+     * with their share, and running downloads above that share are lowered
+     * to it at the same moment. Shares that grow (tasks finished, budget
+     * raised) are applied shortly afterwards in one batch, and only if they
+     * grew by at least 25%, to avoid needless restarts. A changed share
+     * restarts yt-dlp with the new --limit-rate (partial files are resumed),
+     * so the budget can be exceeded briefly while the old processes exit.
+     * 
+     * @param bytesPerSecond Total download rate (0 = unlimited)
+     */
+    void setBandwidthLimit(qint64 bytesPerSecond);
+
+    /**
+     * @brief Enable or disable adaptive concurrency
+     * 
+     * Samples the aggregate download speed every few seconds and lets a
+     * ConcurrencyController raise the limit while throughput improves and
+     * lower it when throughput flattens or tasks fail. setMaxConcurrent()
+     * sets the starting level. Every change is reported through
+     * concurrencyChanged(). Disabling it restores the limit last set with
+     * setMaxConcurrent().
+     * 
+     * @param enabled true to tune the limit automatically
+     * @param maxLevel Highest limit the controller may choose
+     */
+    void setAdaptiveConcurrency(bool enabled, int maxLevel);
+
+    /**
+     * @brief Set the number of connections shared by all running downloads
+     * 
+     * With a budget, each task is assigned its parallel connections when it
+     * starts (yt-dlp -N for fragmented formats, segments for the native
+     * backend), and tasks only start while the connections in use stay
+     * within the budget. The free budget is divided between the tasks that
+     * can start now (pending tasks, up to the concurrency limit), so a few
+     * large files get many connections each while a long queue runs many
+     * tasks with one connection. Tasks estimated below 32 MiB always use one
+     * connection; native-backend tasks use at most
+     * SegmentedDownloader::maxSegments(). Running tasks keep their count
+     * until they finish.
+     * 
+     * @param connections Total connections (0 = no budget; tasks keep
+     *                    DownloadTask::connections)
+     */
+    void setConnectionBudget(int connections);
+
+    /**
+     * @brief Configure the staging directory
+     * 
+     * With a directory, tasks dispatched from now on download (and
+     * post-process) there; finished files are then moved to the task's save
+     * path by a FileMover with its own concurrency limit, and taskFinished
+     * is emitted once they are in place. A failed move fails the task and
+     * leaves its files in staging, as does a successful download that
+     * reported no files (the directory is shared, so they cannot be found).
+     * 
+     * @param directory Staging directory (empty = download to the save path)
+     * @param moveJobs Concurrent move jobs
+     */
+    void setStaging(const QString &directory, int moveJobs);
+
 signals:
     /**
      * @brief Emitted when a log message is generated
@@ -78,6 +296,18 @@ signals:
      */
     void logMessage(const QString &msg);
     
+    /**
+     * @brief Emitted when a task has been handed to a downloader
+     * @param task Started task
+     */
+    void taskStarted(const DownloadTask &task);
+
+    /**
+     * @brief Emitted when a running task reports byte-level progress
+     * @param progress Progress of DownloadProgress::taskId
+     */
+    void taskProgress(const DownloadProgress &progress);
+
     /**
      * @brief Emitted when a task finishes
      * @param task Completed task
@@ -85,10 +315,25 @@ signals:
     void taskFinished(const DownloadTask &task);
     
     /**
-     * @brief Emitted when all tasks are finished
+     * @brief Emitted while a finished task's files are moved out of staging
+     * @param taskId Task ID
+     * @param moved Bytes moved
+     * @param total Bytes to move
+     */
+    void taskMoveProgress(const QString &taskId, qint64 moved, qint64 total);
+    
+    /**
+     * @brief Emitted when all tasks are finished (including post-processing and moving)
      */
     void allFinished();
 
+    /**
+     * @brief Emitted when adaptive concurrency changes the limit
+     * @param level New concurrency limit
+     * @param reason Why the controller chose it
+     */
+    void concurrencyChanged(int level, const QString &reason);
+
 private slots:
     /**
      * @brief Handle task completion
@@ -97,14 +342,76 @@ private slots:
      */
     void onTaskFinished(VideoDownloader *downloader, const DownloadTask &task);
     
+    /**
+     * @brief Handle a task leaving the post-processing stage
+     * @param task Task with its final status
+     */
+    void onPostProcessed(const DownloadTask &task);
+
+    /**
+     * @brief Handle a task whose files were moved out of staging
+     * @param task Task with its final status
+     */
+    void onMoved(const DownloadTask &task);
+
     /**
      * @brief Start next task in queue
      */
     void startNext();
 
+    /**
+     * @brief Apply the current bandwidth shares to running downloaders
+     */
+    void rebalanceBandwidth();
+
+    /**
+     * @brief Feed the current aggregate throughput to the controller
+     */
+    void sampleThroughput();
+
+    /**
+     * @brief Record progress of a running downloader
+     * @param downloader Worker reporting progress
+     * @param progress Parsed progress
+     */
+    void onProgressUpdated(VideoDownloader *downloader, const DownloadProgress &progress);
+
 private:
-    QQueue<DownloadTask> pending;      ///< Pending tasks queue
+    void applyConcurrency(int max);
+    qint64 bandwidthShare(int runningCount) const;
+    void scheduleRebalance();
+    void applyRateShares(const QList<QPair<VideoDownloader*, qint64>> &updates);
+    int connectionsInUse() const;
+    int connectionShare(const DownloadTask &task) const;
+    void checkAllFinished();
+    void finishTask(const DownloadTask &task);
+
+    DownloaderPool *m_pool;             ///< Reusable download workers
+    PostProcessor *m_postProcessor;     ///< Merge/embed stage after the download slot is released
+    FileMover *m_mover;                 ///< Moves finished files out of the staging directory
+    QString m_stagingDir;               ///< Staging directory (empty = none)
+    TaskScheduler pending;              ///< Pending tasks in scheduling order
     QList<VideoDownloader*> running;   ///< Currently running downloaders
+    HostAdmission m_admission;          ///< Per-host slot and rate limits
+    QHash<VideoDownloader*, QString> m_hosts; ///< Running downloader -> admitted host
+    QElapsedTimer m_clock;              ///< Monotonic time base for token buckets
+    QTimer *m_retryTimer;               ///< Wakes startNext when a token refills
+    qint64 m_bandwidthLimit;            ///< Global rate budget in bytes/s (0 = unlimited)
+    QHash<VideoDownloader*, qint64> m_rateShares; ///< Running downloader -> applied rate limit
+    QTimer *m_rebalanceTimer;           ///< Coalesces rebalancing after starts/finishes
+    ConcurrencyController m_controller; ///< AIMD tuning of maxConcurrent
+    QHash<VideoDownloader*, qint64> m_speeds; ///< Running downloader -> latest speed (bytes/s)
+    int m_failures;                     ///< Failed tasks since the last sample
+    bool m_adaptive;                    ///< Adaptive concurrency enabled
+    QTimer *m_sampleTimer;              ///< Periodic throughput sampling
+    PauseMode m_pauseMode;              ///< How pauseQueue() stops running downloads
+    QSet<VideoDownloader*> m_suspended; ///< Downloaders stopped by pauseQueue()
+    QSet<VideoDownloader*> m_interrupted; ///< Downloaders killed for re-queueing
+    QHash<VideoDownloader*, int> m_outstanding; ///< Running downloader -> unfinished tasks in its batch
+    int m_batchSize;                    ///< Maximum tasks per yt-dlp process
+    int m_connectionBudget;             ///< Connections shared by running tasks (0 = no budget)
+    QHash<VideoDownloader*, int> m_connections; ///< Running downloader -> assigned connections
+    int m_configuredMax;                ///< Limit last set by setMaxConcurrent()
     int maxConcurrent;                  ///< Maximum concurrent downloads
     bool paused;                        ///< Pause state flag
     mutable QMutex m_mutex;             ///< Mutex for thread safety
@@ -0,0 +1,219 @@
+/**
+ * @file taskscheduler.h
+ * @brief Ordered storage for pending download tasks
+ *
+ * Orders queued tasks by priority and deadline while keeping FIFO order
+ * between tasks of equal rank, optionally sharing slots fairly between
+ * submissions.
+ */
+
+#ifndef TASKSCHEDULER_H
+#define TASKSCHEDULER_H
+
+#include "core/download/task.h"
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <functional>
+#include <map>
+
+/**
+ * @class TaskScheduler
+ * @brief Priority queue of pending tasks with O(log n) insert, pop and update
+ *
+ * Ordering (first = next to run):
+ * - Higher DownloadTask::priority first
+ * - Within a priority, earlier DownloadTask::deadline first; tasks without
+ *   a deadline come after those with one
+ * - In shortest-job-first mode, smaller estimated jobs first (see
+ *   estimatedCost()); unknown sizes go last
+ * - Otherwise FIFO by insertion order
+ *
+ * In fair-share mode every DownloadTask::groupId (playlist or submission)
+ * gets its own sub-queue ordered as above, and pop() rotates between the
+ * sub-queues whose head has the highest priority.
+ *
+ * Not thread-safe; TaskQueue guards it with its own mutex.
+ */
+class TaskScheduler
+{
+public:
+    TaskScheduler();
+
+    /**
+     * @brief Enable or disable round-robin between task groups
+     * @param enabled true to rotate between DownloadTask::groupId sub-queues
+     */
+    void setFairShare(bool enabled);
+
+    /**
+     * @brief Check if fair-share mode is active
+     * @return true if rotating between groups
+     */
+    bool isFairShare() const;
+
+    /**
+     * @brief Enable or disable shortest-job-first ordering
+     *
+     * Within the same priority and deadline, tasks with fewer estimated bytes
+     * run first, which lowers mean completion time for mixed batches. The
+     * policy is non-preemptive: running tasks are never interrupted.
+     *
+     * @param enabled true to order by estimated size
+     */
+    void setShortestJobFirst(bool enabled);
+
+    /**
+     * @brief Check if shortest-job-first ordering is active
+     * @return true if ordering by estimated size
+     */
+    bool isShortestJobFirst() const;
+
+    /**
+     * @brief Estimate the download size of a task
+     *
+     * Uses VideoEntry::filesize when known, otherwise VideoEntry::duration
+     * times a nominal bitrate.
+     *
+     * @param task Task to estimate
+     * @return Estimated bytes, or the largest qint64 if nothing is known
+     */
+    static qint64 estimatedCost(const DownloadTask &task);
+
+    /**
+     * @brief Insert a task behind all tasks of the same rank
+     *
+     * A queued task with the same ID is replaced.
+     *
+     * @param task Task to enqueue
+     */
+    void push(const DownloadTask &task);
+
+    /**
+     * @brief Insert a task ahead of all tasks of the same rank
+     *
+     * A queued task with the same ID is replaced.
+     *
+     * @param task Task to put back (e.g. could not be started)
+     */
+    void pushFront(const DownloadTask &task);
+
+    /**
+     * @brief Remove and return the next task
+     * @return Next task; default-constructed if empty
+     */
+    DownloadTask pop();
+
+    /**
+     * @brief Remove and return the first task, in scheduling order, that
+     *        the predicate accepts
+     *
+     * Used for admission control: tasks that cannot start yet are skipped
+     * without losing their position.
+     *
+     * @param accept Predicate; may consume resources when it returns true
+     * @param task Output: the accepted task
+     * @param maxScan Stop after offering this many tasks (0 = no limit)
+     * @return true if a task was accepted
+     */
+    bool takeFirst(const std::function<bool(const DownloadTask &)> &accept, DownloadTask *task, int maxScan = 0);
+
+    /**
+     * @brief Get the next task without removing it
+     * @return Pointer to the next task, or nullptr if empty
+     */
+    const DownloadTask *peek() const;
+
+    bool isEmpty() const;
+    int size() const;
+    int groupCount() const;
+    bool contains(const QString &taskId) const;
+
+    /**
+     * @brief Get the IDs of all queued tasks
+     * @return Task IDs, in no particular order
+     */
+    QStringList ids() const;
+
+    /**
+     * @brief Change the priority of a queued task
+     * @param taskId Task ID
+     * @param priority New priority (higher runs first)
+     * @return true if the task was found
+     */
+    bool setPriority(const QString &taskId, int priority);
+
+    /**
+     * @brief Change or clear the deadline of a queued task
+     * @param taskId Task ID
+     * @param deadline New deadline (invalid = none)
+     * @return true if the task was found
+     */
+    bool setDeadline(const QString &taskId, const QDateTime &deadline);
+
+    /**
+     * @brief Move a queued task to the head of the queue
+     *
+     * The task's priority is raised to the current head's if needed, so the
+     * task keeps its place when it is re-inserted later. The head's earlier
+     * deadline only affects the queue position; DownloadTask::deadline is
+     * left unchanged.
+     *
+     * @param taskId Task ID
+     * @return true if the task was found
+     */
+    bool moveToFront(const QString &taskId);
+
+    /**
+     * @brief Remove a queued task
+     * @param taskId Task ID
+     * @return true if the task was found
+     */
+    bool remove(const QString &taskId);
+
+    /**
+     * @brief Remove all tasks
+     */
+    void clear();
+
+private:
+    struct Key
+    {
+        int priority;
+        qint64 deadline;
+        qint64 cost;
+        qint64 sequence;
+
+        bool operator<(const Key &other) const;
+    };
+
+    using Queue = std::map<Key, DownloadTask>;
+
+    struct Position
+    {
+        QString group;
+        Key key;
+    };
+
+    Key makeKey(const DownloadTask &task, qint64 sequence) const;
+    QString groupOf(const DownloadTask &task) const;
+    int nextGroupIndex() const;
+    void rebuild(bool fairShare, bool shortestJobFirst);
+    void insert(const Key &key, const DownloadTask &task);
+    bool take(const QString &taskId, DownloadTask &task);
+    DownloadTask takeAt(int groupIndex, Queue::iterator it);
+    void dropGroupIfEmpty(int groupIndex);
+
+    QHash<QString, Queue> m_groups;        ///< Group -> tasks in scheduling order
+    QStringList m_rotation;                ///< Non-empty groups in round-robin order
+    QHash<QString, Position> m_index;      ///< Task ID -> group and position key
+    int m_cursor;                          ///< Rotation index served next
+    int m_size;                            ///< Total queued tasks
+    qint64 m_backSequence;                 ///< Next sequence for push()
+    qint64 m_frontSequence;                ///< Next sequence for pushFront()
+    bool m_fairShare;                      ///< Rotate between groups
+    bool m_shortestJobFirst;               ///< Order by estimated size
+};
+
+#endif // TASKSCHEDULER_H
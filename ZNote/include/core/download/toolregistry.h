@@ -0,0 +1,123 @@
+/**
+ * @file toolregistry.h
+ * @brief Process-wide discovery of external tools (yt-dlp, ffmpeg, aria2c)
+ *
+ * Locates each tool once, in the background, honouring paths configured by
+ * the user, and probes its version and capabilities once, so downloaders
+ * and parsers no longer search PATH for every task.
+ */
+
+#ifndef TOOLREGISTRY_H
+#define TOOLREGISTRY_H
+
+#include <QSet>
+#include <QString>
+
+/**
+ * @class ToolRegistry
+ * @brief Cached tool paths, versions and capabilities
+ *
+ * configure() starts discovery on a background thread: first the paths
+ * (the configured path, then next to the executable and the project bin
+ * directory, then PATH), then one version/capability probe per tool.
+ * Readers block only until the part they need is available: path() waits
+ * for the paths, info() also for the probes; tryInfo() never waits. The results are kept until
+ * configure() is called with different overrides.
+ *
+ * Without a configure() call the first reader starts discovery with no
+ * overrides. All functions are thread-safe.
+ */
+class ToolRegistry
+{
+public:
+    /**
+     * @brief External tools
+     */
+    enum class Tool
+    {
+        YtDlp,
+        Ffmpeg,
+        Aria2c
+    };
+
+    /**
+     * @brief Paths configured by the user (empty = search)
+     */
+    struct Overrides
+    {
+        QString ytdlp;      ///< download.ytdlpPath
+        QString ffmpeg;     ///< download.ffmpegPath
+        QString aria2c;     ///< download.aria2cPath
+
+        bool operator==(const Overrides &other) const
+        {
+            return ytdlp == other.ytdlp && ffmpeg == other.ffmpeg && aria2c == other.aria2c;
+        }
+    };
+
+    /**
+     * @brief What is known about one tool
+     */
+    struct ToolInfo
+    {
+        QString path;               ///< Absolute path (empty = not found)
+        QString version;            ///< Reported version (empty = unknown)
+        QSet<QString> capabilities; ///< ffmpeg encoders, aria2c features; empty for yt-dlp
+
+        bool isAvailable() const { return !path.isEmpty(); }
+    };
+
+    /**
+     * @brief Set the configured paths
+     *
+     * Starts a new discovery when the overrides differ from the current
+     * ones (or on the first call); otherwise does nothing.
+     *
+     * @param overrides Configured paths
+     */
+    static void configure(const Overrides &overrides);
+
+    /**
+     * @brief Get the program to start for a tool
+     * @param tool Tool
+     * @return Discovered path, or the bare program name if the tool was not found
+     */
+    static QString path(Tool tool);
+
+    /**
+     * @brief Check if a tool was found
+     * @param tool Tool
+     * @return true if path() is a discovered executable
+     */
+    static bool isAvailable(Tool tool);
+
+    /**
+     * @brief Get the path, version and capabilities of a tool
+     *
+     * Waits for the version probes, which start the tools once each.
+     *
+     * @param tool Tool
+     * @return Tool information
+     */
+    static ToolInfo info(Tool tool);
+
+    /**
+     * @brief Get the tool information if the probes have finished
+     *
+     * Never waits; for checks that can be skipped while probing is running.
+     *
+     * @param tool Tool
+     * @param info Output: tool information
+     * @return true if info was filled in
+     */
+    static bool tryInfo(Tool tool, ToolInfo *info);
+
+    /**
+     * @brief Get the program name of a tool
+     * @param tool Tool
+     * @return "yt-dlp", "ffmpeg" or "aria2c"
+     */
+    static QString name(Tool tool);
+};
+
+#endif // TOOLREGISTRY_H
@@ -2,10 +2,18 @@
 #define URLPARSER_H
 
 #include "core/download/task.h"
+#include "core/download/linebuffer.h"
+#include <QByteArray>
 #include <QObject>
 #include <QString>
 #include <QList>
 #include <QProcess>
+#include <QSet>
+#include <QThreadPool>
+
+class QJsonObject;
+class YtDlpHelper;
+class ParseCache;
 
 class UrlParser : public QObject
 {
@@ -17,30 +25,67 @@ public:
 
     void parse(const QString &url);
     void cancel();
+    // 设置解析结果缓存（不转移所有权，nullptr 表示不使用缓存）；revalidate 为 true 时过期的结果先发送，再在后台重新解析
+    void setCache(ParseCache *cache, bool revalidate);
+    // 播放列表只列出条目（--flat-playlist），不逐个获取格式信息；条目的 resolved 为 false，由 EntryResolver 按需补全
+    void setFlatPlaylist(bool flat);
+
+    // 从 yt-dlp 的视频信息（--dump-json 的一行）提取条目，无法识别时 vid 为空
+    static ParsedEntry parseSingleEntry(const QJsonObject &json);
 
 signals:
     void urlParsed(const QList<ParsedEntry> &entries);  // 保留用于兼容性
     void entryParsed(const ParsedEntry &entry);  // 新增：单个条目解析完成
     void logMessage(const QString &message);
     void errorOccurred(const QString &error);
+    void finished();  // 本次解析结束（成功、失败或命中缓存），之后可以开始下一次解析
 
 private slots:
     void onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
     void onProcessError(QProcess::ProcessError error);
     void onStandardOutput();
     void onStandardError();
+    void onHelperEvent(const QJsonObject &event);
+    void onHelperFailed(const QString &error);
 
 private:
-    void parseOutput(const QString &output);
-    QList<ParsedEntry> parseJsonOutput(const QString &jsonOutput);
-    ParsedEntry parseSingleEntry(const QJsonObject &json);
+    void startProcess(const QString &url);
+    bool startHelper(const QString &url);
+    void queueDecode(const QList<QByteArray> &lines);
+    void onDecoded(const QList<ParsedEntry> &entries, int failures, quint64 generation);
+    void completeProcess();
     void log(const QString &message);
     bool isValidUrl(const QString &url);
+    void deliverEntry(const ParsedEntry &entry);
+    void reportError(const QString &error);
+    void storeResults();
+    void finishParse();
 
     QProcess *m_process;
     QString m_program;
     bool m_isRunning;
+    bool m_pending;           // 已开始且尚未发出 finished 的解析
     bool m_hasParsedEntries;  // 标记是否已经通过流式读取解析了条目
+    YtDlpHelper *m_helper;    // 常驻 yt-dlp 助手（启用时按需创建）
+    QString m_helperJob;      // 当前助手请求的 ID
+    QString m_currentUrl;     // 当前解析的 URL（助手不可用时回退使用）
+    int m_helperJobCount;     // 已发送的助手请求数，用于生成请求 ID
+    bool m_usingHelper;       // 当前解析由助手执行
+    bool m_helperUnavailable; // 助手无法启动，之后直接使用 yt-dlp
+    ParseCache *m_cache;      // 解析结果缓存（可为空）
+    bool m_revalidate;        // 过期缓存先发送，再在后台重新解析
+    bool m_revalidating;      // 当前解析是对已发送缓存的重新验证
+    bool m_flatPlaylist;      // 播放列表只列出条目，不获取格式信息
+    QList<ParsedEntry> m_collected;  // 本次解析得到的条目，成功后写入缓存
+    QSet<QString> m_delivered;       // 已发送的视频ID，重新验证时不重复发送
+    LineBuffer m_stdout;             // 把 yt-dlp 输出切分为行
+    QThreadPool m_decoder;           // 单线程解码 JSON 行，按提交顺序完成
+    quint64 m_generation;            // 每次解析或取消时递增，丢弃过期的解码结果
+    int m_decodePending;             // 已提交但尚未返回的解码批次
+    int m_decodeFailures;            // 无法解析的输出行数
+    bool m_processFinished;          // 进程已退出，等待解码完成后再结束解析
+    int m_exitCode;
+    QProcess::ExitStatus m_exitStatus;
 };
 
 #endif // URLPARSER_H
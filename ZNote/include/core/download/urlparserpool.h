@@ -0,0 +1,139 @@
+/**
+ * @file urlparserpool.h
+ * @brief Concurrent parsing of many URLs
+ *
+ * Runs several UrlParser instances side by side, so pasting a list of URLs
+ * no longer means one yt-dlp round trip after another, and tags every
+ * result with the request it belongs to.
+ */
+
+#ifndef URLPARSERPOOL_H
+#define URLPARSERPOOL_H
+
+#include "core/download/task.h"
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+class UrlParser;
+class ParseCache;
+
+/**
+ * @class UrlParserPool
+ * @brief Queue of parse requests served by a bounded set of UrlParsers
+ *
+ * Requests are queued under IDs chosen by the caller (ParseWorker hands
+ * them out); the URL is parsed from the event loop as soon as one of the
+ * parsers is free.
+ * Every signal carries the request ID, and finished() is emitted exactly
+ * once per request that was not cancelled, after its last entry and error.
+ *
+ * Parsers are created on demand up to the concurrency limit and reused.
+ * With the yt-dlp helper enabled each parser runs its own helper. A parser
+ * whose request is cancelled is discarded, since its yt-dlp process may
+ * still be exiting. Signals from the thread it lives in; DownloadService runs
+ * it on the parse thread (see ParseWorker).
+ */
+class UrlParserPool : public QObject
+{
+    Q_OBJECT
+public:
+    explicit UrlParserPool(QObject *parent = nullptr);
+    ~UrlParserPool() override;
+
+    /**
+     * @brief Set how many URLs are parsed at once
+     * @param parsers Concurrent parsers (at least 1)
+     */
+    void setMaxParsers(int parsers);
+
+    /**
+     * @brief Set the parse result cache used by all parsers
+     * @param cache Cache (not owned, nullptr = none)
+     * @param revalidate Re-parse stale results in the background
+     */
+    void setCache(ParseCache *cache, bool revalidate);
+
+    /**
+     * @brief List playlists flat (see UrlParser::setFlatPlaylist())
+     * @param flat true to list playlist entries only
+     */
+    void setFlatPlaylist(bool flat);
+
+    /**
+     * @brief Queue one URL under an ID chosen by the caller
+     *
+     * URLs are parsed in the order they were queued as parsers become free.
+     *
+     * @param requestId Request ID, unique among queued and running requests
+     * @param url URL
+     */
+    void enqueue(const QString &requestId, const QString &url);
+
+    /**
+     * @brief Drop a queued request or stop a running one (no finished() follows)
+     * @param requestId Request ID
+     */
+    void cancel(const QString &requestId);
+
+    /**
+     * @brief Cancel all requests
+     */
+    void cancelAll();
+
+    /**
+     * @brief Check if no request is queued or running
+     * @return true when idle
+     */
+    bool isIdle() const;
+
+signals:
+    /**
+     * @brief One entry of a request was parsed
+     * @param requestId Request ID
+     * @param entry Parsed entry
+     */
+    void entryParsed(const QString &requestId, const ParsedEntry &entry);
+
+    /**
+     * @brief A request failed (or part of it)
+     * @param requestId Request ID
+     * @param error Error message
+     */
+    void errorOccurred(const QString &requestId, const QString &error);
+
+    /**
+     * @brief A request ended
+     * @param requestId Request ID
+     */
+    void finished(const QString &requestId);
+
+    /**
+     * @brief Diagnostic output
+     * @param msg Log message
+     */
+    void logMessage(const QString &msg);
+
+private:
+    struct Request
+    {
+        QString id;
+        QString url;
+    };
+
+    void startNext();
+    UrlParser *createParser();
+    void onParserFinished(UrlParser *parser);
+
+    QList<Request> m_queue;                 ///< Waiting requests, in order
+    QList<UrlParser *> m_idle;              ///< Parsers without a request
+    QHash<UrlParser *, QString> m_busy;     ///< Parser -> running request ID
+    int m_maxParsers;                       ///< Concurrency limit
+    ParseCache *m_cache;                    ///< Shared cache (may be null)
+    bool m_revalidate;                      ///< Cache revalidation
+    bool m_flatPlaylist;                    ///< Flat playlist listing
+};
+
+#endif // URLPARSERPOOL_H
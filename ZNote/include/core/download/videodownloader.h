@@ -3,10 +3,21 @@
 
 
 #include "core/download/task.h"
+#include "core/download/linebuffer.h"
 
 #include <QObject>
 #include <QProcess>
+#include <QList>
+#include <QHash>
+#include <QStringList>
 #include <QDebug>
+#include <memory>
+
+class QTemporaryFile;
+class QTimer;
+class QJsonObject;
+class YtDlpHelper;
+class SegmentedDownloader;
 
 
 class VideoDownloader : public QObject
@@ -14,25 +25,77 @@ class VideoDownloader : public QObject
     Q_OBJECT
 public:
     explicit VideoDownloader(QObject *parent = nullptr);
+    ~VideoDownloader() override;
 
+    // 单个任务的 backend 为 Native 时先用 yt-dlp 解析直链，再由内置分段下载器下载；不适用时回退到 yt-dlp
     void start(const DownloadTask &task);
+    // 批量下载：一个 yt-dlp 进程依次处理多个任务，每个任务完成时各发出一次 taskFinished
+    void start(const QList<DownloadTask> &batch);
+
+    // 当前平台是否支持挂起子进程（POSIX 的 SIGSTOP/SIGCONT）
+    static bool canSuspend();
 public slots:
     void cancel();
+    // 挂起/恢复 yt-dlp 及其子进程，下载进度保留在内存和 .part 文件中；挂起期间修改的限速在恢复时生效
+    void suspend();
+    void resume();
+    // 调整限速；进程运行中时会重启 yt-dlp 并续传，不发出 taskFinished（助手模式下直接生效）
+    void setRateLimit(qint64 bytesPerSecond);
 
 signals:
-    void logMessage(const QString& msg);
+    // 日志按批投递（最多每个刷新间隔一次），避免每行输出产生一个跨线程事件
+    void logBatch(const QStringList &messages);
     void taskStarted(const DownloadTask &task);
     void taskFinished(VideoDownloader *self, const DownloadTask &task);
+    void progressUpdated(VideoDownloader *self, const DownloadProgress &progress);
 
 private:
     void check();
+    void launchYtDlp();
+    void launch();
+    bool launchHelper();
+    void resolveDirectUrl();
+    qint64 activePid() const;
+    QString describe() const;
+    void addFile(const QString &taskId, const DownloadedFile &file);
+    void finishItem(const QString &taskId, DownloadStatus status = DownloadStatus::Success);
+    void finishRemaining(DownloadStatus status);
+    void log(const QString &msg);
+    void scheduleFlush();
+    void flush();
+    void reportProgress(DownloadProgress progress, bool streamFinished);
     void handleStdOutput();
+    void handleLine(QByteArrayView line);
     void handleFinished();
+    void handleHelperEvent(const QJsonObject &event);
+    void handleHelperFailed(const QString &error);
+    void handleResolved();
+    void handleNativeProgress(qint64 downloaded, qint64 total, qint64 speed);
+    void handleNativeFinished(bool success, const QString &error);
 
 private:
     QProcess *process;
     QString program;
-    DownloadTask currentTask;
+    QList<DownloadTask> tasks;      // 当前进程中尚未结束的任务
+    qint64 rateLimit;
+    QHash<QString, qint64> finishedBytes;   // 任务 ID -> 已下载完成的流（视频/音频）字节数
+    LineBuffer stdoutBuffer;                // yt-dlp 标准输出的行缓冲
+    QStringList pendingLogs;                // 等待下次刷新的日志
+    QHash<QString, DownloadProgress> pendingProgress;   // 每个任务最新的未投递进度
+    QTimer *flushTimer;
+    std::unique_ptr<QTemporaryFile> batchFile;
+    YtDlpHelper *helper;            // 常驻 yt-dlp 助手（启用时按需创建）
+    bool usingHelper;               // 当前任务由助手执行
+    bool helperUnavailable;         // 助手无法启动，之后直接使用 yt-dlp
+    SegmentedDownloader *native;    // 内置分段下载器（按需创建）
+    QProcess *resolver;             // 为内置下载解析直链的 yt-dlp 进程
+    QByteArray resolverOutput;
+    bool usingNative;               // 当前任务由内置下载器执行
+    bool restarting;
+    bool canceled;
+    bool suspended;
+    bool rateLimitPending;          // 挂起期间修改了限速，恢复时重启 yt-dlp 生效
+    bool startFailed;
 };
 
 #endif // VIDEODOWNLOADER_H
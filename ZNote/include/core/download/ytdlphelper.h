@@ -0,0 +1,166 @@
+/**
+ * @file ytdlphelper.h
+ * @brief Persistent yt-dlp helper process
+ *
+ * Wraps the bundled ytdlp_helper.py, a Python process that keeps yt-dlp
+ * loaded and serves download and extract-info requests over a JSON-lines
+ * protocol, so no interpreter is started per task.
+ */
+
+#ifndef YTDLPHELPER_H
+#define YTDLPHELPER_H
+
+#include "core/download/linebuffer.h"
+#include "core/download/processpolicy.h"
+#include <QObject>
+#include <QProcess>
+#include <QString>
+
+class QJsonObject;
+
+/**
+ * @class YtDlpHelper
+ * @brief One helper process serving jobs sequentially
+ *
+ * Requests are written to the helper's stdin as one JSON object per line;
+ * every line the helper prints is delivered through eventReceived(). The
+ * helper announces itself with a "ready" event; if it cannot be started or
+ * yt-dlp cannot be imported, failed() is emitted before isReady() becomes
+ * true and callers fall back to the yt-dlp executable.
+ *
+ * Callers report finished jobs with jobDone(); once isExhausted() the
+ * helper should be stopped while idle and a fresh one started, which keeps
+ * memory growth of the long-lived interpreter bounded.
+ *
+ * Lives in the thread that created it.
+ */
+class YtDlpHelper : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Process-wide helper configuration
+     */
+    struct Settings
+    {
+        bool enabled = false;   ///< Use the helper instead of yt-dlp processes
+        QString python;         ///< Python interpreter (empty = auto-detect)
+        int maxJobs = 50;       ///< Jobs served before the helper is recycled
+    };
+
+    /**
+     * @brief Replace the settings used by helpers started from now on
+     * @param settings New settings
+     */
+    static void setSettings(const Settings &settings);
+
+    /**
+     * @brief Get the current settings (thread-safe)
+     * @return Settings
+     */
+    static Settings settings();
+
+    /**
+     * @brief Get the path of the bundled helper script
+     * @return Script path next to the executable
+     */
+    static QString scriptPath();
+
+    explicit YtDlpHelper(QObject *parent = nullptr);
+    ~YtDlpHelper() override;
+
+    /**
+     * @brief Start the helper process if it is not running
+     * @return false if the script or interpreter cannot be found
+     */
+    bool start();
+
+    /**
+     * @brief Close stdin so the helper exits after its current job
+     */
+    void stop();
+
+    /**
+     * @brief Kill the helper immediately
+     */
+    void kill();
+
+    /**
+     * @brief Check if the process is running
+     * @return true while the process exists
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief Check if the last started process reported "ready"
+     * @return true once yt-dlp was imported successfully
+     */
+    bool isReady() const;
+
+    /**
+     * @brief Get the helper's process ID (for suspend/resume)
+     * @return PID, or 0 if not running
+     */
+    qint64 processId() const;
+
+    /**
+     * @brief Send one request line
+     * @param request JSON request
+     */
+    void send(const QJsonObject &request);
+
+    /**
+     * @brief Count one finished job toward the recycle limit
+     */
+    void jobDone();
+
+    /**
+     * @brief Check if the helper served its maximum number of jobs
+     * @return true if it should be recycled
+     */
+    bool isExhausted() const;
+
+    /**
+     * @brief Choose whose resource policy the helper process runs under
+     * @param stage Stage (default: ProcessPolicy::Stage::Download); applies from the next start()
+     */
+    void setStage(ProcessPolicy::Stage stage);
+
+signals:
+    /**
+     * @brief One event printed by the helper
+     * @param event Parsed JSON event
+     */
+    void eventReceived(const QJsonObject &event);
+
+    /**
+     * @brief Diagnostic output (helper stderr)
+     * @param msg Log message
+     */
+    void logMessage(const QString &msg);
+
+    /**
+     * @brief The helper could not start or exited without being stopped
+     *
+     * Never emitted from within start().
+     *
+     * @param error Description
+     */
+    void failed(const QString &error);
+
+private:
+    void handleStdOutput();
+    void handleLine(QByteArrayView view);
+    void handleFinished();
+    static QString findPython(const QString &configured);
+
+    QProcess *m_process;        ///< Helper process (created on first start)
+    LineBuffer m_stdout;        ///< Splits helper output into events
+    QString m_fatal;            ///< Error reported by a "fatal" event
+    int m_jobs;                 ///< Jobs served by the current process
+    int m_maxJobs;              ///< Recycle limit captured at start
+    bool m_ready;               ///< "ready" event received
+    ProcessPolicy::Stage m_stage; ///< Resource policy of the helper process
+};
+
+#endif // YTDLPHELPER_H
@@ -11,6 +11,7 @@
 #include "core/download/task.h"
 #include <QObject>
 #include <QList>
+#include <QStringList>
 
 /**
  * @class IDownloadService
@@ -33,10 +34,42 @@ public:
 
     /**
      * @brief Parse a video URL and extract video information
+     * 
+     * Parses run concurrently off the GUI thread; parsed tasks arrive in
+     * batches through tasksReady(), and statistics carry the returned
+     * request ID.
+     * 
      * @param url The video URL to parse
      * @param savePath The directory to save downloaded videos
+     * @return Request ID (empty if the request was rejected)
      */
-    virtual void parseUrl(const QString &url, const QString &savePath) = 0;
+    virtual QString parseUrl(const QString &url, const QString &savePath) = 0;
+    
+    /**
+     * @brief Parse several video URLs
+     * @param urls The video URLs to parse
+     * @param savePath The directory to save downloaded videos
+     * @return One request ID per URL (empty if the request was rejected)
+     */
+    virtual QStringList parseUrls(const QStringList &urls, const QString &savePath) = 0;
+    
+    /**
+     * @brief Cancel a parse request (no parseFinished() follows)
+     * @param requestId Request ID returned by parseUrl()/parseUrls()
+     */
+    virtual void cancelParse(const QString &requestId) = 0;
+    
+    /**
+     * @brief Fetch full metadata for unresolved (flat playlist) tasks
+     * 
+     * Replaces the previous request: entries that are no longer selected or
+     * visible and have not started yet are dropped. Results arrive through
+     * taskResolved().
+     * 
+     * @param selected Tasks selected for download (resolved first)
+     * @param visible Tasks currently shown
+     */
+    virtual void resolveTasks(const QList<DownloadTask> &selected, const QList<DownloadTask> &visible) = 0;
     
     /**
      * @brief Add a single download task
@@ -61,6 +94,29 @@ public:
      */
     virtual void clearTasks() = 0;
     
+    /**
+     * @brief Change the priority of a queued task
+     * @param taskId The ID of the task
+     * @param priority New priority (higher downloads first)
+     * @return true if the task was still queued
+     */
+    virtual bool setTaskPriority(const QString &taskId, int priority) = 0;
+    
+    /**
+     * @brief Change or clear the deadline of a queued task
+     * @param taskId The ID of the task
+     * @param deadline New deadline (invalid = none)
+     * @return true if the task was still queued
+     */
+    virtual bool setTaskDeadline(const QString &taskId, const QDateTime &deadline) = 0;
+    
+    /**
+     * @brief Move a queued task ahead of all others
+     * @param taskId The ID of the task
+     * @return true if the task was still queued
+     */
+    virtual bool moveTaskToFront(const QString &taskId) = 0;
+    
     /**
      * @brief Start downloading all queued tasks
      */
@@ -131,13 +187,20 @@ public:
 
 signals:
     void taskReady(const DownloadTask &task);
+    void tasksReady(const QList<DownloadTask> &tasks);  // 解析得到的一批任务（解析线程按批送回）
+    void taskResolved(const DownloadTask &task);  // 扁平列表中的任务已获取完整信息
+    void tasksRestored(const QList<DownloadTask> &tasks);  // 从任务日志恢复的任务，已在下载队列中（不是解析结果）
     void taskStarted(const DownloadTask &task);
-    void taskProgress(const QString &taskId, float progress);
+    // 任务进度（0.0 - 1.0）及字节数、速度、剩余时间；taskId 为空时表示整体进度，detail 无意义
+    void taskProgress(const QString &taskId, float progress, const DownloadProgress &detail);
     void taskFinished(const DownloadTask &task);
     void taskError(const QString &taskId, const QString &error);
     void allTasksFinished();
     void logMessage(const QString &message);
-    void parseStatsUpdated(int total, int success, int failed);  // 解析统计更新
+    void parseStatsUpdated(const QString &requestId, int total, int success, int failed);  // 单个解析请求的统计更新
+    void parseError(const QString &requestId, const QString &error);  // 解析请求失败
+    void parseFinished(const QString &requestId, int success, int failed);  // 解析请求结束
+    void concurrencyChanged(int level, const QString &reason);  // 自适应并发调整
 };
 
 #endif // IDOWNLOADSERVICE_H
@@ -12,21 +12,27 @@
 #include "core/interfaces/ihistoryservice.h"
 #include "core/interfaces/iconfigservice.h"
 #include "core/download/taskqueue.h"
-#include "core/download/urlparser.h"
+#include "core/download/parseworker.h"
+#include "core/download/taskjournal.h"
+#include "core/download/parsecache.h"
 #include <QObject>
 #include <QTimer>
 #include <QMutex>
+#include <QHash>
 #include <memory>
 
+class QThread;
+
 /**
  * @class DownloadService
  * @brief Main download service coordinating all download operations
  * 
  * Responsibilities:
- * - URL parsing and video information extraction
+ * - URL parsing and video information extraction (on a dedicated parse thread)
  * - Task queue management
  * - Download progress tracking
  * - History management
+ * - Queue persistence through a write-ahead journal
  * - Error handling and recovery
  */
 class DownloadService : public IDownloadService
@@ -46,11 +52,17 @@ public:
     ~DownloadService() override;
 
     // IDownloadService interface
-    void parseUrl(const QString &url, const QString &savePath) override;
+    QString parseUrl(const QString &url, const QString &savePath) override;
+    QStringList parseUrls(const QStringList &urls, const QString &savePath) override;
+    void cancelParse(const QString &requestId) override;
+    void resolveTasks(const QList<DownloadTask> &selected, const QList<DownloadTask> &visible) override;
     void addTask(const DownloadTask &task) override;
     void addTasks(const QList<DownloadTask> &tasks) override;
     void removeTask(const QString &taskId) override;
     void clearTasks() override;
+    bool setTaskPriority(const QString &taskId, int priority) override;
+    bool setTaskDeadline(const QString &taskId, const QDateTime &deadline) override;
+    bool moveTaskToFront(const QString &taskId) override;
     
     void startDownload() override;
     void pauseDownload() override;
@@ -69,32 +81,52 @@ public:
 
 private slots:
     void onTaskFinished(const DownloadTask &task);
+    void onTaskProgress(const DownloadProgress &progress);
     void onAllTasksFinished();
     void onTaskError(const QString &taskId, const QString &error);
-    void onEntryParsed(const ParsedEntry &entry);  // 新增：单个条目解析完成（生产者-消费者模式）
-    void onUrlParsed(const QList<ParsedEntry> &entries);  // 保留用于兼容性
-    void onUrlParseError(const QString &error);
+    void onEntriesParsed(const QString &requestId, const QList<ParsedEntry> &entries);  // 解析线程送来的一批条目
+    void onUrlParseError(const QString &requestId, const QString &error);
+    void onUrlParseFinished(const QString &requestId);
+    void onEntryResolved(const ParsedEntry &entry);  // 扁平列表中的条目已按需解析
     void updateProgress();
 
 private:
     void setupConnections();
+    void applyQueueSettings();  // 从配置读取队列调度相关选项
+    void restoreQueue();  // 从日志恢复上次未完成的任务
     void updateTaskProgress();
     DownloadTask createDownloadTask(const ParsedEntry &entry, const QString &savePath);
+    DownloadTask taskFromEntry(const ParsedEntry &entry, const QString &savePath) const;
     void logMessage(const QString &message);
 
     IConfigService *m_configService;
     IHistoryService *m_historyService;
     std::unique_ptr<TaskQueue> m_taskQueue;
-    std::unique_ptr<UrlParser> m_urlParser;
+    std::unique_ptr<ParseCache> m_parseCache;  // 解析结果缓存（未启用时为空），需晚于解析线程结束
+    QThread *m_parseThread;      // 解析线程：yt-dlp 进程、行切分和 JSON 解码都不在 GUI 线程
+    ParseWorker *m_parseWorker;  // 解析线程中的解析器池和 EntryResolver，结果按批送回
+    std::unique_ptr<TaskJournal> m_journal;  // 队列预写日志（未启用时为空）
     
     QList<DownloadTask> m_pendingTasks;
     QList<DownloadTask> m_completedTasks;
     QList<DownloadTask> m_failedTasks;
+    QHash<QString, DownloadProgress> m_taskProgress;  // 运行中任务的最新进度
+    qint64 m_completedBytes;  // 已结束且大小已知的任务的总字节数
+    int m_completedUnknown;   // 已结束但大小未知的任务数
     
     mutable QMutex m_mutex;
     QTimer *m_progressTimer;
     
-    QString m_currentSavePath;  // 当前解析的保存路径
+    // 解析请求：保存路径和统计按请求 ID 记录，并发解析时互不干扰
+    struct ParseRequest
+    {
+        QString savePath;
+        int total = 0;    // 解析总数
+        int success = 0;  // 解析成功数
+        int failed = 0;   // 解析失败数
+    };
+    QHash<QString, ParseRequest> m_parseRequests;
+    QString m_currentSavePath;  // 最近一次解析的保存路径
     
     int m_totalTasks;
     int m_completedCount;
@@ -102,10 +134,7 @@ private:
     bool m_isRunning;
     bool m_isPaused;
     
-    // 解析统计
-    int m_parseTotal;  // 解析总数
-    int m_parseSuccess;  // 解析成功数
-    int m_parseFailed;  // 解析失败数
+    int m_submissionCount;  // 提交批次计数（用于公平调度分组）
 };
 
 #endif // DOWNLOADSERVICE_H
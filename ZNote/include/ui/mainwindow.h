@@ -17,11 +17,14 @@
 
 #include <QMainWindow>
 #include <QButtonGroup>
+#include <QHash>
+#include <QSet>
 #include <memory>
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
 class QSoundEffect;
+class QTimer;
 QT_END_NAMESPACE
 
 /**
@@ -62,6 +65,24 @@ private slots:
      */
     void onTaskReady(const DownloadTask &task);
     
+    /**
+     * @brief Handle a batch of parsed tasks
+     * @param tasks Parsed tasks in playlist order
+     */
+    void onTasksReady(const QList<DownloadTask> &tasks);
+    
+    /**
+     * @brief Handle full metadata of a flat playlist task
+     * @param task Resolved task
+     */
+    void onTaskResolved(const DownloadTask &task);
+    
+    /**
+     * @brief Handle tasks restored from the journal into the download queue
+     * @param tasks Restored tasks
+     */
+    void onTasksRestored(const QList<DownloadTask> &tasks);
+    
     /**
      * @brief Handle download progress update
      * @param taskId Task ID
@@ -95,11 +116,27 @@ private slots:
     
     /**
      * @brief Handle parse statistics update
+     * @param requestId Parse request ID
      * @param total Total parsed count
      * @param success Successfully parsed count
      * @param failed Failed parse count
      */
-    void onParseStatsUpdated(int total, int success, int failed);
+    void onParseStatsUpdated(const QString &requestId, int total, int success, int failed);
+    
+    /**
+     * @brief Handle a failed parse request
+     * @param requestId Parse request ID
+     * @param error Error message
+     */
+    void onParseError(const QString &requestId, const QString &error);
+    
+    /**
+     * @brief Handle the end of a parse request
+     * @param requestId Parse request ID
+     * @param success Successfully parsed count
+     * @param failed Failed parse count
+     */
+    void onParseFinished(const QString &requestId, int success, int failed);
     
     // UI button handlers
     void on_btnResolve_clicked();          ///< Parse URL button
@@ -129,6 +166,11 @@ private slots:
      * @brief Update status bar with current progress
      */
     void updateStatusBar();
+    
+    /**
+     * @brief Ask for metadata of the unresolved tasks that are selected or visible
+     */
+    void requestResolve();
 
 private:
     /**
@@ -184,13 +226,25 @@ private:
     // 状态标志
     bool m_isFirstTaskInBatch;  // 标记是否是批次中的第一个任务
     
-    // 解析统计
+    // 解析统计（当前批次中所有请求的合计）
+    struct ParseStats
+    {
+        int total = 0;
+        int success = 0;
+        int failed = 0;
+    };
+    QHash<QString, ParseStats> m_parseStats;  // 当前批次各请求的统计
+    QSet<QString> m_pendingParses;            // 当前批次中尚未结束的请求
+    int m_parseBatchSize;                     // 当前批次的 URL 数
     int m_parseTotal;
     int m_parseSuccess;
     int m_parseFailed;
     
     // 声音效果
     QSoundEffect *m_soundEffect;
+    
+    // 滚动和勾选后延迟请求按需解析，避免连续滚动时频繁更新
+    QTimer *m_resolveTimer;
 };
 
 #endif // MAINWINDOW_H
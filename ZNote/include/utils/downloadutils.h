@@ -2,6 +2,8 @@
 #define DOWNLOADUTILS_H
 
 #include "core/download/task.h"
+#include <QByteArrayView>
+#include <QJsonObject>
 #include <QList>
 #include <QString>
 
@@ -13,6 +15,28 @@ namespace utils {
 // 构建下载命令
 QList<QString> buildDownloadCommand(const DownloadTask &task, IConfigService *configService = nullptr);
 
+// 构建批量下载命令：一个 yt-dlp 进程下载批处理文件中的所有 URL
+QList<QString> buildBatchDownloadCommand(const QList<DownloadTask> &tasks, const QString &batchFile,
+                                         IConfigService *configService = nullptr);
+
+// 构建解析直链的命令：输出所选格式的 JSON 信息（url、http_headers、filename），不下载
+QList<QString> buildResolveCommand(const DownloadTask &task);
+
+// 构建 yt-dlp 助手进程的下载参数（YoutubeDL 选项）
+QJsonObject buildHelperDownloadOptions(const DownloadTask &task);
+
+// 解析批量模式下的条目完成标记行，成功时输出任务 ID
+bool parseBatchItemDone(QByteArrayView line, QString *taskId);
+
+// 解析推迟后处理时每个下载好的流文件的标记行，输出视频ID和文件
+bool parseFileMarker(QByteArrayView line, QString *taskId, DownloadedFile *file);
+
+// 解析 --progress-template 输出的进度行，例如
+// "[znote] progress downloading 4194304 10485760 NA 1572864 4 dQw4w9WgXcQ"
+// 结果只描述当前流（视频或音频）；finished 表示该流已下载完成
+// 直接解析输出的原始字节，不为每个进度行分配字符串
+bool parseProgressLine(QByteArrayView line, DownloadProgress *progress, bool *finished);
+
 // 打印命令
 void printCommand(const QList<QString> &command);
 
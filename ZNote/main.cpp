@@ -20,6 +20,7 @@ int main(int argc, char *argv[])
     // 注册元类型，用于跨线程信号传递
     qRegisterMetaType<DownloadTask>("DownloadTask");
     qRegisterMetaType<DownloadTask>("DownloadTask&");
+    qRegisterMetaType<DownloadProgress>("DownloadProgress");
 
     Application app(argc, argv);
     
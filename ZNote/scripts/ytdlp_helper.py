@@ -0,0 +1,253 @@
+#!/usr/bin/env python3
+"""Long-lived yt-dlp helper for ZNote.
+
+Reads one JSON request per line on stdin and writes one JSON event per line
+on stdout, so the application can reuse a single Python interpreter (and the
+already imported yt-dlp extractors) for many downloads and parses.
+
+Requests:
+    {"id": "...", "op": "download", "url": "...", "options": {...}}
+    {"id": "...", "op": "extract", "url": "...", "flat": false}  "flat" lists playlist entries only
+    {"op": "cancel"}                     abort the running job, drop queued ones
+    {"op": "set", "ratelimit": 1048576}  change the rate limit of running/queued jobs
+
+Events:
+    {"event": "ready", "version": "..."}
+    {"event": "fatal", "error": "..."}   yt-dlp is not importable; the helper exits
+    {"id": "...", "event": "progress", "status": "downloading" | "finished",
+     "downloaded": n, "total": n, "speed": n, "eta": n}   one stream (video or audio)
+    {"id": "...", "event": "info", "info": {...}}  one per video for "extract",
+                                                   only the fields ZNote reads
+    {"id": "...", "event": "file", "path": "...", "video": true}  one per downloaded file
+    {"id": "...", "event": "log", "message": "..."}
+    {"id": "...", "event": "done", "status": "ok" | "error" | "canceled", "error": "..."}
+
+Jobs run one at a time in request order. The helper exits when stdin is closed.
+"""
+
+import json
+import queue
+import sys
+import threading
+import time
+
+PROGRESS_INTERVAL = 0.5  # seconds between progress events of one job
+
+# Fields of an info dict (and of each of its formats) the application reads;
+# the rest (thumbnails, HTTP headers, fragments) would only be parsed and dropped
+INFO_FIELDS = ("id", "title", "webpage_url", "url", "_type", "duration", "thumbnail", "ext",
+               "filesize", "filesize_approx", "playlist", "playlist_index", "playlist_count",
+               "playlist_title")
+FORMAT_FIELDS = ("format_id", "ext", "vcodec", "acodec", "height", "filesize", "filesize_approx")
+
+_out_lock = threading.Lock()
+
+
+def emit(event):
+    # ensure_ascii keeps the output independent of the console code page
+    line = json.dumps(event, ensure_ascii=True, default=str)
+    with _out_lock:
+        sys.stdout.write(line + "\n")
+        sys.stdout.flush()
+
+
+try:
+    import yt_dlp
+    from yt_dlp.postprocessor.common import PostProcessor
+    from yt_dlp.utils import DownloadCancelled
+except Exception as exc:  # noqa: BLE001 - report any import problem to the app
+    emit({"event": "fatal", "error": "cannot import yt_dlp: %s" % exc})
+    sys.exit(2)
+
+
+class State:
+    """Shared between the stdin reader thread and the job loop."""
+
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.generation = 0     # bumped by "cancel"; older jobs are dropped
+        self.ratelimit = None   # override from "set"
+        self.ydl = None         # YoutubeDL of the running download
+
+
+state = State()
+jobs = queue.Queue()
+
+
+class Logger:
+    def __init__(self, job_id):
+        self.job_id = job_id
+
+    def _log(self, message):
+        emit({"id": self.job_id, "event": "log", "message": message})
+
+    def debug(self, message):
+        # yt-dlp routes normal output through debug(); skip real debug lines
+        if not message.startswith("[debug] "):
+            self._log(message)
+
+    def info(self, message):
+        self._log(message)
+
+    def warning(self, message):
+        self._log("WARNING: " + message)
+
+    def error(self, message):
+        self._log(message)
+
+
+class FileReporter(PostProcessor):
+    """Reports every file in its final place, like --print after_move:filepath.
+
+    When formats are downloaded separately the application merges them
+    itself and needs the path of each one.
+    """
+
+    def __init__(self, ydl, job_id):
+        super().__init__(ydl)
+        self.job_id = job_id
+
+    def run(self, info):
+        emit({
+            "id": self.job_id,
+            "event": "file",
+            "path": info.get("filepath"),
+            "video": info.get("vcodec") != "none",
+        })
+        return [], info
+
+
+def is_canceled(generation):
+    with state.lock:
+        return generation != state.generation
+
+
+def run_download(job_id, url, options, generation):
+    last = [0.0]
+
+    def hook(d):
+        if is_canceled(generation):
+            raise DownloadCancelled()
+        status = d.get("status")
+        now = time.monotonic()
+        if status == "downloading" and now - last[0] < PROGRESS_INTERVAL:
+            return
+        last[0] = now
+        if status in ("downloading", "finished"):
+            emit({
+                "id": job_id,
+                "event": "progress",
+                "status": status,
+                "downloaded": d.get("downloaded_bytes") or 0,
+                "total": d.get("total_bytes") or d.get("total_bytes_estimate") or 0,
+                "speed": d.get("speed") or 0,
+                "eta": d.get("eta") if d.get("eta") is not None else -1,
+            })
+
+    params = dict(options)
+    params.update({
+        "quiet": True,
+        "noprogress": True,
+        "logger": Logger(job_id),
+        "progress_hooks": [hook],
+    })
+    with state.lock:
+        if state.ratelimit is not None:
+            params["ratelimit"] = state.ratelimit or None
+
+    with yt_dlp.YoutubeDL(params) as ydl:
+        ydl.add_post_processor(FileReporter(ydl, job_id), when="after_move")
+        with state.lock:
+            state.ydl = ydl
+        try:
+            return ydl.download([url]) == 0
+        finally:
+            with state.lock:
+                state.ydl = None
+
+
+def project_info(info):
+    entry = {key: info[key] for key in INFO_FIELDS if key in info}
+    formats = info.get("formats")
+    if isinstance(formats, list):
+        entry["formats"] = [{key: fmt[key] for key in FORMAT_FIELDS if key in fmt}
+                            for fmt in formats if isinstance(fmt, dict)]
+    return entry
+
+
+def run_extract(job_id, url, generation, flat=False):
+    params = {
+        "quiet": True,
+        "no_warnings": True,
+        "logger": Logger(job_id),
+    }
+    if flat:
+        # Like --flat-playlist: list playlist entries without resolving each one
+        params["extract_flat"] = "in_playlist"
+    with yt_dlp.YoutubeDL(params) as ydl:
+        info = ydl.sanitize_info(ydl.extract_info(url, download=False))
+    # Same shape as --dump-json: one object per video, playlist fields included
+    entries = info.get("entries") if info.get("_type") == "playlist" else [info]
+    for entry in entries or []:
+        if is_canceled(generation):
+            return False
+        if entry:
+            emit({"id": job_id, "event": "info", "info": project_info(entry)})
+    return True
+
+
+def read_requests():
+    stdin = sys.stdin.buffer
+    for raw in stdin:
+        try:
+            request = json.loads(raw.decode("utf-8"))
+        except ValueError:
+            continue
+        op = request.get("op")
+        if op == "cancel":
+            with state.lock:
+                state.generation += 1
+        elif op == "set":
+            with state.lock:
+                state.ratelimit = int(request.get("ratelimit") or 0)
+                # HttpFD reads params["ratelimit"] for every block, so the
+                # running download picks the new limit up without restarting
+                if state.ydl is not None:
+                    state.ydl.params["ratelimit"] = state.ratelimit or None
+        elif op in ("download", "extract"):
+            with state.lock:
+                generation = state.generation
+            jobs.put((request, generation))
+    jobs.put(None)
+
+
+def main():
+    threading.Thread(target=read_requests, daemon=True).start()
+    emit({"event": "ready", "version": yt_dlp.version.__version__})
+
+    while True:
+        item = jobs.get()
+        if item is None:
+            break
+        request, generation = item
+        job_id = request.get("id", "")
+        if is_canceled(generation):
+            emit({"id": job_id, "event": "done", "status": "canceled"})
+            continue
+        try:
+            if request["op"] == "download":
+                ok = run_download(job_id, request["url"], request.get("options") or {}, generation)
+            else:
+                ok = run_extract(job_id, request["url"], generation, bool(request.get("flat")))
+            if is_canceled(generation):
+                emit({"id": job_id, "event": "done", "status": "canceled"})
+            else:
+                emit({"id": job_id, "event": "done", "status": "ok" if ok else "error"})
+        except DownloadCancelled:
+            emit({"id": job_id, "event": "done", "status": "canceled"})
+        except Exception as exc:  # noqa: BLE001 - one bad job must not end the helper
+            emit({"id": job_id, "event": "done", "status": "error", "error": str(exc)})
+
+
+if __name__ == "__main__":
+    main()
@@ -126,6 +126,29 @@ void VideoModel::addTask(const DownloadTask& task)
 	endInsertRows();
 }
 
+void VideoModel::addTasks(const QList<DownloadTask>& tasks)
+{
+	if (tasks.isEmpty()) return;
+
+	beginInsertRows(QModelIndex(), taskItems.count(), taskItems.count() + tasks.count() - 1);
+	taskItems.reserve(taskItems.count() + tasks.count());
+	for (const DownloadTask& task : tasks) {
+		taskItems.append(new DownloadTask(task));
+	}
+	endInsertRows();
+}
+
+void VideoModel::updateTask(const DownloadTask& task)
+{
+	for (int row = 0; row < taskItems.count(); ++row) {
+		if (taskItems.at(row)->id == task.id) {
+			taskItems[row]->video = task.video;
+			emit dataChanged(index(row, 0), index(row, columnCount() - 1), { Qt::DisplayRole });
+			return;
+		}
+	}
+}
+
 void VideoModel::removeTasks(const QList<int>& rows)
 {
 	// 从后往前开始删除，避免删除时索引变化
@@ -0,0 +1,151 @@
+#include "core/download/concurrencycontroller.h"
+#include <QtGlobal>
+
+namespace {
+constexpr int kWindowSamples = 3;        // 每个评估窗口的采样数
+constexpr double kGainThreshold = 1.10;  // 提升至少 10% 才算有效
+constexpr double kDropThreshold = 0.90;  // 下降超过 10% 视为拥塞
+constexpr int kProbeCooldown = 6;        // 试探无效后暂停的窗口数
+constexpr int kFailureCooldown = 4;      // 失败回退后暂停的窗口数
+}
+
+ConcurrencyController::ConcurrencyController()
+    : m_level(1)
+    , m_min(1)
+    , m_max(16)
+    , m_samples(0)
+    , m_sum(0.0)
+    , m_failures(0)
+    , m_saturated(true)
+    , m_baseline(0.0)
+    , m_probing(false)
+    , m_settle(0)
+    , m_cooldown(0)
+{
+}
+
+void ConcurrencyController::setRange(int minLevel, int maxLevel)
+{
+    m_min = qMax(1, minLevel);
+    m_max = qMax(m_min, maxLevel);
+    m_level = qBound(m_min, m_level, m_max);
+}
+
+void ConcurrencyController::reset(int level)
+{
+    m_level = qBound(m_min, level, m_max);
+    m_samples = 0;
+    m_sum = 0.0;
+    m_failures = 0;
+    m_saturated = true;
+    m_baseline = 0.0;
+    m_probing = false;
+    m_settle = 1;
+    m_cooldown = 0;
+    m_reason.clear();
+}
+
+int ConcurrencyController::level() const
+{
+    return m_level;
+}
+
+QString ConcurrencyController::reason() const
+{
+    return m_reason;
+}
+
+bool ConcurrencyController::addSample(qint64 bytesPerSecond, int failures, bool saturated)
+{
+    m_sum += bytesPerSecond;
+    m_failures += failures;
+    m_saturated = m_saturated && saturated;
+    if (++m_samples < kWindowSamples) {
+        return false;
+    }
+
+    double throughput = m_sum / m_samples;
+    int windowFailures = m_failures;
+    bool windowSaturated = m_saturated;
+    m_samples = 0;
+    m_sum = 0.0;
+    m_failures = 0;
+    m_saturated = true;
+
+    return evaluate(throughput, windowFailures, windowSaturated);
+}
+
+bool ConcurrencyController::evaluate(double throughput, int failures, bool saturated)
+{
+    // 失败优先处理：乘性减小
+    if (failures > 0) {
+        if (m_level > m_min) {
+            changeLevel(qMax(m_min, m_level / 2),
+                        QString("%1 个任务失败，并发减半").arg(failures));
+            m_cooldown = kFailureCooldown;
+            return true;
+        }
+        m_probing = false;
+        return false;
+    }
+
+    // 刚调整过，新任务还在起速，丢弃这个窗口
+    if (m_settle > 0) {
+        --m_settle;
+        return false;
+    }
+
+    const double mib = 1024.0 * 1024.0;
+
+    if (m_probing) {
+        m_probing = false;
+        double gain = m_baseline > 0.0 ? throughput / m_baseline : kGainThreshold;
+        QString change = QString("%1 → %2 MiB/s").arg(m_baseline / mib, 0, 'f', 2).arg(throughput / mib, 0, 'f', 2);
+
+        if (gain >= kGainThreshold) {
+            // 试探有效：继续加性增长
+            m_baseline = throughput;
+            if (saturated && m_level < m_max) {
+                changeLevel(m_level + 1, QString("吞吐提升 %1%（%2），继续增加并发")
+                                             .arg(qRound((gain - 1.0) * 100)).arg(change));
+                m_probing = true;
+                return true;
+            }
+            return false;
+        }
+
+        if (gain < kDropThreshold) {
+            // 并发过高导致吞吐下降：回退四分之一
+            changeLevel(qMax(m_min, m_level - qMax(1, m_level / 4)),
+                        QString("吞吐下降（%1），减少并发").arg(change));
+        } else {
+            // 吞吐持平：撤销这次试探，稍后再试
+            changeLevel(qMax(m_min, m_level - 1),
+                        QString("吞吐持平（%1），撤销增加").arg(change));
+        }
+        m_cooldown = kProbeCooldown;
+        return true;
+    }
+
+    m_baseline = throughput;
+    if (m_cooldown > 0) {
+        --m_cooldown;
+        return false;
+    }
+
+    // 所有槽位都忙且仍有排队任务时才试探，否则增加并发没有意义
+    if (saturated && m_level < m_max) {
+        changeLevel(m_level + 1, QString("试探增加并发（当前 %1 MiB/s）").arg(throughput / mib, 0, 'f', 2));
+        m_probing = true;
+        return true;
+    }
+    return false;
+}
+
+void ConcurrencyController::changeLevel(int level, const QString &reason)
+{
+    m_level = level;
+    m_reason = reason;
+    m_probing = false;
+    m_settle = 1;
+}
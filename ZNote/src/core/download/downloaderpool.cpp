@@ -0,0 +1,190 @@
+#include "core/download/downloaderpool.h"
+#include "core/download/videodownloader.h"
+#include "core/download/processreactor.h"
+#include <QThread>
+#include <QDebug>
+
+DownloaderPool::DownloaderPool(int size, QObject *parent)
+    : QObject(parent)
+    , m_ioThread(nullptr)
+    , m_reactor(nullptr)
+    , m_size(qMax(1, size))
+    , m_reactorMode(false)
+{
+}
+
+DownloaderPool::~DownloaderPool()
+{
+    // 退出所有工作线程（包括正在回收的和 I/O 线程），downloader 在线程结束时自动删除
+    const QList<QThread*> threads = findChildren<QThread*>(Qt::FindDirectChildrenOnly);
+    for (QThread *thread : threads) {
+        thread->quit();
+    }
+    for (QThread *thread : threads) {
+        thread->wait();
+    }
+}
+
+void DownloaderPool::resize(int size)
+{
+    m_size = qMax(1, size);
+
+    // 立即回收多余的空闲线程，忙碌的线程在 release 时回收
+    while (m_threads.size() > m_size && !m_idle.isEmpty()) {
+        retireWorker(m_idle.takeLast());
+    }
+}
+
+int DownloaderPool::size() const
+{
+    return m_size;
+}
+
+int DownloaderPool::busyCount() const
+{
+    return m_busy.size();
+}
+
+void DownloaderPool::setReactorMode(bool enabled)
+{
+    if (m_reactorMode == enabled) {
+        return;
+    }
+    m_reactorMode = enabled;
+
+    // 空闲的下载器按新模式重建，忙碌的在 release 时回收
+    while (!m_idle.isEmpty()) {
+        retireWorker(m_idle.takeLast());
+    }
+
+    qDebug() << "Downloader reactor mode:" << enabled;
+}
+
+bool DownloaderPool::isReactorMode() const
+{
+    return m_reactorMode;
+}
+
+VideoDownloader *DownloaderPool::acquire()
+{
+    VideoDownloader *downloader = nullptr;
+    if (!m_idle.isEmpty()) {
+        downloader = m_idle.takeFirst();
+    } else if (m_threads.size() < m_size) {
+        downloader = spawnWorker();
+    }
+
+    if (downloader) {
+        m_busy.insert(downloader);
+    }
+    return downloader;
+}
+
+void DownloaderPool::release(VideoDownloader *downloader)
+{
+    if (!m_busy.remove(downloader)) {
+        return;
+    }
+
+    bool modeChanged = (m_threads.value(downloader) == m_ioThread) != m_reactorMode;
+    if (m_threads.size() > m_size || modeChanged) {
+        retireWorker(downloader);
+    } else {
+        m_idle.append(downloader);
+    }
+}
+
+void DownloaderPool::dispatch(VideoDownloader *downloader, const DownloadTask &task)
+{
+    // 在线程中调用 start，QProcess 会在工作线程中创建并复用
+    QMetaObject::invokeMethod(downloader, [downloader, task]() {
+        downloader->start(task);
+    }, Qt::QueuedConnection);
+}
+
+void DownloaderPool::dispatch(VideoDownloader *downloader, const QList<DownloadTask> &tasks)
+{
+    QMetaObject::invokeMethod(downloader, [downloader, tasks]() {
+        downloader->start(tasks);
+    }, Qt::QueuedConnection);
+}
+
+void DownloaderPool::onLogBatch(const QStringList &messages)
+{
+    // 一批日志合并为一条多行消息，经 TaskQueue、DownloadService 到界面只产生一次事件
+    if (!messages.isEmpty()) {
+        emit logMessage(messages.join('\n'));
+    }
+}
+
+VideoDownloader *DownloaderPool::spawnWorker()
+{
+    VideoDownloader *downloader = new VideoDownloader();
+    QThread *thread = nullptr;
+
+    if (m_reactorMode) {
+        // reactor 模式：所有下载器共享一个 I/O 线程，由其事件循环统一监听子进程管道
+        thread = ensureIoThread();
+        downloader->moveToThread(thread);
+        connect(thread, &QThread::finished, downloader, &VideoDownloader::deleteLater);
+        m_reactor->attach(downloader);
+    } else {
+        thread = new QThread(this);
+        downloader->moveToThread(thread);
+
+        // 信号只连接一次，之后每个任务复用（QueuedConnection 确保在池所在线程处理）
+        connect(downloader, &VideoDownloader::logBatch, this, &DownloaderPool::onLogBatch, Qt::QueuedConnection);
+        connect(downloader, &VideoDownloader::progressUpdated, this, &DownloaderPool::progressUpdated, Qt::QueuedConnection);
+        connect(downloader, &VideoDownloader::taskFinished, this, &DownloaderPool::taskFinished, Qt::QueuedConnection);
+
+        // 线程结束时清理
+        connect(thread, &QThread::finished, downloader, &VideoDownloader::deleteLater);
+        connect(thread, &QThread::finished, thread, &QThread::deleteLater);
+
+        thread->start();
+    }
+
+    m_threads.insert(downloader, thread);
+
+    qDebug() << "Download worker spawned, workers:" << m_threads.size();
+    return downloader;
+}
+
+void DownloaderPool::retireWorker(VideoDownloader *downloader)
+{
+    QThread *thread = m_threads.take(downloader);
+    if (!thread) {
+        return;
+    }
+
+    disconnect(downloader, nullptr, this, nullptr);
+    if (thread == m_ioThread) {
+        // I/O 线程是共享的，只删除下载器本身（deleteLater 在 I/O 线程执行）
+        downloader->deleteLater();
+    } else {
+        thread->quit();
+    }
+
+    qDebug() << "Download worker retired, workers:" << m_threads.size();
+}
+
+QThread *DownloaderPool::ensureIoThread()
+{
+    if (m_ioThread) {
+        return m_ioThread;
+    }
+
+    m_ioThread = new QThread(this);
+    m_ioThread->setObjectName("DownloaderIoThread");
+    m_reactor = new ProcessReactor();
+    m_reactor->moveToThread(m_ioThread);
+
+    // reactor 批量投递日志和合并后的进度，完成事件单独投递
+    connect(m_reactor, &ProcessReactor::logBatch, this, &DownloaderPool::onLogBatch, Qt::QueuedConnection);
+    connect(m_reactor, &ProcessReactor::progressUpdated, this, &DownloaderPool::progressUpdated, Qt::QueuedConnection);
+    connect(m_reactor, &ProcessReactor::taskFinished, this, &DownloaderPool::taskFinished, Qt::QueuedConnection);
+    connect(m_ioThread, &QThread::finished, m_reactor, &ProcessReactor::deleteLater);
+
+    m_ioThread->start();
+    return m_ioThread;
+}
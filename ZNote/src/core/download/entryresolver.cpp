@@ -0,0 +1,146 @@
+#include "core/download/entryresolver.h"
+#include "core/download/urlparser.h"
+#include "core/download/processpolicy.h"
+#include "core/download/toolregistry.h"
+#include "core/download/infojsonextractor.h"
+#include <QJsonObject>
+
+namespace {
+constexpr int kDefaultJobs = 4;
+
+// 从等待列表中取出下一个未启动的条目
+bool takeNext(QList<ParsedEntry> *queue, const QSet<QString> &started, ParsedEntry *entry)
+{
+    while (!queue->isEmpty()) {
+        *entry = queue->takeFirst();
+        if (!started.contains(entry->id)) {
+            return true;
+        }
+    }
+    return false;
+}
+}
+
+EntryResolver::EntryResolver(QObject *parent)
+    : QObject(parent)
+    , m_maxJobs(kDefaultJobs)
+{
+}
+
+EntryResolver::~EntryResolver()
+{
+    cancel();
+}
+
+void EntryResolver::setMaxJobs(int jobs)
+{
+    m_maxJobs = qMax(1, jobs);
+    startNext();
+}
+
+void EntryResolver::setWanted(const QList<ParsedEntry> &selected, const QList<ParsedEntry> &visible)
+{
+    // 只保留尚未启动的条目；滚出视野的条目不再解析
+    m_selected.clear();
+    m_visible.clear();
+    for (const ParsedEntry &entry : selected) {
+        if (!entry.resolved && !m_started.contains(entry.id)) {
+            m_selected.append(entry);
+        }
+    }
+    for (const ParsedEntry &entry : visible) {
+        if (!entry.resolved && !m_started.contains(entry.id)) {
+            m_visible.append(entry);
+        }
+    }
+    startNext();
+}
+
+void EntryResolver::cancel()
+{
+    m_selected.clear();
+    m_visible.clear();
+    m_started.clear();
+
+    const QList<QProcess *> processes = m_running.keys();
+    m_running.clear();
+    for (QProcess *process : processes) {
+        disconnect(process, nullptr, this, nullptr);
+        process->kill();
+        process->deleteLater();
+    }
+}
+
+bool EntryResolver::isIdle() const
+{
+    return m_selected.isEmpty() && m_visible.isEmpty() && m_running.isEmpty();
+}
+
+void EntryResolver::startNext()
+{
+    ParsedEntry entry;
+    while (m_running.size() < m_maxJobs
+           && (takeNext(&m_selected, m_started, &entry) || takeNext(&m_visible, m_started, &entry))) {
+        m_started.insert(entry.id);
+
+        QProcess *process = new QProcess(this);
+        connect(process, &QProcess::finished, this, [this, process](int exitCode, QProcess::ExitStatus exitStatus) {
+            onFinished(process, exitCode, exitStatus);
+        });
+        connect(process, &QProcess::errorOccurred, this, [this, process](QProcess::ProcessError error) {
+            // 启动失败时不会发出 finished
+            if (error == QProcess::FailedToStart) {
+                onFinished(process, -1, QProcess::CrashExit);
+            }
+        });
+        m_running.insert(process, entry);
+
+        // 只解析这一个视频，不展开其所属的播放列表
+        ProcessPolicy::apply(process, ProcessPolicy::Stage::Parse);
+        process->start(ToolRegistry::path(ToolRegistry::Tool::YtDlp),
+                       {"-J", "--no-playlist", "--no-warnings", entry.url});
+    }
+}
+
+void EntryResolver::onFinished(QProcess *process, int exitCode, QProcess::ExitStatus exitStatus)
+{
+    auto it = m_running.find(process);
+    if (it == m_running.end()) {
+        return;
+    }
+    const ParsedEntry flat = it.value();
+    m_running.erase(it);
+    disconnect(process, nullptr, this, nullptr);
+    process->deleteLater();
+
+    ParsedEntry entry;
+    if (exitStatus == QProcess::NormalExit && exitCode == 0) {
+        QJsonObject info;
+        if (InfoJsonExtractor::extract(process->readAllStandardOutput(), &info)) {
+            entry = UrlParser::parseSingleEntry(info);
+        }
+    }
+
+    if (entry.vid.isEmpty()) {
+        // 失败不重试：下载时 yt-dlp 会重新解析该条目
+        const QString stderrText = QString::fromUtf8(process->readAllStandardError()).trimmed();
+        emit logMessage(QString("Failed to resolve %1: %2")
+                            .arg(flat.url, stderrText.isEmpty() ? process->errorString() : stderrText));
+    } else {
+        // 单独解析时没有播放列表信息，沿用扁平列表中的位置
+        entry.id = flat.id;
+        entry.vid = flat.vid;
+        entry.type = flat.type;
+        entry.index = flat.index;
+        entry.playlistCount = flat.playlistCount;
+        entry.playlistTitle = flat.playlistTitle;
+        if (entry.url.isEmpty()) {
+            entry.url = flat.url;
+        }
+        // 成功的条目可以再次解析（例如不使用缓存时重新解析同一播放列表）
+        m_started.remove(flat.id);
+        emit entryResolved(entry);
+    }
+
+    startNext();
+}
@@ -0,0 +1,224 @@
+#include "core/download/filemover.h"
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QLocale>
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef Q_OS_UNIX
+#include <cstdio>
+#endif
+
+namespace {
+constexpr int kDefaultJobs = 2;
+constexpr qint64 kCopyChunk = 8 * 1024 * 1024;  // 每次复制的字节数
+constexpr int kProgressIntervalMs = 250;         // 进度信号的最小间隔
+
+// 改名并替换已存在的目标文件
+bool replaceFile(const QString &from, const QString &to)
+{
+#ifdef Q_OS_UNIX
+    // rename(2) 原子地替换目标，任何时刻目标路径上都是完整的旧文件或新文件；
+    // QDir::rename 在 Linux 上拒绝覆盖，不能用
+    return ::rename(QFile::encodeName(from).constData(), QFile::encodeName(to).constData()) == 0;
+#else
+    // 无法原子替换：只在新文件已完整就绪、马上改名之前删除旧文件
+    QFile::remove(to);
+    return QDir().rename(from, to);
+#endif
+}
+
+// 复制文件内容；目标文件由调用方在完成后改名
+bool copyContents(const QString &from, const QString &to,
+                  const std::function<void(qint64, qint64)> &progress,
+                  const std::atomic<bool> &stop, QString *error)
+{
+    // 不使用 QIODevice 的缓冲，下面直接在文件描述符上复制时位置才一致
+    QFile source(from);
+    if (!source.open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+        *error = QString("Cannot open %1: %2").arg(from, source.errorString());
+        return false;
+    }
+    QFile target(to);
+    if (!target.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered)) {
+        *error = QString("Cannot create %1: %2").arg(to, target.errorString());
+        return false;
+    }
+
+    const qint64 size = source.size();
+    qint64 copied = 0;
+
+#ifdef Q_OS_LINUX
+    // 预先分配目标文件的空间，减少目标磁盘上的碎片；不支持的文件系统上直接跳过
+    if (size > 0) {
+        ::fallocate(target.handle(), 0, 0, size);
+    }
+    // 在内核中复制，不经过用户态缓冲；文件系统不支持时退回普通读写
+    while (copied < size && !stop) {
+        const ssize_t n = ::copy_file_range(source.handle(), nullptr, target.handle(), nullptr,
+                                            static_cast<size_t>(qMin(kCopyChunk, size - copied)), 0);
+        if (n <= 0) {
+            break;
+        }
+        copied += n;
+        progress(copied, size);
+    }
+    if (copied > 0 && copied < size) {
+        source.seek(copied);
+        target.seek(copied);
+    }
+#endif
+
+    QByteArray buffer;
+    while (copied < size && !stop) {
+        if (buffer.isEmpty()) {
+            buffer.resize(kCopyChunk);
+        }
+        const qint64 n = source.read(buffer.data(), qMin(kCopyChunk, size - copied));
+        if (n <= 0) {
+            *error = QString("Cannot read %1: %2").arg(from, source.errorString());
+            return false;
+        }
+        if (target.write(buffer.constData(), n) != n) {
+            *error = QString("Cannot write %1: %2").arg(to, target.errorString());
+            return false;
+        }
+        copied += n;
+        progress(copied, size);
+    }
+
+    if (stop) {
+        *error = "Aborted";
+        return false;
+    }
+    target.close();
+    if (target.error() != QFileDevice::NoError) {
+        *error = QString("Cannot write %1: %2").arg(to, target.errorString());
+        return false;
+    }
+    return true;
+}
+}
+
+FileMover::FileMover(QObject *parent)
+    : QObject(parent)
+    , m_stopping(false)
+    , m_active(0)
+{
+    m_pool.setMaxThreadCount(kDefaultJobs);
+}
+
+FileMover::~FileMover()
+{
+    // 中止正在进行的复制，未移动的文件留在暂存目录中
+    m_stopping = true;
+    m_pool.waitForDone();
+}
+
+void FileMover::setMaxJobs(int jobs)
+{
+    m_pool.setMaxThreadCount(qMax(1, jobs));
+}
+
+void FileMover::enqueue(const DownloadTask &task)
+{
+    ++m_active;
+    m_pool.start([this, task]() {
+        run(task);
+    });
+}
+
+bool FileMover::isIdle() const
+{
+    return m_active == 0;
+}
+
+bool FileMover::moveFile(const QString &from, const QString &to,
+                         const std::function<void(qint64, qint64)> &progress,
+                         const std::atomic<bool> &stop, QString *error)
+{
+    QDir().mkpath(QFileInfo(to).absolutePath());
+    const qint64 size = QFileInfo(from).size();
+
+    // 同一文件系统上直接重命名，跨文件系统时改名失败，下面再复制；
+    // 新文件就绪前不删除已存在的目标，移动失败时旧文件仍然保留
+#ifdef Q_OS_UNIX
+    const bool renamed = replaceFile(from, to);
+#else
+    const bool renamed = !QFile::exists(to) && QDir().rename(from, to);
+#endif
+    if (renamed) {
+        progress(size, size);
+        return true;
+    }
+
+    // 跨文件系统：先复制到目标旁的临时文件，完整后再改名，最终路径上不会出现不完整的文件
+    const QString temp = to + ".moving";
+    if (!copyContents(from, temp, progress, stop, error)) {
+        QFile::remove(temp);
+        return false;
+    }
+    if (!replaceFile(temp, to)) {
+        *error = QString("Cannot rename %1 to %2").arg(temp, to);
+        QFile::remove(temp);
+        return false;
+    }
+    QFile::remove(from);
+    return true;
+}
+
+void FileMover::run(DownloadTask task)
+{
+    // 在工作线程中执行；信号可以跨线程发出
+    qint64 total = 0;
+    for (const DownloadedFile &file : std::as_const(task.files)) {
+        total += QFileInfo(file.path).size();
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    qint64 moved = 0;
+    QString error;
+    bool ok = true;
+    const QDir destination(task.savePath);
+    for (DownloadedFile &file : task.files) {
+        const QString target = destination.absoluteFilePath(QFileInfo(file.path).fileName());
+        const qint64 before = moved;
+        ok = moveFile(file.path, target, [&](qint64 done, qint64) {
+            moved = before + done;
+            if (timer.elapsed() >= kProgressIntervalMs) {
+                timer.restart();
+                emit progress(task.id, moved, total);
+            }
+        }, m_stopping, &error);
+        if (!ok) {
+            break;
+        }
+        // 记录文件的新位置，失败时未移动的文件仍指向暂存目录
+        file.path = target;
+    }
+    if (m_stopping) {
+        return;
+    }
+
+    if (ok) {
+        emit progress(task.id, total, total);
+        emit logMessage(QString("📁 已移动到 %1: %2 (%3)")
+                            .arg(destination.absolutePath(), task.video.title,
+                                 QLocale::system().formattedDataSize(total)));
+    } else {
+        emit logMessage(QString("❌ 移动失败，文件保留在暂存目录: %1").arg(error));
+        task.status = DownloadStatus::Failed;
+    }
+
+    // 在 FileMover 所在线程中更新计数并通知
+    QMetaObject::invokeMethod(this, [this, task]() {
+        --m_active;
+        emit finished(task);
+    }, Qt::QueuedConnection);
+}
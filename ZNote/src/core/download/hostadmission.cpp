@@ -0,0 +1,108 @@
+#include "core/download/hostadmission.h"
+#include <QUrl>
+#include <QtMath>
+
+HostAdmission::HostAdmission()
+    : m_maxPerHost(0), m_rate(0.0), m_burst(1)
+{
+}
+
+void HostAdmission::setMaxPerHost(int max)
+{
+    m_maxPerHost = qMax(0, max);
+}
+
+void HostAdmission::setRequestRate(double perSecond, int burst)
+{
+    m_rate = qMax(0.0, perSecond);
+    m_burst = qMax(1, burst);
+}
+
+bool HostAdmission::isEnabled() const
+{
+    return m_maxPerHost > 0 || m_rate > 0.0;
+}
+
+bool HostAdmission::tryAcquire(const QString &host, qint64 nowMs, qint64 *retryInMs)
+{
+    if (retryInMs) {
+        *retryInMs = -1;
+    }
+
+    // 并发上限：等待同主机任务结束后再试
+    if (m_maxPerHost > 0 && m_running.value(host) >= m_maxPerHost) {
+        return false;
+    }
+
+    // 令牌桶：没有令牌时计算下一个令牌到达的时间
+    if (m_rate > 0.0) {
+        auto it = m_buckets.find(host);
+        if (it == m_buckets.end()) {
+            Bucket bucket;
+            bucket.tokens = m_burst;
+            bucket.lastRefillMs = nowMs;
+            it = m_buckets.insert(host, bucket);
+        }
+
+        Bucket &bucket = it.value();
+        refill(bucket, nowMs);
+        if (bucket.tokens < 1.0) {
+            if (retryInMs) {
+                *retryInMs = qCeil((1.0 - bucket.tokens) * 1000.0 / m_rate);
+            }
+            return false;
+        }
+        bucket.tokens -= 1.0;
+    }
+
+    m_running[host]++;
+    return true;
+}
+
+void HostAdmission::release(const QString &host)
+{
+    auto it = m_running.find(host);
+    if (it == m_running.end()) {
+        return;
+    }
+    if (--it.value() <= 0) {
+        m_running.erase(it);
+    }
+}
+
+void HostAdmission::refund(const QString &host)
+{
+    release(host);
+
+    // 未实际发起请求，令牌还回桶中（不超过容量）
+    auto it = m_buckets.find(host);
+    if (it != m_buckets.end()) {
+        it.value().tokens = qMin<double>(m_burst, it.value().tokens + 1.0);
+    }
+}
+
+int HostAdmission::running(const QString &host) const
+{
+    return m_running.value(host);
+}
+
+QString HostAdmission::hostOf(const QString &url)
+{
+    QString host = QUrl(url).host().toLower();
+    if (host.startsWith("www.")) {
+        host.remove(0, 4);
+    } else if (host.startsWith("m.")) {
+        host.remove(0, 2);
+    }
+    return host;
+}
+
+void HostAdmission::refill(Bucket &bucket, qint64 nowMs) const
+{
+    qint64 elapsed = nowMs - bucket.lastRefillMs;
+    if (elapsed <= 0) {
+        return;
+    }
+    bucket.tokens = qMin<double>(m_burst, bucket.tokens + elapsed * m_rate / 1000.0);
+    bucket.lastRefillMs = nowMs;
+}
@@ -0,0 +1,496 @@
+#include "core/download/infojsonextractor.h"
+#include <QByteArray>
+#include <QJsonArray>
+#include <QVarLengthArray>
+#include <cstddef>
+#include <cstring>
+
+namespace {
+constexpr int kMaxDepth = 64;
+
+// parseSingleEntry() 读取的字段
+const QByteArrayView kInfoKeys[] = {
+    "id", "title", "webpage_url", "url", "_type", "duration", "thumbnail", "ext",
+    "filesize", "filesize_approx", "playlist", "playlist_index", "playlist_count", "playlist_title",
+};
+const QByteArrayView kFormatKeys[] = {
+    "format_id", "ext", "vcodec", "acodec", "height", "filesize", "filesize_approx",
+};
+const QByteArrayView kFormatsKey = "formats";
+
+template <std::size_t N>
+bool isWanted(const QByteArrayView (&keys)[N], QByteArrayView key)
+{
+    for (const QByteArrayView &wanted : keys) {
+        if (wanted == key) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+bool isDelimiter(char c)
+{
+    return isSpace(c) || c == ',' || c == ':' || c == '}' || c == ']' || c == '{' || c == '[' || c == '"';
+}
+
+int hexValue(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+// 在原始字节上顺序扫描；只解码需要的值，其余的值只找到结尾
+class Scanner
+{
+public:
+    explicit Scanner(QByteArrayView data)
+        : m_begin(data.data())
+        , m_p(data.data())
+        , m_end(data.data() + data.size())
+        , m_error(nullptr)
+    {
+    }
+
+    bool extractInfo(QJsonObject *info)
+    {
+        skipSpace();
+        const bool ok = forEachMember([this, info](QByteArrayView key) {
+            if (key == kFormatsKey) {
+                QJsonValue formats;
+                if (!parseFormats(&formats)) {
+                    return false;
+                }
+                info->insert(QStringLiteral("formats"), formats);
+                return true;
+            }
+            if (!isWanted(kInfoKeys, key)) {
+                return skipValue();
+            }
+            QJsonValue value;
+            if (!parseValue(&value, 0)) {
+                return false;
+            }
+            info->insert(QString::fromLatin1(key), value);
+            return true;
+        });
+        if (!ok) {
+            return false;
+        }
+        skipSpace();
+        return m_p == m_end || fail("garbage at the end of the document");
+    }
+
+    QString errorString() const
+    {
+        return QString("%1 at offset %2")
+            .arg(QString::fromLatin1(m_error ? m_error : "unknown error"))
+            .arg(m_p - m_begin);
+    }
+
+private:
+    bool fail(const char *message)
+    {
+        m_error = message;
+        return false;
+    }
+
+    void skipSpace()
+    {
+        while (m_p < m_end && isSpace(*m_p)) {
+            ++m_p;
+        }
+    }
+
+    bool expect(char c)
+    {
+        if (m_p < m_end && *m_p == c) {
+            ++m_p;
+            return true;
+        }
+        return fail("unexpected character");
+    }
+
+    // 依次处理对象的每个成员；member 负责读取或跳过值
+    template <typename Member>
+    bool forEachMember(Member &&member)
+    {
+        if (!expect('{')) {
+            return false;
+        }
+        skipSpace();
+        if (m_p < m_end && *m_p == '}') {
+            ++m_p;
+            return true;
+        }
+        for (;;) {
+            QByteArray keyStorage;
+            QByteArrayView key;
+            if (!readKey(&key, &keyStorage)) {
+                return false;
+            }
+            skipSpace();
+            if (!expect(':')) {
+                return false;
+            }
+            skipSpace();
+            if (!member(key)) {
+                return false;
+            }
+            skipSpace();
+            if (m_p < m_end && *m_p == ',') {
+                ++m_p;
+                skipSpace();
+                continue;
+            }
+            if (m_p < m_end && *m_p == '}') {
+                ++m_p;
+                return true;
+            }
+            return fail("expected ',' or '}'");
+        }
+    }
+
+    // 键通常不含转义，直接引用原始字节；含转义时解码到 storage
+    bool readKey(QByteArrayView *key, QByteArray *storage)
+    {
+        if (m_p >= m_end || *m_p != '"') {
+            return fail("expected a key");
+        }
+        const char *start = m_p + 1;
+        if (!skipString()) {
+            return false;
+        }
+        const QByteArrayView raw(start, m_p - 1 - start);
+        if (!raw.contains('\\')) {
+            *key = raw;
+            return true;
+        }
+        const char *end = m_p;
+        m_p = start - 1;
+        QString decoded;
+        if (!parseString(&decoded)) {
+            return false;
+        }
+        m_p = end;
+        *storage = decoded.toUtf8();
+        *key = QByteArrayView(*storage);
+        return true;
+    }
+
+    // m_p 指向开头的引号；结束后指向结尾引号之后
+    bool skipString()
+    {
+        const char *p = m_p + 1;
+        for (;;) {
+            const void *quote = std::memchr(p, '"', m_end - p);
+            if (quote == nullptr) {
+                m_p = m_end;
+                return fail("unterminated string");
+            }
+            const char *q = static_cast<const char *>(quote);
+            // 前面有奇数个反斜杠时引号是转义的
+            const char *b = q;
+            while (b > m_p + 1 && *(b - 1) == '\\') {
+                --b;
+            }
+            if ((q - b) % 2 == 0) {
+                m_p = q + 1;
+                return true;
+            }
+            p = q + 1;
+        }
+    }
+
+    bool skipValue()
+    {
+        // 只检查括号配对和字符串结尾，不构造任何值
+        QVarLengthArray<char, kMaxDepth> closers;
+        do {
+            skipSpace();
+            if (m_p >= m_end) {
+                return fail("unexpected end of data");
+            }
+            const char c = *m_p;
+            if (c == '"') {
+                if (!skipString()) {
+                    return false;
+                }
+            } else if (c == '{' || c == '[') {
+                closers.append(c == '{' ? '}' : ']');
+                ++m_p;
+            } else if (c == '}' || c == ']') {
+                if (closers.isEmpty() || closers.last() != c) {
+                    return fail("mismatched bracket");
+                }
+                closers.removeLast();
+                ++m_p;
+            } else if (c == ',' || c == ':') {
+                if (closers.isEmpty()) {
+                    return fail("unexpected separator");
+                }
+                ++m_p;
+            } else {
+                const char *start = m_p;
+                while (m_p < m_end && !isDelimiter(*m_p)) {
+                    ++m_p;
+                }
+                if (m_p == start) {
+                    return fail("unexpected character");
+                }
+            }
+        } while (!closers.isEmpty());
+        return true;
+    }
+
+    bool parseValue(QJsonValue *value, int depth)
+    {
+        if (depth > kMaxDepth) {
+            return fail("nesting too deep");
+        }
+        if (m_p >= m_end) {
+            return fail("unexpected end of data");
+        }
+        switch (*m_p) {
+        case '"': {
+            QString text;
+            if (!parseString(&text)) {
+                return false;
+            }
+            *value = text;
+            return true;
+        }
+        case '{': {
+            QJsonObject object;
+            const bool ok = forEachMember([this, &object, depth](QByteArrayView key) {
+                QJsonValue member;
+                if (!parseValue(&member, depth + 1)) {
+                    return false;
+                }
+                object.insert(QString::fromUtf8(key), member);
+                return true;
+            });
+            *value = object;
+            return ok;
+        }
+        case '[': {
+            QJsonArray array;
+            const bool ok = forEachElement([this, &array, depth]() {
+                QJsonValue element;
+                if (!parseValue(&element, depth + 1)) {
+                    return false;
+                }
+                array.append(element);
+                return true;
+            });
+            *value = array;
+            return ok;
+        }
+        default:
+            return parseScalar(value);
+        }
+    }
+
+    template <typename Element>
+    bool forEachElement(Element &&element)
+    {
+        if (!expect('[')) {
+            return false;
+        }
+        skipSpace();
+        if (m_p < m_end && *m_p == ']') {
+            ++m_p;
+            return true;
+        }
+        for (;;) {
+            if (!element()) {
+                return false;
+            }
+            skipSpace();
+            if (m_p < m_end && *m_p == ',') {
+                ++m_p;
+                skipSpace();
+                continue;
+            }
+            if (m_p < m_end && *m_p == ']') {
+                ++m_p;
+                return true;
+            }
+            return fail("expected ',' or ']'");
+        }
+    }
+
+    // formats 数组中每个格式只保留选择格式用到的字段
+    bool parseFormats(QJsonValue *value)
+    {
+        if (m_p >= m_end || *m_p != '[') {
+            return parseValue(value, 0);
+        }
+        QJsonArray formats;
+        const bool ok = forEachElement([this, &formats]() {
+            if (m_p >= m_end || *m_p != '{') {
+                QJsonValue other;
+                if (!parseValue(&other, 1)) {
+                    return false;
+                }
+                formats.append(other);
+                return true;
+            }
+            QJsonObject format;
+            const bool formatOk = forEachMember([this, &format](QByteArrayView key) {
+                if (!isWanted(kFormatKeys, key)) {
+                    return skipValue();
+                }
+                QJsonValue field;
+                if (!parseValue(&field, 2)) {
+                    return false;
+                }
+                format.insert(QString::fromLatin1(key), field);
+                return true;
+            });
+            formats.append(format);
+            return formatOk;
+        });
+        *value = formats;
+        return ok;
+    }
+
+    bool parseString(QString *text)
+    {
+        const char *start = m_p + 1;
+        if (!skipString()) {
+            return false;
+        }
+        const char *end = m_p - 1;
+
+        // 没有转义时整段直接转换
+        const void *escape = std::memchr(start, '\\', end - start);
+        if (escape == nullptr) {
+            *text = QString::fromUtf8(start, end - start);
+            return true;
+        }
+
+        QString result;
+        result.reserve(end - start);
+        const char *segment = start;
+        const char *p = static_cast<const char *>(escape);
+        while (p < end) {
+            if (*p != '\\') {
+                ++p;
+                continue;
+            }
+            result.append(QString::fromUtf8(segment, p - segment));
+            if (p + 1 >= end) {
+                return fail("bad escape sequence");
+            }
+            const char c = p[1];
+            p += 2;
+            switch (c) {
+            case '"': result.append(QLatin1Char('"')); break;
+            case '\\': result.append(QLatin1Char('\\')); break;
+            case '/': result.append(QLatin1Char('/')); break;
+            case 'b': result.append(QLatin1Char('\b')); break;
+            case 'f': result.append(QLatin1Char('\f')); break;
+            case 'n': result.append(QLatin1Char('\n')); break;
+            case 'r': result.append(QLatin1Char('\r')); break;
+            case 't': result.append(QLatin1Char('\t')); break;
+            case 'u': {
+                // 逐个追加 UTF-16 码元，代理对自然拼接
+                if (end - p < 4) {
+                    return fail("bad unicode escape");
+                }
+                int unit = 0;
+                for (int i = 0; i < 4; ++i) {
+                    const int digit = hexValue(p[i]);
+                    if (digit < 0) {
+                        return fail("bad unicode escape");
+                    }
+                    unit = unit * 16 + digit;
+                }
+                result.append(QChar(static_cast<char16_t>(unit)));
+                p += 4;
+                break;
+            }
+            default:
+                return fail("bad escape sequence");
+            }
+            segment = p;
+        }
+        result.append(QString::fromUtf8(segment, end - segment));
+        *text = result;
+        return true;
+    }
+
+    bool parseScalar(QJsonValue *value)
+    {
+        const char *start = m_p;
+        while (m_p < m_end && !isDelimiter(*m_p)) {
+            ++m_p;
+        }
+        const QByteArrayView token(start, m_p - start);
+        if (token == "null") {
+            *value = QJsonValue(QJsonValue::Null);
+            return true;
+        }
+        if (token == "true" || token == "false") {
+            *value = token == "true";
+            return true;
+        }
+        // Python 的 json 模块把非有限浮点数写成 NaN/Infinity；JSON 中没有对应的值，按 null 处理
+        if (token == "NaN" || token == "Infinity" || token == "-Infinity") {
+            *value = QJsonValue(QJsonValue::Null);
+            return true;
+        }
+
+        // 与 QJsonDocument 一致：整数保留为整数，其余按 double
+        bool ok = false;
+        const QByteArray number = QByteArray::fromRawData(token.data(), token.size());
+        if (!token.contains('.') && !token.contains('e') && !token.contains('E')) {
+            const qint64 integer = number.toLongLong(&ok);
+            if (ok) {
+                *value = integer;
+                return true;
+            }
+        }
+        const double real = number.toDouble(&ok);
+        if (!ok) {
+            m_p = start;
+            return fail("invalid value");
+        }
+        *value = real;
+        return true;
+    }
+
+    const char *m_begin;
+    const char *m_p;
+    const char *m_end;
+    const char *m_error;
+};
+}
+
+bool InfoJsonExtractor::extract(QByteArrayView json, QJsonObject *info, QString *error)
+{
+    Scanner scanner(json);
+    QJsonObject result;
+    if (!scanner.extractInfo(&result)) {
+        if (error) {
+            *error = scanner.errorString();
+        }
+        return false;
+    }
+    *info = result;
+    return true;
+}
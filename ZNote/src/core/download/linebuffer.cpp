@@ -0,0 +1,78 @@
+#include "core/download/linebuffer.h"
+#include <QIODevice>
+#include <cstring>
+
+LineBuffer::LineBuffer(int capacity, int maxCapacity)
+    : m_data(qMax(capacity, 256), Qt::Uninitialized)
+    , m_max(qMax<qsizetype>(maxCapacity, m_data.size()))
+    , m_begin(0)
+    , m_scan(0)
+    , m_end(0)
+{
+}
+
+qint64 LineBuffer::readFrom(QIODevice *device)
+{
+    // 已消费的字节不再需要，把剩余部分移到开头腾出空间
+    if (m_begin > 0) {
+        const qsizetype remaining = m_end - m_begin;
+        if (remaining > 0) {
+            std::memmove(m_data.data(), m_data.constData() + m_begin, remaining);
+        }
+        m_scan -= m_begin;
+        m_end = remaining;
+        m_begin = 0;
+    }
+
+    const qsizetype space = m_data.size() - m_end;
+    if (space <= 0) {
+        return 0;
+    }
+    const qint64 n = device->read(m_data.data() + m_end, space);
+    if (n > 0) {
+        m_end += n;
+    }
+    return qMax<qint64>(n, 0);
+}
+
+bool LineBuffer::nextLine(QByteArrayView *line)
+{
+    const char *base = m_data.constData();
+    const void *newline = std::memchr(base + m_scan, '\n', m_end - m_scan);
+    if (newline == nullptr) {
+        m_scan = m_end;
+        if (m_begin == 0 && m_end == m_data.size()) {
+            // 缓冲区已满仍没有换行：先扩容；已达上限的超长行按整块返回，避免卡死
+            if (m_data.size() < m_max) {
+                m_data.resize(qMin(m_data.size() * 2, m_max));
+                return false;
+            }
+            return takeRemainder(line);
+        }
+        return false;
+    }
+
+    const qsizetype pos = static_cast<const char *>(newline) - base;
+    *line = QByteArrayView(base + m_begin, pos - m_begin);
+    m_begin = pos + 1;
+    m_scan = m_begin;
+    return true;
+}
+
+bool LineBuffer::takeRemainder(QByteArrayView *line)
+{
+    if (m_begin == m_end) {
+        return false;
+    }
+    *line = QByteArrayView(m_data.constData() + m_begin, m_end - m_begin);
+    m_begin = m_end;
+    m_scan = m_end;
+    return true;
+}
+
+void LineBuffer::clear()
+{
+    m_begin = 0;
+    m_scan = 0;
+    m_end = 0;
+}
@@ -0,0 +1,398 @@
+#include "core/download/parsecache.h"
+#include "utils/logger.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QUrl>
+#include <QUrlQuery>
+#include <algorithm>
+
+namespace {
+constexpr int kFormatVersion = 1;
+constexpr qint64 kDefaultTtlMs = 24LL * 3600 * 1000;
+constexpr int kDefaultMaxEntries = 5000;
+
+// 超出上限时一次淘汰到上限的 90%，避免每次写入都排序
+constexpr double kEvictTarget = 0.9;
+
+qint64 now()
+{
+    return QDateTime::currentMSecsSinceEpoch();
+}
+
+bool isTrackingParameter(const QString &key)
+{
+    return key.startsWith("utm_") || key == "si" || key == "feature";
+}
+}
+
+ParseCache::ParseCache(const QString &path)
+    : m_path(path.isEmpty() ? defaultPath() : path)
+    , m_ttl(kDefaultTtlMs)
+    , m_maxEntries(kDefaultMaxEntries)
+    , m_loaded(false)
+    , m_dirty(false)
+{
+}
+
+ParseCache::~ParseCache()
+{
+    // 保存最近使用时间，LRU 顺序在重启后保持
+    save();
+}
+
+void ParseCache::setTtl(qint64 seconds)
+{
+    QMutexLocker locker(&m_mutex);
+    m_ttl = qMax<qint64>(0, seconds) * 1000;
+}
+
+void ParseCache::setMaxEntries(int videos)
+{
+    QMutexLocker locker(&m_mutex);
+    m_maxEntries = qMax(1, videos);
+}
+
+ParseCache::Lookup ParseCache::lookup(const QString &url, QList<ParsedEntry> *entries)
+{
+    QMutexLocker locker(&m_mutex);
+    loadLocked();
+
+    auto it = m_urls.find(normalizeUrl(url));
+    if (it == m_urls.end()) {
+        return Lookup::Miss;
+    }
+
+    const qint64 time = now();
+    QList<ParsedEntry> found;
+    found.reserve(it->entries.size());
+    for (const Position &position : std::as_const(it->entries)) {
+        auto video = m_videos.find(position.id);
+        if (video == m_videos.end()) {
+            // 部分视频已被淘汰，整条记录作废
+            m_urls.erase(it);
+            m_dirty = true;
+            return Lookup::Miss;
+        }
+        video->used = time;
+
+        ParsedEntry entry = video->entry;
+        entry.type = it->type;
+        entry.index = position.index;
+        entry.playlistCount = it->playlistCount;
+        entry.playlistTitle = it->playlistTitle;
+        found.append(entry);
+    }
+    it->used = time;
+    m_dirty = true;
+
+    *entries = found;
+    return m_ttl > 0 && time - it->fetched > m_ttl ? Lookup::Stale : Lookup::Fresh;
+}
+
+void ParseCache::store(const QString &url, const QList<ParsedEntry> &entries)
+{
+    if (entries.isEmpty()) {
+        return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    loadLocked();
+
+    const qint64 time = now();
+    UrlRecord record;
+    record.type = entries.first().type;
+    record.playlistTitle = entries.first().playlistTitle;
+    record.playlistCount = entries.first().playlistCount;
+    record.fetched = time;
+    record.used = time;
+    for (const ParsedEntry &entry : entries) {
+        record.entries.append(Position{entry.id, entry.index});
+
+        // 扁平列表不覆盖已解析的完整信息
+        auto existing = m_videos.find(entry.id);
+        if (!entry.resolved && existing != m_videos.end() && existing->entry.resolved) {
+            existing->used = time;
+            continue;
+        }
+
+        // 播放列表相关的字段保存在 URL 记录中
+        VideoRecord video;
+        video.entry = entry;
+        video.entry.type = UrlType::Single;
+        video.entry.index = 1;
+        video.entry.playlistCount = 1;
+        video.entry.playlistTitle.clear();
+        video.used = time;
+        m_videos.insert(entry.id, video);
+    }
+    m_urls.insert(normalizeUrl(url), record);
+    m_dirty = true;
+
+    evictLocked();
+    saveLocked();
+}
+
+void ParseCache::update(const ParsedEntry &entry)
+{
+    QMutexLocker locker(&m_mutex);
+    loadLocked();
+
+    auto video = m_videos.find(entry.id);
+    if (video == m_videos.end()) {
+        return;
+    }
+    const ParsedEntry previous = video->entry;
+    video->entry = entry;
+    video->entry.type = previous.type;
+    video->entry.index = previous.index;
+    video->entry.playlistCount = previous.playlistCount;
+    video->entry.playlistTitle = previous.playlistTitle;
+    video->used = now();
+    m_dirty = true;
+}
+
+bool ParseCache::save()
+{
+    QMutexLocker locker(&m_mutex);
+    return saveLocked();
+}
+
+QString ParseCache::normalizeUrl(const QString &url)
+{
+    QUrl parsed(url.trimmed());
+    if (!parsed.isValid() || parsed.host().isEmpty()) {
+        return url.trimmed();
+    }
+
+    parsed.setScheme(parsed.scheme().toLower());
+    QString host = parsed.host().toLower();
+    if (host.startsWith("www.")) {
+        host.remove(0, 4);
+    } else if (host.startsWith("m.")) {
+        host.remove(0, 2);
+    }
+    parsed.setHost(host);
+    parsed.setFragment(QString());
+    if ((parsed.scheme() == "https" && parsed.port() == 443) || (parsed.scheme() == "http" && parsed.port() == 80)) {
+        parsed.setPort(-1);
+    }
+
+    QString path = parsed.path();
+    while (path.size() > 1 && path.endsWith('/')) {
+        path.chop(1);
+    }
+    parsed.setPath(path);
+
+    // 参数排序后比较，去掉不影响内容的跟踪参数
+    QList<QPair<QString, QString>> items = QUrlQuery(parsed).queryItems(QUrl::FullyEncoded);
+    items.erase(std::remove_if(items.begin(), items.end(), [](const QPair<QString, QString> &item) {
+        return isTrackingParameter(item.first);
+    }), items.end());
+    std::sort(items.begin(), items.end());
+    QUrlQuery query;
+    query.setQueryItems(items);
+    parsed.setQuery(query.isEmpty() ? QString() : query.query(QUrl::FullyEncoded), QUrl::StrictMode);
+
+    return parsed.toString(QUrl::FullyEncoded);
+}
+
+QString ParseCache::defaultPath()
+{
+    // 与下载历史文件放在同一目录：优先应用程序目录，不可写时使用 AppDataLocation
+    QString appDir = QCoreApplication::applicationDirPath();
+    if (QDir(appDir).exists() && QFileInfo(appDir).isWritable()) {
+        return QDir(appDir).filePath("parse_cache.json");
+    }
+
+    QString appDataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(appDataPath);
+    return QDir(appDataPath).filePath("parse_cache.json");
+}
+
+void ParseCache::loadLocked()
+{
+    // 调用方需持有 m_mutex
+    if (m_loaded) {
+        return;
+    }
+    m_loaded = true;
+
+    QFile file(m_path);
+    if (!file.exists()) {
+        return;
+    }
+    if (!file.open(QIODevice::ReadOnly)) {
+        LOG_WARNING(QString("Failed to open parse cache: %1").arg(m_path));
+        return;
+    }
+
+    QJsonParseError error;
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
+    const QJsonObject root = doc.object();
+    if (error.error != QJsonParseError::NoError || root["version"].toInt() != kFormatVersion) {
+        LOG_WARNING(QString("Ignoring damaged or outdated parse cache: %1").arg(m_path));
+        return;
+    }
+
+    const QJsonObject videos = root["videos"].toObject();
+    for (auto it = videos.begin(); it != videos.end(); ++it) {
+        VideoRecord video = videoFromJson(it.value().toObject());
+        video.entry.id = it.key();
+        video.entry.vid = it.key();
+        m_videos.insert(it.key(), video);
+    }
+
+    const QJsonObject urls = root["urls"].toObject();
+    for (auto it = urls.begin(); it != urls.end(); ++it) {
+        const QJsonObject json = it.value().toObject();
+        UrlRecord record;
+        record.type = static_cast<UrlType>(json["type"].toInt(static_cast<int>(UrlType::Single)));
+        record.playlistTitle = json["playlistTitle"].toString();
+        record.playlistCount = json["playlistCount"].toInt(1);
+        record.fetched = json["fetched"].toInteger();
+        record.used = json["used"].toInteger();
+        const QJsonArray entries = json["entries"].toArray();
+        for (const QJsonValue &value : entries) {
+            const QJsonObject position = value.toObject();
+            record.entries.append(Position{position["id"].toString(), position["index"].toInt(1)});
+        }
+        m_urls.insert(it.key(), record);
+    }
+
+    LOG_INFO(QString("Parse cache loaded: %1 URLs, %2 videos").arg(m_urls.size()).arg(m_videos.size()));
+}
+
+bool ParseCache::saveLocked()
+{
+    // 调用方需持有 m_mutex
+    if (!m_dirty) {
+        return true;
+    }
+
+    QJsonObject videos;
+    for (auto it = m_videos.cbegin(); it != m_videos.cend(); ++it) {
+        videos.insert(it.key(), videoToJson(it.value()));
+    }
+
+    QJsonObject urls;
+    for (auto it = m_urls.cbegin(); it != m_urls.cend(); ++it) {
+        QJsonArray entries;
+        for (const Position &position : it->entries) {
+            QJsonObject item;
+            item["id"] = position.id;
+            if (position.index != 1) {
+                item["index"] = position.index;
+            }
+            entries.append(item);
+        }
+        QJsonObject json;
+        json["type"] = static_cast<int>(it->type);
+        if (it->type == UrlType::Lists) {
+            json["playlistTitle"] = it->playlistTitle;
+            json["playlistCount"] = it->playlistCount;
+        }
+        json["fetched"] = it->fetched;
+        json["used"] = it->used;
+        json["entries"] = entries;
+        urls.insert(it.key(), json);
+    }
+
+    QJsonObject root;
+    root["version"] = kFormatVersion;
+    root["urls"] = urls;
+    root["videos"] = videos;
+
+    QSaveFile file(m_path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        LOG_WARNING(QString("Failed to write parse cache: %1").arg(file.errorString()));
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    if (!file.commit()) {
+        LOG_WARNING(QString("Failed to write parse cache: %1").arg(file.errorString()));
+        return false;
+    }
+    m_dirty = false;
+    return true;
+}
+
+void ParseCache::evictLocked()
+{
+    // 调用方需持有 m_mutex
+    if (m_videos.size() <= m_maxEntries) {
+        return;
+    }
+
+    // 按最近使用时间淘汰最旧的视频
+    QList<qint64> times;
+    times.reserve(m_videos.size());
+    for (const VideoRecord &video : std::as_const(m_videos)) {
+        times.append(video.used);
+    }
+    const qsizetype keep = qMax<qsizetype>(1, static_cast<qsizetype>(m_maxEntries * kEvictTarget));
+    const qsizetype drop = times.size() - keep;
+    std::nth_element(times.begin(), times.begin() + (drop - 1), times.end());
+    const qint64 cutoff = times.at(drop - 1);
+
+    qsizetype removed = 0;
+    for (auto it = m_videos.begin(); it != m_videos.end() && removed < drop;) {
+        if (it->used <= cutoff) {
+            it = m_videos.erase(it);
+            ++removed;
+        } else {
+            ++it;
+        }
+    }
+
+    // 引用了已淘汰视频的 URL 记录不再完整
+    for (auto it = m_urls.begin(); it != m_urls.end();) {
+        const bool complete = std::all_of(it->entries.cbegin(), it->entries.cend(), [this](const Position &position) {
+            return m_videos.contains(position.id);
+        });
+        it = complete ? std::next(it) : m_urls.erase(it);
+    }
+}
+
+QJsonObject ParseCache::videoToJson(const VideoRecord &video)
+{
+    // 只保存 ParsedEntry 的字段，不保存 yt-dlp 的完整信息
+    QJsonObject json;
+    json["title"] = video.entry.title;
+    json["url"] = video.entry.url;
+    json["duration"] = video.entry.duration;
+    json["filesize"] = video.entry.filesize;
+    json["thumbnail"] = video.entry.thumbnail;
+    json["formatId"] = video.entry.formatId;
+    json["ext"] = video.entry.ext;
+    if (!video.entry.resolved) {
+        json["flat"] = true;
+    }
+    json["used"] = video.used;
+    return json;
+}
+
+ParseCache::VideoRecord ParseCache::videoFromJson(const QJsonObject &json)
+{
+    VideoRecord video;
+    video.entry.title = json["title"].toString();
+    video.entry.url = json["url"].toString();
+    video.entry.duration = json["duration"].toInt();
+    video.entry.filesize = json["filesize"].toInteger();
+    video.entry.thumbnail = json["thumbnail"].toString();
+    video.entry.formatId = json["formatId"].toString();
+    video.entry.ext = json["ext"].toString("mp4");
+    video.entry.resolved = !json["flat"].toBool();
+    video.entry.type = UrlType::Single;
+    video.entry.playlistCount = 1;
+    video.used = json["used"].toInteger();
+    return video;
+}
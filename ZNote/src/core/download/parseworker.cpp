@@ -0,0 +1,154 @@
+#include "core/download/parseworker.h"
+#include "core/download/urlparserpool.h"
+#include "core/download/entryresolver.h"
+#include "core/download/parsecache.h"
+#include "utils/logger.h"
+#include <QTimer>
+
+namespace {
+// 单批条目上限：接收方处理一批（创建任务、插入模型行）的耗时保持在一帧以内
+constexpr int kMaxBatchEntries = 256;
+}
+
+ParseWorker::ParseWorker(int flushIntervalMs, QObject *parent)
+    : QObject(parent)
+    , m_pool(new UrlParserPool(this))
+    , m_resolver(new EntryResolver(this))
+    , m_cache(nullptr)
+    , m_requestCount(0)
+    , m_flushTimer(new QTimer(this))
+{
+    // 定时器、解析器池和 resolver 都是子对象，随 worker 一起移动到解析线程
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(flushIntervalMs);
+    connect(m_flushTimer, &QTimer::timeout, this, &ParseWorker::flush);
+
+    // 与池和 resolver 在同一线程，信号直接调用
+    connect(m_pool, &UrlParserPool::entryParsed, this, &ParseWorker::onEntryParsed);
+    connect(m_pool, &UrlParserPool::errorOccurred, this, &ParseWorker::onErrorOccurred);
+    connect(m_pool, &UrlParserPool::finished, this, &ParseWorker::onFinished);
+    connect(m_pool, &UrlParserPool::logMessage, this, &ParseWorker::onLogMessage);
+    connect(m_resolver, &EntryResolver::entryResolved, this, &ParseWorker::onEntryResolved);
+    connect(m_resolver, &EntryResolver::logMessage, this, [](const QString &message) {
+        LOG_WARNING(QString("EntryResolver: %1").arg(message));
+    });
+}
+
+UrlParserPool *ParseWorker::pool() const
+{
+    return m_pool;
+}
+
+EntryResolver *ParseWorker::resolver() const
+{
+    return m_resolver;
+}
+
+void ParseWorker::setCache(ParseCache *cache)
+{
+    m_cache = cache;
+}
+
+QStringList ParseWorker::parse(const QStringList &urls)
+{
+    // ID 在调用方线程分配，请求在解析线程中排队
+    QStringList ids;
+    ids.reserve(urls.size());
+    for (int i = 0; i < urls.size(); ++i) {
+        ids.append(QString("url-%1").arg(m_requestCount.fetchAndAddRelaxed(1) + 1));
+    }
+    QMetaObject::invokeMethod(this, [this, ids, urls]() {
+        for (int i = 0; i < urls.size(); ++i) {
+            m_pool->enqueue(ids.at(i), urls.at(i));
+        }
+        if (urls.size() > 1) {
+            onLogMessage(QString("Queued %1 URLs for parsing").arg(urls.size()));
+        }
+    }, Qt::QueuedConnection);
+    return ids;
+}
+
+void ParseWorker::cancel(const QString &requestId)
+{
+    QMetaObject::invokeMethod(this, [this, requestId]() {
+        m_pool->cancel(requestId);
+        // 已缓冲的条目不再送出
+        for (int i = m_pendingEntries.size() - 1; i >= 0; --i) {
+            if (m_pendingEntries.at(i).first == requestId) {
+                m_pendingEntries.removeAt(i);
+            }
+        }
+    }, Qt::QueuedConnection);
+}
+
+void ParseWorker::setWanted(const QList<ParsedEntry> &selected, const QList<ParsedEntry> &visible)
+{
+    QMetaObject::invokeMethod(this, [this, selected, visible]() {
+        m_resolver->setWanted(selected, visible);
+    }, Qt::QueuedConnection);
+}
+
+void ParseWorker::onEntryParsed(const QString &requestId, const ParsedEntry &entry)
+{
+    // 同一请求的连续条目合并到一组
+    if (m_pendingEntries.isEmpty() || m_pendingEntries.last().first != requestId) {
+        m_pendingEntries.append(qMakePair(requestId, QList<ParsedEntry>()));
+    }
+    m_pendingEntries.last().second.append(entry);
+    scheduleFlush();
+}
+
+void ParseWorker::onErrorOccurred(const QString &requestId, const QString &error)
+{
+    // 先送出之前的条目，保证顺序
+    flush();
+    emit errorOccurred(requestId, error);
+}
+
+void ParseWorker::onFinished(const QString &requestId)
+{
+    flush();
+    emit finished(requestId);
+}
+
+void ParseWorker::onEntryResolved(const ParsedEntry &entry)
+{
+    // 记入缓存，下次解析同一播放列表时不必再解析该条目
+    if (m_cache) {
+        m_cache->update(entry);
+    }
+    emit entryResolved(entry);
+}
+
+void ParseWorker::onLogMessage(const QString &message)
+{
+    m_pendingLogs.append(message);
+    scheduleFlush();
+}
+
+void ParseWorker::scheduleFlush()
+{
+    if (!m_flushTimer->isActive()) {
+        m_flushTimer->start();
+    }
+}
+
+void ParseWorker::flush()
+{
+    m_flushTimer->stop();
+
+    if (!m_pendingLogs.isEmpty()) {
+        QStringList logs;
+        logs.swap(m_pendingLogs);
+        emit logBatch(logs);
+    }
+
+    QList<QPair<QString, QList<ParsedEntry>>> pending;
+    pending.swap(m_pendingEntries);
+    for (const auto &group : std::as_const(pending)) {
+        // 大批拆成多个事件，接收方在两批之间可以处理绘制和输入
+        for (qsizetype offset = 0; offset < group.second.size(); offset += kMaxBatchEntries) {
+            emit entriesParsed(group.first, group.second.mid(offset, kMaxBatchEntries));
+        }
+    }
+}
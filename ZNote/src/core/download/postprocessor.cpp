@@ -0,0 +1,324 @@
+#include "core/download/postprocessor.h"
+#include "core/download/processpolicy.h"
+#include "core/download/toolregistry.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QProcess>
+#include <QRegularExpression>
+#include <QThread>
+
+namespace {
+QMutex &settingsMutex()
+{
+    static QMutex mutex;
+    return mutex;
+}
+
+PostProcessor::Settings &sharedSettings()
+{
+    static PostProcessor::Settings settings;
+    return settings;
+}
+
+int jobLimit(const PostProcessor::Settings &settings)
+{
+    return settings.maxJobs > 0 ? settings.maxJobs : qMax(1, QThread::idealThreadCount());
+}
+
+// 流文件名为 <标题>.f<format_id>.<ext>，去掉后缀得到最终文件的基础路径
+QString basePath(const QString &streamPath)
+{
+    static const QRegularExpression streamSuffix(QStringLiteral("\\.f[^./\\\\]+\\.[^./\\\\]+$"));
+    QString base = streamPath;
+    base.remove(streamSuffix);
+    if (base == streamPath) {
+        const QFileInfo info(streamPath);
+        base = info.dir().filePath(info.completeBaseName());
+    }
+    return base;
+}
+
+// 容器是否需要把字幕转换为 mov_text
+bool isMp4Family(const QString &format)
+{
+    return format == "mp4" || format == "m4a" || format == "mov";
+}
+}
+
+void PostProcessor::setSettings(const Settings &settings)
+{
+    QMutexLocker locker(&settingsMutex());
+    sharedSettings() = settings;
+}
+
+PostProcessor::Settings PostProcessor::settings()
+{
+    QMutexLocker locker(&settingsMutex());
+    return sharedSettings();
+}
+
+QString PostProcessor::ffmpegPath()
+{
+    // 由 ToolRegistry 查找一次并缓存，每个任务派发时都会用到
+    if (!ToolRegistry::isAvailable(ToolRegistry::Tool::Ffmpeg)) {
+        return QString();
+    }
+    return ToolRegistry::path(ToolRegistry::Tool::Ffmpeg);
+}
+
+bool PostProcessor::shouldDefer(const DownloadTask &task)
+{
+    const Settings config = settings();
+    if (!config.enabled || task.backend != DownloadBackend::YtDlp || ffmpegPath().isEmpty()) {
+        return false;
+    }
+    // 默认格式（bestvideo+bestaudio）和组合格式需要合并；嵌入或转码时所有任务都需要后处理
+    const bool merges = task.video.formatId.isEmpty() || task.video.formatId.contains('+');
+    return merges || config.embedThumbnail || config.embedSubtitles || !config.transcodeArgs.isEmpty();
+}
+
+PostProcessor::PostProcessor(QObject *parent)
+    : QObject(parent)
+{
+}
+
+PostProcessor::~PostProcessor()
+{
+    // 随 PostProcessor 删除的 ffmpeg 进程会被结束，不再处理其信号
+    for (auto it = m_running.cbegin(); it != m_running.cend(); ++it) {
+        disconnect(it.key(), nullptr, this, nullptr);
+    }
+}
+
+void PostProcessor::enqueue(const DownloadTask &task)
+{
+    m_queue.append(task);
+    startNext();
+}
+
+void PostProcessor::cancelAll()
+{
+    QList<DownloadTask> queued;
+    queued.swap(m_queue);
+    for (const DownloadTask &task : std::as_const(queued)) {
+        complete(task, DownloadStatus::Canceled);
+    }
+
+    // 运行中的任务在进程退出后按取消结束
+    for (auto it = m_running.begin(); it != m_running.end(); ++it) {
+        it.value().canceled = true;
+        it.key()->kill();
+    }
+}
+
+bool PostProcessor::isIdle() const
+{
+    return m_queue.isEmpty() && m_running.isEmpty();
+}
+
+void PostProcessor::startNext()
+{
+    const int limit = jobLimit(settings());
+    while (!m_queue.isEmpty() && m_running.size() < limit) {
+        run(m_queue.takeFirst());
+    }
+}
+
+void PostProcessor::run(const DownloadTask &task)
+{
+    const Settings config = settings();
+    const QString format = config.mergeFormat.isEmpty() ? QString("mp4") : config.mergeFormat;
+    const QString base = basePath(task.files.first().path);
+
+    Job job;
+    job.task = task;
+    job.output = base + "." + format;
+    job.temp = base + ".temp." + format;
+
+    QStringList streams;
+    int videoStreams = 0;
+    for (const DownloadedFile &file : task.files) {
+        if (!streams.contains(file.path)) {
+            streams.append(file.path);
+            videoStreams += file.hasVideo ? 1 : 0;
+        }
+    }
+
+    // 缩略图（<标题>.jpg 等）和字幕（<标题>.<语言>.vtt 等）与流文件放在同一目录
+    QString thumbnail;
+    QStringList subtitles;
+    QStringList languages;
+    if (config.embedThumbnail || config.embedSubtitles) {
+        const QFileInfo baseInfo(base);
+        const QString prefix = baseInfo.fileName() + ".";
+        const QDir dir = baseInfo.dir();
+        const QStringList entries = dir.entryList(QDir::Files, QDir::Name);
+        for (const QString &entry : entries) {
+            if (!entry.startsWith(prefix)) {
+                continue;
+            }
+            const QString rest = entry.mid(prefix.size());
+            const QString suffix = rest.section('.', -1).toLower();
+            if (config.embedThumbnail && thumbnail.isEmpty() && !rest.contains('.')
+                && (suffix == "jpg" || suffix == "jpeg" || suffix == "webp" || suffix == "png")) {
+                thumbnail = dir.filePath(entry);
+            } else if (config.embedSubtitles && rest.count('.') == 1
+                       && (suffix == "vtt" || suffix == "srt" || suffix == "ass")) {
+                subtitles.append(dir.filePath(entry));
+                languages.append(rest.section('.', 0, 0));
+            }
+        }
+    }
+
+    // 本地 ffmpeg 缺少所需的编码器时不嵌入，保留附属文件（编码器列表由 ToolRegistry 探测一次）；
+    // 只在确实要嵌入时检查，探测尚未完成时不等待，直接尝试嵌入
+    ToolRegistry::ToolInfo ffmpeg;
+    if ((!thumbnail.isEmpty() || !subtitles.isEmpty())
+        && ToolRegistry::tryInfo(ToolRegistry::Tool::Ffmpeg, &ffmpeg) && !ffmpeg.capabilities.isEmpty()) {
+        const QSet<QString> &encoders = ffmpeg.capabilities;
+        if (!thumbnail.isEmpty() && !encoders.contains("mjpeg")) {
+            emit logMessage("⚠️ ffmpeg has no mjpeg encoder, thumbnail not embedded");
+            thumbnail.clear();
+        }
+        if (!subtitles.isEmpty() && isMp4Family(format) && !encoders.contains("mov_text")) {
+            emit logMessage("⚠️ ffmpeg has no mov_text encoder, subtitles not embedded");
+            subtitles.clear();
+            languages.clear();
+        }
+    }
+
+    // 单个流且格式相符、无需嵌入或转码时只需重命名
+    if (streams.size() == 1 && thumbnail.isEmpty() && subtitles.isEmpty() && config.transcodeArgs.isEmpty()
+        && QFileInfo(streams.first()).suffix() == format) {
+        DownloadStatus status = DownloadStatus::Success;
+        QFile::remove(job.output);
+        if (QFile::rename(streams.first(), job.output)) {
+            job.task.files = {DownloadedFile{job.output, true}};
+        } else {
+            emit logMessage(QString("❌ Cannot rename %1 to %2").arg(streams.first(), job.output));
+            status = DownloadStatus::Failed;
+        }
+        // 与 ffmpeg 任务一样异步结束，调用方在 enqueue() 返回后才收到结果
+        QMetaObject::invokeMethod(this, [this, done = job.task, status]() {
+            complete(done, status);
+        }, Qt::QueuedConnection);
+        return;
+    }
+
+    QStringList args = {"-hide_banner", "-nostdin", "-loglevel", "error", "-y"};
+    QStringList maps;
+    int input = 0;
+    for (const QString &stream : std::as_const(streams)) {
+        args << "-i" << stream;
+        maps << "-map" << QString::number(input++);
+    }
+    if (!thumbnail.isEmpty()) {
+        args << "-i" << thumbnail;
+        maps << "-map" << QString::number(input++);
+    }
+    for (const QString &subtitle : std::as_const(subtitles)) {
+        args << "-i" << subtitle;
+        maps << "-map" << QString::number(input++);
+    }
+    args << maps;
+
+    // 默认只复制流；转码参数覆盖视频/音频编码，线程在并行的后处理任务之间分配
+    args << "-dn" << "-c" << "copy";
+    if (!config.transcodeArgs.isEmpty()) {
+        args << QProcess::splitCommand(config.transcodeArgs);
+        args << "-threads" << QString::number(qMax(1, QThread::idealThreadCount() / jobLimit(config)));
+    }
+    if (!thumbnail.isEmpty()) {
+        // 缩略图排在所有视频流之后，作为封面
+        const QString index = QString::number(videoStreams);
+        args << QString("-c:v:%1").arg(index) << "mjpeg" << QString("-disposition:v:%1").arg(index) << "attached_pic";
+    }
+    if (!subtitles.isEmpty()) {
+        args << "-c:s" << (isMp4Family(format) ? "mov_text" : "copy");
+        for (int i = 0; i < languages.size(); ++i) {
+            args << QString("-metadata:s:s:%1").arg(i) << QString("language=%1").arg(languages.at(i));
+        }
+    }
+    args << job.temp;
+
+    job.inputs = streams;
+    if (!thumbnail.isEmpty()) {
+        job.inputs << thumbnail;
+    }
+    job.inputs << subtitles;
+
+    QProcess *process = new QProcess(this);
+    connect(process, &QProcess::readyReadStandardError, this, [this, process]() {
+        m_running[process].errors += process->readAllStandardError();
+    });
+    connect(process, &QProcess::finished, this, [this, process]() {
+        handleFinished(process);
+    });
+    connect(process, &QProcess::errorOccurred, this, [this, process](QProcess::ProcessError error) {
+        // 启动失败时不会发出 finished
+        if (error == QProcess::FailedToStart) {
+            handleFinished(process);
+        }
+    });
+    m_running.insert(process, job);
+
+    emit logMessage(QString("🎞️ 后处理: %1").arg(QFileInfo(job.output).fileName()));
+    ProcessPolicy::apply(process, ProcessPolicy::Stage::PostProcess);
+    process->start(ffmpegPath(), args);
+}
+
+void PostProcessor::handleFinished(QProcess *process)
+{
+    auto it = m_running.find(process);
+    if (it == m_running.end()) {
+        return;
+    }
+    Job job = it.value();
+    m_running.erase(it);
+    job.errors += process->readAllStandardError();
+    disconnect(process, nullptr, this, nullptr);
+    process->deleteLater();
+
+    DownloadStatus status = DownloadStatus::Success;
+    if (job.canceled) {
+        status = DownloadStatus::Canceled;
+    } else if (process->error() == QProcess::FailedToStart) {
+        emit logMessage(QString("❌ Failed to start %1").arg(ffmpegPath()));
+        status = DownloadStatus::Failed;
+    } else if (process->exitStatus() != QProcess::NormalExit || process->exitCode() != 0) {
+        emit logMessage(QString("❌ Post-processing failed: %1").arg(QString::fromLocal8Bit(job.errors).trimmed()));
+        status = DownloadStatus::Failed;
+    } else {
+        QFile::remove(job.output);
+        if (QFile::rename(job.temp, job.output)) {
+            // 合并完成后删除各个流和已嵌入的附属文件
+            for (const QString &path : std::as_const(job.inputs)) {
+                QFile::remove(path);
+            }
+            job.task.files = {DownloadedFile{job.output, true}};
+        } else {
+            emit logMessage(QString("❌ Cannot rename %1 to %2").arg(job.temp, job.output));
+            status = DownloadStatus::Failed;
+        }
+    }
+
+    // 失败或取消时保留下载好的流文件，只删除不完整的输出
+    if (status != DownloadStatus::Success) {
+        QFile::remove(job.temp);
+    }
+    complete(job.task, status);
+}
+
+void PostProcessor::complete(DownloadTask task, DownloadStatus status)
+{
+    // 先启动下一个任务，收到 finished 的一方看到的空闲状态才准确
+    startNext();
+
+    task.status = status;
+    task.endTime = QDateTime::currentDateTime();
+    emit finished(task);
+}
@@ -0,0 +1,256 @@
+#include "core/download/processpolicy.h"
+#include "utils/logger.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QProcess>
+#include <QStringList>
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#endif
+
+namespace {
+constexpr int kStageCount = 3;
+constexpr int kMaxCpus = 1024;
+
+#ifdef Q_OS_LINUX
+constexpr int kIoprioWhoProcess = 1;    // IOPRIO_WHO_PROCESS
+constexpr int kIoprioClassShift = 13;   // IOPRIO_CLASS_SHIFT
+#endif
+
+struct SharedState
+{
+    ProcessPolicy::Settings settings;
+    QByteArray procs[kStageCount];      // 各阶段 cgroup.procs 的路径，不使用 cgroup 时为空
+};
+
+QMutex &settingsMutex()
+{
+    static QMutex mutex;
+    return mutex;
+}
+
+SharedState &sharedState()
+{
+    static SharedState state;
+    return state;
+}
+
+int stageIndex(ProcessPolicy::Stage stage)
+{
+    return static_cast<int>(stage);
+}
+
+QString stageName(ProcessPolicy::Stage stage)
+{
+    switch (stage) {
+    case ProcessPolicy::Stage::Download:
+        return "download";
+    case ProcessPolicy::Stage::Parse:
+        return "parse";
+    case ProcessPolicy::Stage::PostProcess:
+        return "postprocess";
+    }
+    return QString();
+}
+
+const ProcessPolicy::Policy &policyFor(const ProcessPolicy::Settings &settings, ProcessPolicy::Stage stage)
+{
+    switch (stage) {
+    case ProcessPolicy::Stage::Parse:
+        return settings.parse;
+    case ProcessPolicy::Stage::PostProcess:
+        return settings.postProcess;
+    case ProcessPolicy::Stage::Download:
+        break;
+    }
+    return settings.download;
+}
+
+bool writeControl(const QString &path, const QByteArray &value)
+{
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly) && file.write(value) == value.size();
+}
+
+// 创建 <root>/<stage> 并写入限制，返回 cgroup.procs 的路径；失败时返回空
+QByteArray prepareCgroup(const QString &root, ProcessPolicy::Stage stage, const ProcessPolicy::Policy &policy)
+{
+    const QDir rootDir(root);
+    // 在根 cgroup 中为子 cgroup 开启控制器；不可用的控制器单独失败，互不影响
+    writeControl(rootDir.filePath("cgroup.subtree_control"), "+cpu");
+    writeControl(rootDir.filePath("cgroup.subtree_control"), "+memory");
+
+    const QString path = rootDir.filePath(stageName(stage));
+    if (!QDir().mkpath(path)) {
+        LOG_WARNING(QString("Cannot create cgroup %1").arg(path));
+        return QByteArray();
+    }
+    // 未配置的限制写回 max，配置清空后不会残留旧值
+    const QByteArray memoryMax = policy.memoryMax.isEmpty() ? QByteArray("max") : policy.memoryMax.toUtf8();
+    if (!writeControl(QDir(path).filePath("memory.max"), memoryMax)) {
+        LOG_WARNING(QString("Cannot set memory.max of cgroup %1").arg(path));
+    }
+    const QByteArray cpuMax = policy.cpuMax.isEmpty() ? QByteArray("max") : policy.cpuMax.toUtf8();
+    if (!writeControl(QDir(path).filePath("cpu.max"), cpuMax)) {
+        LOG_WARNING(QString("Cannot set cpu.max of cgroup %1").arg(path));
+    }
+
+    const QString procs = QDir(path).filePath("cgroup.procs");
+    if (!QFileInfo(procs).isWritable()) {
+        LOG_WARNING(QString("Cannot move processes into cgroup %1").arg(path));
+        return QByteArray();
+    }
+    return QFile::encodeName(procs);
+}
+
+#ifdef Q_OS_UNIX
+// 在 fork 之后、exec 之前由子进程执行的设置
+struct ChildLimits
+{
+    int nice = 0;
+#ifdef Q_OS_LINUX
+    int ioprio = -1;
+    bool pinned = false;
+    cpu_set_t cpus;
+    QByteArray procs;
+#endif
+};
+
+// 子进程中只能使用异步信号安全的调用，不分配内存；失败时保持原样
+void applyInChild(const ChildLimits &limits)
+{
+    // 独立进程组，挂起时可以连同 yt-dlp 启动的 ffmpeg 一起暂停
+    ::setpgid(0, 0);
+    if (limits.nice > 0) {
+        ::setpriority(PRIO_PROCESS, 0, limits.nice);
+    }
+#ifdef Q_OS_LINUX
+    if (limits.ioprio >= 0) {
+        ::syscall(SYS_ioprio_set, kIoprioWhoProcess, 0, limits.ioprio);
+    }
+    if (limits.pinned) {
+        ::sched_setaffinity(0, sizeof(limits.cpus), &limits.cpus);
+    }
+    if (!limits.procs.isEmpty()) {
+        char digits[24];
+        int length = 0;
+        for (pid_t pid = ::getpid(); pid > 0 && length < 24; pid /= 10) {
+            digits[length++] = static_cast<char>('0' + pid % 10);
+        }
+        char text[24];
+        for (int i = 0; i < length; ++i) {
+            text[i] = digits[length - 1 - i];
+        }
+        const int fd = ::open(limits.procs.constData(), O_WRONLY | O_CLOEXEC);
+        if (fd >= 0) {
+            [[maybe_unused]] const ssize_t written = ::write(fd, text, static_cast<size_t>(length));
+            ::close(fd);
+        }
+    }
+#endif
+}
+#endif
+}
+
+void ProcessPolicy::setSettings(const Settings &settings)
+{
+    // cgroup 在配置时准备好，启动进程时只需写入 PID
+    QByteArray procs[kStageCount];
+    if (!settings.cgroupRoot.isEmpty()) {
+        for (Stage stage : {Stage::Download, Stage::Parse, Stage::PostProcess}) {
+            const Policy &policy = policyFor(settings, stage);
+            if (policy.cgroup) {
+                procs[stageIndex(stage)] = prepareCgroup(settings.cgroupRoot, stage, policy);
+            }
+        }
+    }
+
+    QMutexLocker locker(&settingsMutex());
+    SharedState &state = sharedState();
+    state.settings = settings;
+    for (int i = 0; i < kStageCount; ++i) {
+        state.procs[i] = procs[i];
+    }
+}
+
+ProcessPolicy::Settings ProcessPolicy::settings()
+{
+    QMutexLocker locker(&settingsMutex());
+    return sharedState().settings;
+}
+
+void ProcessPolicy::apply(QProcess *process, Stage stage)
+{
+#ifdef Q_OS_UNIX
+    ChildLimits limits;
+    {
+        QMutexLocker locker(&settingsMutex());
+        const SharedState &state = sharedState();
+        const Policy &policy = policyFor(state.settings, stage);
+        limits.nice = qBound(0, policy.nice, 19);
+#ifdef Q_OS_LINUX
+        if (policy.ioClass != IoClass::None) {
+            limits.ioprio = (static_cast<int>(policy.ioClass) << kIoprioClassShift) | qBound(0, policy.ioLevel, 7);
+        }
+        CPU_ZERO(&limits.cpus);
+        for (int cpu : policy.cpus) {
+            if (cpu >= 0 && cpu < CPU_SETSIZE) {
+                CPU_SET(cpu, &limits.cpus);
+                limits.pinned = true;
+            }
+        }
+        limits.procs = state.procs[stageIndex(stage)];
+#endif
+    }
+    process->setChildProcessModifier([limits]() {
+        applyInChild(limits);
+    });
+#else
+    Q_UNUSED(process);
+    Q_UNUSED(stage);
+#endif
+}
+
+ProcessPolicy::IoClass ProcessPolicy::ioClassFromString(const QString &name)
+{
+    const QString value = name.trimmed().toLower();
+    if (value == "realtime" || value == "rt") {
+        return IoClass::Realtime;
+    }
+    if (value == "best-effort" || value == "besteffort" || value == "be") {
+        return IoClass::BestEffort;
+    }
+    if (value == "idle") {
+        return IoClass::Idle;
+    }
+    return IoClass::None;
+}
+
+QList<int> ProcessPolicy::cpuListFromString(const QString &list)
+{
+    QList<int> cpus;
+    const QStringList parts = list.split(',', Qt::SkipEmptyParts);
+    for (const QString &part : parts) {
+        bool firstOk = false;
+        bool lastOk = false;
+        const int first = part.section('-', 0, 0).trimmed().toInt(&firstOk);
+        const int last = part.contains('-') ? part.section('-', 1, 1).trimmed().toInt(&lastOk) : first;
+        if (!firstOk || (part.contains('-') && !lastOk) || first < 0 || last < first || last >= kMaxCpus) {
+            return {};
+        }
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus.append(cpu);
+        }
+    }
+    return cpus;
+}
@@ -0,0 +1,64 @@
+#include "core/download/processreactor.h"
+#include "core/download/videodownloader.h"
+#include <QTimer>
+
+ProcessReactor::ProcessReactor(int flushIntervalMs, QObject *parent)
+    : QObject(parent), m_flushTimer(new QTimer(this))
+{
+    // 定时器是 reactor 的子对象，随 reactor 一起移动到 I/O 线程
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(flushIntervalMs);
+    connect(m_flushTimer, &QTimer::timeout, this, &ProcessReactor::flush);
+}
+
+void ProcessReactor::attach(VideoDownloader *downloader)
+{
+    // 下载器与 reactor 在同一线程，信号直接调用，不产生跨线程事件
+    connect(downloader, &VideoDownloader::logBatch, this, &ProcessReactor::onLogBatch);
+    connect(downloader, &VideoDownloader::progressUpdated, this, &ProcessReactor::onProgressUpdated);
+    connect(downloader, &VideoDownloader::taskFinished, this, &ProcessReactor::onTaskFinished);
+}
+
+void ProcessReactor::onLogBatch(const QStringList &messages)
+{
+    m_pendingLogs.append(messages);
+    if (!m_flushTimer->isActive()) {
+        m_flushTimer->start();
+    }
+}
+
+void ProcessReactor::onProgressUpdated(VideoDownloader *downloader, const DownloadProgress &progress)
+{
+    // 每个任务只保留最新进度，中间值在下一次 flush 前被覆盖
+    m_pendingProgress.insert(progress.taskId, qMakePair(downloader, progress));
+    if (!m_flushTimer->isActive()) {
+        m_flushTimer->start();
+    }
+}
+
+void ProcessReactor::onTaskFinished(VideoDownloader *downloader, const DownloadTask &task)
+{
+    // 先送出该任务之前的日志，保证顺序
+    flush();
+    m_pendingProgress.remove(task.id);
+    emit taskFinished(downloader, task);
+}
+
+void ProcessReactor::flush()
+{
+    m_flushTimer->stop();
+
+    QHash<QString, QPair<VideoDownloader*, DownloadProgress>> progress;
+    progress.swap(m_pendingProgress);
+    for (const auto &item : std::as_const(progress)) {
+        emit progressUpdated(item.first, item.second);
+    }
+
+    if (m_pendingLogs.isEmpty()) {
+        return;
+    }
+
+    QStringList batch;
+    batch.swap(m_pendingLogs);
+    emit logBatch(batch);
+}
@@ -0,0 +1,618 @@
+#include "core/download/segmenteddownloader.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocale>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QSaveFile>
+#include <QTimer>
+#include <chrono>
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <fcntl.h>
+#endif
+
+namespace {
+constexpr int kDefaultSegments = 4;
+constexpr int kMaxSegments = 6;                     // QNetworkAccessManager 每个主机最多 6 个 HTTP/1.1 连接
+constexpr qint64 kMinSegmentSize = 1024 * 1024;     // 每个分段至少 1 MiB，小文件不拆分
+constexpr qint64 kReadBufferSize = 256 * 1024;      // 每个连接的接收缓冲，停止读取时对服务器形成背压
+constexpr int kTickMs = 100;                        // 限速额度补充和进度上报周期
+constexpr int kSpeedWindowMs = 1000;                // 速度按 1 秒窗口计算
+constexpr int kMaxRetries = 5;                      // 单个分段连续失败的最大重试次数
+constexpr int kRetryBaseMs = 1000;                  // 重试间隔 1s、2s、4s ...
+constexpr auto kTransferTimeout = std::chrono::seconds(30);  // 连接无数据传输的超时
+}
+
+SegmentedDownloader::SegmentedDownloader(QObject *parent)
+    : QObject(parent)
+    , m_manager(nullptr)
+    , m_probe(nullptr)
+    , m_tickTimer(new QTimer(this))
+    , m_total(0)
+    , m_reported(-1)
+    , m_speed(0)
+    , m_sampleBytes(0)
+    , m_rateLimit(0)
+    , m_budget(0)
+    , m_segmentCount(kDefaultSegments)
+    , m_generation(0)
+    , m_nextRead(0)
+    , m_ranged(false)
+    , m_suspended(false)
+    , m_running(false)
+{
+    m_tickTimer->setInterval(kTickMs);
+    connect(m_tickTimer, &QTimer::timeout, this, &SegmentedDownloader::tick);
+}
+
+SegmentedDownloader::~SegmentedDownloader()
+{
+    // 连接随 QNetworkAccessManager 一起删除，之前断开信号，不再处理；退出时保留进度，下次启动续传
+    abortTransfer(true);
+}
+
+void SegmentedDownloader::start(const Source &source, int segments)
+{
+    abortTransfer(true);
+
+    m_source = source;
+    m_validator.clear();
+    m_segments.clear();
+    m_segmentCount = segments > 0 ? qMin(segments, kMaxSegments) : kDefaultSegments;
+    if (segments > kMaxSegments) {
+        emit logMessage(QString("⚠️ %1 connections requested, using %2: at most %2 HTTP/1.1 connections per host")
+                            .arg(segments)
+                            .arg(kMaxSegments));
+    }
+    m_total = 0;
+    m_reported = -1;
+    m_speed = 0;
+    m_sampleBytes = 0;
+    m_budget = 0;
+    m_nextRead = 0;
+    m_ranged = false;
+    m_suspended = false;
+    m_running = true;
+
+    if (m_manager == nullptr) {
+        // 在下载器所在的线程中创建
+        m_manager = new QNetworkAccessManager(this);
+    }
+    if (m_buffer.isEmpty()) {
+        m_buffer.resize(kReadBufferSize);
+    }
+
+    // 先只请求第一个字节：206 响应说明支持 Range，并通过 Content-Range 给出总大小
+    QNetworkRequest request = makeRequest();
+    request.setRawHeader("Range", "bytes=0-0");
+    m_probe = m_manager->get(request);
+    connect(m_probe, &QNetworkReply::metaDataChanged, this, &SegmentedDownloader::handleProbeMetaData);
+    connect(m_probe, &QNetworkReply::finished, this, &SegmentedDownloader::handleProbeFinished);
+
+    m_sampleTimer.start();
+    m_tickTimer->start();
+}
+
+int SegmentedDownloader::maxSegments()
+{
+    return kMaxSegments;
+}
+
+QString SegmentedDownloader::filePath() const
+{
+    return m_source.filePath;
+}
+
+bool SegmentedDownloader::isRunning() const
+{
+    return m_running;
+}
+
+void SegmentedDownloader::cancel()
+{
+    if (!m_running) {
+        return;
+    }
+    // 暂停（结束后重新排队）和停止队列都经过这里，与 yt-dlp 一样保留 .part 文件以便续传
+    abortTransfer(true);
+    // 与结束 yt-dlp 进程一样异步通知，调用方在 cancel() 返回后才收到结果
+    QMetaObject::invokeMethod(this, [this]() {
+        emit finished(false, QString("Canceled"));
+    }, Qt::QueuedConnection);
+}
+
+void SegmentedDownloader::suspend()
+{
+    if (m_running) {
+        m_suspended = true;
+    }
+}
+
+void SegmentedDownloader::resume()
+{
+    if (!m_suspended) {
+        return;
+    }
+    m_suspended = false;
+
+    // 暂停期间断开的连接从已写入的位置重新请求，其余连接读取缓冲中的数据
+    for (int i = 0; i < m_segments.size() && m_running; ++i) {
+        if (m_segments.at(i).waiting) {
+            startSegment(i);
+        } else {
+            readSegment(i);
+        }
+    }
+}
+
+void SegmentedDownloader::setRateLimit(qint64 bytesPerSecond)
+{
+    m_rateLimit = qMax<qint64>(0, bytesPerSecond);
+    m_budget = 0;
+    if (m_rateLimit == 0) {
+        // 取消限速后立即读取已缓冲的数据
+        for (int i = 0; i < m_segments.size() && m_running; ++i) {
+            readSegment(i);
+        }
+    }
+}
+
+QNetworkRequest SegmentedDownloader::makeRequest() const
+{
+    QNetworkRequest request(m_source.url);
+    for (auto it = m_source.headers.cbegin(); it != m_source.headers.cend(); ++it) {
+        request.setRawHeader(it.key(), it.value());
+    }
+    // Range 按原始字节计算，不能让服务器压缩传输
+    request.setRawHeader("Accept-Encoding", "identity");
+    request.setTransferTimeout(kTransferTimeout);
+    return request;
+}
+
+QString SegmentedDownloader::partPath() const
+{
+    return m_source.filePath + ".part";
+}
+
+QString SegmentedDownloader::statePath() const
+{
+    return partPath() + ".segments";
+}
+
+bool SegmentedDownloader::restoreState()
+{
+    QFile file(statePath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QJsonObject state = QJsonDocument::fromJson(file.readAll()).object();
+
+    // 文件大小或校验值变化说明服务器上的文件已经不同，已下载的数据不能再用
+    if (state["total"].toInteger() != m_total
+        || state["validator"].toString().toUtf8() != m_validator
+        || QFileInfo(partPath()).size() != m_total) {
+        return false;
+    }
+
+    // 各分段必须首尾相接地覆盖整个文件
+    QVector<Segment> segments;
+    qint64 next = 0;
+    for (const QJsonValue &value : state["segments"].toArray()) {
+        const QJsonObject object = value.toObject();
+        Segment segment;
+        segment.begin = object["begin"].toInteger(-1);
+        segment.end = object["end"].toInteger(-1);
+        segment.pos = object["pos"].toInteger(-1);
+        if (segment.begin != next || segment.end < segment.begin
+            || segment.pos < segment.begin || segment.pos > segment.end + 1) {
+            return false;
+        }
+        segment.done = segment.pos > segment.end;
+        next = segment.end + 1;
+        segments.append(segment);
+    }
+    if (segments.isEmpty() || next != m_total) {
+        return false;
+    }
+
+    m_segments = segments;
+    return true;
+}
+
+void SegmentedDownloader::saveState()
+{
+    QJsonArray segments;
+    for (const Segment &segment : std::as_const(m_segments)) {
+        segments.append(QJsonObject{{"begin", segment.begin}, {"end", segment.end}, {"pos", segment.pos}});
+    }
+    const QJsonObject state{
+        {"total", m_total},
+        {"validator", QString::fromUtf8(m_validator)},
+        {"segments", segments},
+    };
+
+    QSaveFile file(statePath());
+    if (!file.open(QIODevice::WriteOnly)
+        || file.write(QJsonDocument(state).toJson(QJsonDocument::Compact)) < 0
+        || !file.commit()) {
+        // 没有进度记录时下次从头下载，不影响本次结果
+        emit logMessage(QString("⚠️ Cannot save segment offsets to %1: %2").arg(statePath(), file.errorString()));
+    }
+}
+
+void SegmentedDownloader::handleProbeMetaData()
+{
+    const int status = m_probe->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (status == 206) {
+        // Content-Range: bytes 0-0/12345；总大小未知（*）时按不支持 Range 处理
+        const QByteArray range = m_probe->rawHeader("Content-Range");
+        const qsizetype slash = range.lastIndexOf('/');
+        bool ok = false;
+        const qint64 total = slash >= 0 ? range.mid(slash + 1).trimmed().toLongLong(&ok) : 0;
+        if (ok && total > 0) {
+            m_ranged = true;
+            m_total = total;
+            // 续传前用于确认服务器上的文件没有变化
+            m_validator = m_probe->rawHeader("ETag");
+            if (m_validator.isEmpty()) {
+                m_validator = m_probe->rawHeader("Last-Modified");
+            }
+        }
+    } else if (status == 200) {
+        // 服务器忽略了 Range，只能用一个连接从头下载
+        m_total = qMax<qint64>(0, m_probe->header(QNetworkRequest::ContentLengthHeader).toLongLong());
+    } else {
+        // 错误状态在 finished 中处理
+        return;
+    }
+
+    // 只需要响应头，结束探测请求
+    QNetworkReply *probe = m_probe;
+    m_probe = nullptr;
+    disconnect(probe, nullptr, this, nullptr);
+    probe->abort();
+    probe->deleteLater();
+
+    beginTransfer();
+}
+
+void SegmentedDownloader::handleProbeFinished()
+{
+    QNetworkReply *probe = m_probe;
+    m_probe = nullptr;
+    probe->deleteLater();
+
+    const int status = probe->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    fail(probe->error() != QNetworkReply::NoError
+             ? probe->errorString()
+             : QString("Unexpected HTTP status %1").arg(status));
+}
+
+void SegmentedDownloader::beginTransfer()
+{
+    QDir().mkpath(QFileInfo(m_source.filePath).absolutePath());
+    m_file.setFileName(partPath());
+
+    // 上次中断时保存了分段进度，且服务器上的文件没有变化时，各分段从中断处继续（分段数沿用上次的）
+    const bool resumed = m_ranged && restoreState();
+    QFile::remove(statePath());
+    const QIODevice::OpenMode mode = resumed ? QIODevice::ReadWrite : QIODevice::ReadWrite | QIODevice::Truncate;
+    if (!m_file.open(mode)) {
+        fail(QString("Cannot open %1: %2").arg(m_file.fileName(), m_file.errorString()));
+        return;
+    }
+
+    if (!resumed) {
+        // 预先分配完整大小，各分段按偏移直接写入；Linux 上同时分配实际的磁盘空间
+        // （resize 只产生稀疏文件），避免多个分段交错写入造成碎片，空间不足时也能尽早失败
+#ifdef Q_OS_LINUX
+        if (m_total > 0 && ::fallocate(m_file.handle(), 0, 0, m_total) != 0 && errno == ENOSPC) {
+            fail(QString("Not enough space for %1").arg(m_file.fileName()));
+            return;
+        }
+#endif
+        if (m_total > 0 && !m_file.resize(m_total)) {
+            fail(QString("Cannot allocate %1: %2").arg(m_file.fileName(), m_file.errorString()));
+            return;
+        }
+
+        int count = 1;
+        if (m_ranged) {
+            count = static_cast<int>(qBound<qint64>(1, m_total / kMinSegmentSize, m_segmentCount));
+        }
+        const qint64 size = m_ranged ? m_total / count : 0;
+        for (int i = 0; i < count; ++i) {
+            Segment segment;
+            segment.begin = i * size;
+            segment.end = !m_ranged ? -1 : (i == count - 1 ? m_total - 1 : (i + 1) * size - 1);
+            segment.pos = segment.begin;
+            m_segments.append(segment);
+        }
+    }
+
+    const int count = m_segments.size();
+    if (resumed) {
+        qint64 downloaded = 0;
+        for (const Segment &segment : std::as_const(m_segments)) {
+            downloaded += segment.pos - segment.begin;
+        }
+        // 速度从续传的位置开始计算
+        m_sampleBytes = downloaded;
+        emit logMessage(QString("⚡ Resuming segmented download: %1 of %2, %3 connections")
+                            .arg(QLocale::system().formattedDataSize(downloaded))
+                            .arg(QLocale::system().formattedDataSize(m_total))
+                            .arg(count));
+    } else if (m_ranged) {
+        emit logMessage(QString("⚡ Segmented download: %1, %2 connections")
+                            .arg(QLocale::system().formattedDataSize(m_total))
+                            .arg(count));
+    } else {
+        emit logMessage("⚠️ Server does not support range requests, using a single connection");
+    }
+
+    for (int i = 0; i < count && m_running; ++i) {
+        if (!m_segments.at(i).done) {
+            startSegment(i);
+        }
+    }
+    // 中断时所有分段恰好都已写完
+    checkCompleted();
+}
+
+void SegmentedDownloader::startSegment(int index)
+{
+    Segment &segment = m_segments[index];
+    QNetworkRequest request = makeRequest();
+    if (m_ranged) {
+        // 从该分段已写入的位置继续
+        request.setRawHeader("Range", "bytes=" + QByteArray::number(segment.pos) + '-' + QByteArray::number(segment.end));
+    } else {
+        // 无法续传，重新从头下载
+        segment.pos = segment.begin;
+    }
+
+    segment.reply = m_manager->get(request);
+    segment.reply->setReadBufferSize(kReadBufferSize);
+    segment.replyFinished = false;
+    segment.waiting = false;
+    connect(segment.reply, &QNetworkReply::readyRead, this, [this, index]() {
+        readSegment(index);
+    });
+    connect(segment.reply, &QNetworkReply::finished, this, [this, index]() {
+        m_segments[index].replyFinished = true;
+        readSegment(index);
+    });
+}
+
+void SegmentedDownloader::readSegment(int index)
+{
+    Segment &segment = m_segments[index];
+    QNetworkReply *reply = segment.reply;
+    if (reply == nullptr) {
+        return;
+    }
+
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (m_ranged && status == 200) {
+        // 服务器对该请求忽略了 Range，按偏移写入会破坏文件
+        fail("Server ignored the range request");
+        return;
+    }
+    // 错误响应的正文（错误页面）不写入文件
+    const bool accepted = status == (m_ranged ? 206 : 200);
+
+    bool received = false;
+    while (accepted && !m_suspended && reply->bytesAvailable() > 0) {
+        qint64 allowed = qMin<qint64>(reply->bytesAvailable(), m_buffer.size());
+        if (m_rateLimit > 0) {
+            if (m_budget <= 0) {
+                break;
+            }
+            allowed = qMin(allowed, m_budget);
+        }
+        if (m_ranged) {
+            allowed = qMin(allowed, segment.end + 1 - segment.pos);
+        }
+        if (allowed <= 0) {
+            break;
+        }
+
+        const qint64 read = reply->read(m_buffer.data(), allowed);
+        if (read <= 0) {
+            break;
+        }
+        if (!m_file.seek(segment.pos) || m_file.write(m_buffer.constData(), read) != read) {
+            fail(QString("Cannot write %1: %2").arg(m_file.fileName(), m_file.errorString()));
+            return;
+        }
+        segment.pos += read;
+        if (m_rateLimit > 0) {
+            m_budget -= read;
+        }
+        received = true;
+    }
+    if (received) {
+        // 有进展的连接重新计算重试次数
+        segment.retries = 0;
+    }
+
+    // 连接结束且缓冲已读完（或分段已写满）后才处理结果
+    if (segment.replyFinished
+        && (!accepted || reply->bytesAvailable() == 0 || (m_ranged && segment.pos > segment.end))) {
+        finishSegment(index);
+    }
+}
+
+void SegmentedDownloader::finishSegment(int index)
+{
+    Segment &segment = m_segments[index];
+    QNetworkReply *reply = segment.reply;
+    segment.reply = nullptr;
+    disconnect(reply, nullptr, this, nullptr);
+    reply->deleteLater();
+
+    const bool complete = m_ranged
+        ? segment.pos > segment.end
+        : reply->error() == QNetworkReply::NoError;
+    if (complete) {
+        segment.done = true;
+        checkCompleted();
+        return;
+    }
+
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    const QString error = reply->error() != QNetworkReply::NoError
+        ? reply->errorString()
+        : QString("connection closed early");
+
+    segment.waiting = true;
+    if (m_suspended) {
+        // 暂停期间连接超时断开，恢复时重新请求，不计入重试次数
+        return;
+    }
+    // 4xx（超时和限流除外）重试也不会成功，例如直链已过期
+    const bool permanent = status >= 400 && status < 500 && status != 408 && status != 429;
+    if (permanent || ++segment.retries > kMaxRetries) {
+        fail(QString("Segment %1 failed: %2").arg(index + 1).arg(error));
+        return;
+    }
+
+    const int delay = kRetryBaseMs << (segment.retries - 1);
+    emit logMessage(QString("⚠️ Segment %1: %2, retrying in %3 s (%4/%5)")
+                        .arg(index + 1)
+                        .arg(error)
+                        .arg(delay / 1000)
+                        .arg(segment.retries)
+                        .arg(kMaxRetries));
+    const int generation = m_generation;
+    QTimer::singleShot(delay, this, [this, index, generation]() {
+        if (generation == m_generation && !m_suspended && m_segments.at(index).waiting) {
+            startSegment(index);
+        }
+    });
+}
+
+void SegmentedDownloader::checkCompleted()
+{
+    for (const Segment &segment : std::as_const(m_segments)) {
+        if (!segment.done) {
+            return;
+        }
+    }
+
+    if (!m_ranged) {
+        // 大小未知时以实际写入的字节数为准
+        m_total = m_segments.first().pos;
+        m_file.resize(m_total);
+    }
+    m_file.close();
+
+    QFile::remove(m_source.filePath);
+    if (!QFile::rename(partPath(), m_source.filePath)) {
+        fail(QString("Cannot rename %1 to %2").arg(partPath(), m_source.filePath));
+        return;
+    }
+
+    m_running = false;
+    m_tickTimer->stop();
+    reportProgress(true);
+    emit finished(true, QString());
+}
+
+void SegmentedDownloader::tick()
+{
+    if (m_rateLimit > 0 && !m_segments.isEmpty()) {
+        // 每个周期补充额度，最多积累两个周期，避免空闲后突发
+        const qint64 refill = qMax<qint64>(1, m_rateLimit * kTickMs / 1000);
+        m_budget = qMin(m_budget + refill, 2 * refill);
+
+        // 每个周期从不同的分段开始读取，额度在连接之间轮流分配
+        const int count = m_segments.size();
+        for (int i = 0; i < count && m_budget > 0 && m_running; ++i) {
+            readSegment((m_nextRead + i) % count);
+        }
+        m_nextRead = (m_nextRead + 1) % count;
+        if (!m_running) {
+            return;
+        }
+    }
+    reportProgress(false);
+}
+
+void SegmentedDownloader::reportProgress(bool force)
+{
+    qint64 downloaded = 0;
+    for (const Segment &segment : std::as_const(m_segments)) {
+        downloaded += segment.pos - segment.begin;
+    }
+
+    bool speedUpdated = false;
+    const qint64 elapsed = m_sampleTimer.elapsed();
+    if (elapsed >= kSpeedWindowMs) {
+        // 单连接重新下载时字节数会回退，速度按 0 计
+        m_speed = qMax<qint64>(0, (downloaded - m_sampleBytes) * 1000 / elapsed);
+        m_sampleBytes = downloaded;
+        m_sampleTimer.restart();
+        speedUpdated = true;
+    }
+
+    if (!force && !speedUpdated && downloaded == m_reported) {
+        return;
+    }
+    m_reported = downloaded;
+    const qint64 total = m_total > 0 ? m_total : qMax(m_source.sizeHint, downloaded);
+    emit progress(downloaded, total, m_speed);
+}
+
+void SegmentedDownloader::fail(const QString &error)
+{
+    abortTransfer(false);
+    emit finished(false, error);
+}
+
+void SegmentedDownloader::abortTransfer(bool keepPartial)
+{
+    abortReplies();
+    m_running = false;
+    m_suspended = false;
+    m_tickTimer->stop();
+
+    if (m_file.isOpen()) {
+        // 先关闭文件，保证记录的偏移之前的数据都已写入
+        m_file.close();
+        // 支持 Range 时记录各分段写到的位置供下次续传；单连接下载无法续传，直接删除
+        if (keepPartial && m_ranged) {
+            saveState();
+        } else {
+            QFile::remove(m_file.fileName());
+            QFile::remove(statePath());
+        }
+    }
+}
+
+void SegmentedDownloader::abortReplies()
+{
+    // 使等待中的重试失效
+    ++m_generation;
+
+    if (m_probe) {
+        disconnect(m_probe, nullptr, this, nullptr);
+        m_probe->abort();
+        m_probe->deleteLater();
+        m_probe = nullptr;
+    }
+    for (Segment &segment : m_segments) {
+        if (segment.reply) {
+            disconnect(segment.reply, nullptr, this, nullptr);
+            segment.reply->abort();
+            segment.reply->deleteLater();
+            segment.reply = nullptr;
+        }
+    }
+}
@@ -0,0 +1,391 @@
+#include "core/download/taskjournal.h"
+#include "utils/logger.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QDir>
+#include <QMutexLocker>
+
+namespace {
+constexpr int kMinCompactRecords = 1000;  // 记录数少于此值时不压缩
+}
+
+TaskJournal::TaskJournal(const QString &path)
+    : m_path(path.isEmpty() ? defaultPath() : path)
+    , m_backSequence(0)
+    , m_frontSequence(-1)
+    , m_records(0)
+{
+    m_file.setFileName(m_path);
+}
+
+TaskJournal::~TaskJournal()
+{
+    QMutexLocker locker(&m_mutex);
+    m_file.close();
+}
+
+QString TaskJournal::path() const
+{
+    return m_path;
+}
+
+QList<DownloadTask> TaskJournal::replay()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_live.clear();
+    m_order.clear();
+    m_records = 0;
+    m_file.close();
+
+    QFile file(m_path);
+    if (file.exists()) {
+        if (!file.open(QIODevice::ReadOnly)) {
+            LOG_WARNING(QString("Failed to open task journal: %1").arg(m_path));
+        } else {
+            // 一次读入整个文件再逐行解析，避免逐行 I/O
+            const QByteArray data = file.readAll();
+            file.close();
+
+            int skipped = 0;
+            qsizetype start = 0;
+            while (start < data.size()) {
+                qsizetype end = data.indexOf('\n', start);
+                if (end < 0) {
+                    end = data.size();
+                }
+                QByteArray line = data.mid(start, end - start).trimmed();
+                start = end + 1;
+                if (line.isEmpty()) {
+                    continue;
+                }
+
+                // 进程被强制结束时最后一行可能不完整，跳过无法解析的行
+                QJsonParseError error;
+                QJsonDocument doc = QJsonDocument::fromJson(line, &error);
+                if (error.error != QJsonParseError::NoError || !doc.isObject()) {
+                    ++skipped;
+                    continue;
+                }
+                apply(doc.object());
+                ++m_records;
+            }
+
+            if (skipped > 0) {
+                LOG_WARNING(QString("Task journal: skipped %1 damaged records").arg(skipped));
+            }
+        }
+    }
+
+    QList<DownloadTask> tasks;
+    tasks.reserve(m_live.size());
+    for (const auto &entry : m_order) {
+        tasks.append(m_live.value(entry.second).task);
+    }
+
+    // 回放后立即压缩，只保留未完成的任务
+    compactLocked();
+
+    LOG_INFO(QString("Task journal replayed: %1 unfinished tasks").arg(tasks.size()));
+    return tasks;
+}
+
+void TaskJournal::recordEnqueue(const QList<DownloadTask> &tasks)
+{
+    if (tasks.isEmpty()) {
+        return;
+    }
+
+    // 批量添加时只写一次文件
+    QByteArray lines;
+    QMutexLocker locker(&m_mutex);
+    for (const DownloadTask &task : tasks) {
+        QJsonObject record;
+        record["op"] = "enqueue";
+        record["task"] = taskToJson(task);
+        apply(record);
+        lines += QJsonDocument(record).toJson(QJsonDocument::Compact);
+        lines += '\n';
+    }
+    append(lines, tasks.size());
+}
+
+void TaskJournal::recordMoveToFront(const QString &taskId)
+{
+    QJsonObject record;
+    record["op"] = "front";
+    record["id"] = taskId;
+
+    QMutexLocker locker(&m_mutex);
+    if (apply(record)) {
+        append(QJsonDocument(record).toJson(QJsonDocument::Compact) + '\n', 1);
+    }
+}
+
+void TaskJournal::recordStart(const QString &taskId)
+{
+    QJsonObject record;
+    record["op"] = "start";
+    record["id"] = taskId;
+
+    QMutexLocker locker(&m_mutex);
+    if (apply(record)) {
+        append(QJsonDocument(record).toJson(QJsonDocument::Compact) + '\n', 1);
+    }
+}
+
+void TaskJournal::recordFinish(const QString &taskId)
+{
+    QJsonObject record;
+    record["op"] = "finish";
+    record["id"] = taskId;
+
+    QMutexLocker locker(&m_mutex);
+    if (apply(record)) {
+        append(QJsonDocument(record).toJson(QJsonDocument::Compact) + '\n', 1);
+    }
+}
+
+void TaskJournal::recordCancel(const QString &taskId)
+{
+    QJsonObject record;
+    record["op"] = "cancel";
+    record["id"] = taskId;
+
+    QMutexLocker locker(&m_mutex);
+    if (apply(record)) {
+        append(QJsonDocument(record).toJson(QJsonDocument::Compact) + '\n', 1);
+    }
+}
+
+void TaskJournal::recordCancel(const QStringList &taskIds)
+{
+    // 清空队列时可能有上万个任务，只写一次文件
+    QByteArray lines;
+    int records = 0;
+    QMutexLocker locker(&m_mutex);
+    for (const QString &taskId : taskIds) {
+        QJsonObject record;
+        record["op"] = "cancel";
+        record["id"] = taskId;
+        if (apply(record)) {
+            lines += QJsonDocument(record).toJson(QJsonDocument::Compact);
+            lines += '\n';
+            ++records;
+        }
+    }
+    if (records > 0) {
+        append(lines, records);
+    }
+}
+
+bool TaskJournal::compact()
+{
+    QMutexLocker locker(&m_mutex);
+    return compactLocked();
+}
+
+bool TaskJournal::compactLocked()
+{
+    // 调用方需持有 m_mutex
+    QFileInfo info(m_path);
+    QDir().mkpath(info.absolutePath());
+
+    // 先写临时文件再原子替换，压缩过程中崩溃不会丢失原日志
+    QSaveFile file(m_path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        LOG_WARNING(QString("Failed to compact task journal: %1").arg(file.errorString()));
+        return false;
+    }
+
+    QByteArray data;
+    int records = 0;
+    for (const auto &item : m_order) {
+        const Entry &entry = m_live.find(item.second).value();
+        QJsonObject record;
+        record["op"] = "enqueue";
+        record["task"] = taskToJson(entry.task);
+        data += QJsonDocument(record).toJson(QJsonDocument::Compact);
+        data += '\n';
+        ++records;
+
+        if (entry.started) {
+            QJsonObject started;
+            started["op"] = "start";
+            started["id"] = entry.task.id;
+            data += QJsonDocument(started).toJson(QJsonDocument::Compact);
+            data += '\n';
+            ++records;
+        }
+    }
+
+    m_file.close();
+    file.write(data);
+    if (!file.commit()) {
+        LOG_WARNING(QString("Failed to compact task journal: %1").arg(file.errorString()));
+        openForAppend();
+        return false;
+    }
+
+    m_records = records;
+    return openForAppend();
+}
+
+QString TaskJournal::defaultPath()
+{
+    // 与下载历史文件放在同一目录：优先应用程序目录，不可写时使用 AppDataLocation
+    QString appDir = QCoreApplication::applicationDirPath();
+    if (QDir(appDir).exists() && QFileInfo(appDir).isWritable()) {
+        return QDir(appDir).filePath("download_queue.jsonl");
+    }
+
+    QString appDataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(appDataPath);
+    return QDir(appDataPath).filePath("download_queue.jsonl");
+}
+
+bool TaskJournal::apply(const QJsonObject &record)
+{
+    // 调用方需持有 m_mutex
+    const QString op = record["op"].toString();
+
+    if (op == "enqueue") {
+        DownloadTask task = taskFromJson(record["task"].toObject());
+        if (task.id.isEmpty()) {
+            return false;
+        }
+        auto it = m_live.find(task.id);
+        if (it != m_live.end()) {
+            // 重复记录视为更新（如修改优先级），保持原有队列位置
+            it.value().task = task;
+        } else {
+            qint64 sequence = m_backSequence++;
+            m_live.insert(task.id, Entry{task, sequence, false});
+            m_order.emplace(sequence, task.id);
+        }
+        return true;
+    }
+
+    // 旧版本清空队列时写入的记录，现在改为逐个取消尚未开始的任务
+    if (op == "clear") {
+        m_live.clear();
+        m_order.clear();
+        return true;
+    }
+
+    auto it = m_live.find(record["id"].toString());
+    if (it == m_live.end()) {
+        return false;
+    }
+
+    if (op == "start") {
+        it.value().started = true;
+    } else if (op == "front") {
+        m_order.erase(it.value().sequence);
+        it.value().sequence = m_frontSequence--;
+        m_order.emplace(it.value().sequence, it.key());
+    } else if (op == "finish" || op == "cancel") {
+        m_order.erase(it.value().sequence);
+        m_live.erase(it);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void TaskJournal::append(const QByteArray &lines, int records)
+{
+    // 调用方需持有 m_mutex
+    if (!m_file.isOpen() && !openForAppend()) {
+        return;
+    }
+
+    // 立即 flush 到操作系统，进程被结束时记录不会丢失
+    if (m_file.write(lines) != lines.size() || !m_file.flush()) {
+        LOG_WARNING(QString("Failed to write task journal: %1").arg(m_file.errorString()));
+        return;
+    }
+    m_records += records;
+
+    compactIfNeeded();
+}
+
+bool TaskJournal::openForAppend()
+{
+    // 调用方需持有 m_mutex
+    if (m_file.isOpen()) {
+        return true;
+    }
+    QDir().mkpath(QFileInfo(m_path).absolutePath());
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        LOG_WARNING(QString("Failed to open task journal: %1").arg(m_file.errorString()));
+        return false;
+    }
+    return true;
+}
+
+void TaskJournal::compactIfNeeded()
+{
+    // 调用方需持有 m_mutex；记录数超过存活任务的两倍时重写文件
+    if (m_records < kMinCompactRecords || m_records <= 2 * m_live.size()) {
+        return;
+    }
+
+    compactLocked();
+}
+
+QJsonObject TaskJournal::taskToJson(const DownloadTask &task)
+{
+    QJsonObject json;
+    json["id"] = task.id;
+    json["index"] = task.index;
+    json["playlistCount"] = task.playlistCount;
+    json["type"] = static_cast<int>(task.type);
+    json["title"] = task.video.title;
+    json["url"] = task.video.url;
+    json["playlistTitle"] = task.video.playlistTitle;
+    json["ext"] = task.video.ext;
+    json["formatId"] = task.video.formatId;
+    json["duration"] = task.video.duration;
+    json["filesize"] = task.video.filesize;
+    json["savePath"] = task.savePath;
+    json["resolveTime"] = task.resolveTime.toString(Qt::ISODateWithMs);
+    json["priority"] = task.priority;
+    if (task.deadline.isValid()) {
+        json["deadline"] = task.deadline.toString(Qt::ISODateWithMs);
+    }
+    json["groupId"] = task.groupId;
+    json["backend"] = static_cast<int>(task.backend);
+    json["connections"] = task.connections;
+    return json;
+}
+
+DownloadTask TaskJournal::taskFromJson(const QJsonObject &json)
+{
+    DownloadTask task;
+    task.id = json["id"].toString();
+    task.index = json["index"].toInt(1);
+    task.playlistCount = json["playlistCount"].toInt(1);
+    task.type = static_cast<UrlType>(json["type"].toInt(static_cast<int>(UrlType::Unknown)));
+    task.video.title = json["title"].toString();
+    task.video.url = json["url"].toString();
+    task.video.playlistTitle = json["playlistTitle"].toString();
+    task.video.ext = json["ext"].toString("mp4");
+    task.video.formatId = json["formatId"].toString();
+    task.video.duration = json["duration"].toInt();
+    task.video.filesize = static_cast<qint64>(json["filesize"].toDouble());
+    task.savePath = json["savePath"].toString();
+    task.resolveTime = QDateTime::fromString(json["resolveTime"].toString(), Qt::ISODateWithMs);
+    task.priority = json["priority"].toInt();
+    if (json.contains("deadline")) {
+        task.deadline = QDateTime::fromString(json["deadline"].toString(), Qt::ISODateWithMs);
+    }
+    task.groupId = json["groupId"].toString();
+    task.backend = static_cast<DownloadBackend>(json["backend"].toInt(static_cast<int>(DownloadBackend::YtDlp)));
+    task.connections = json["connections"].toInt();
+    return task;
+}
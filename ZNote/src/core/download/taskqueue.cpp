@@ -1,20 +1,103 @@
 #include "core/download/taskqueue.h"
 #include "core/download/videodownloader.h"
-#include <QThread>
+#include "core/download/downloaderpool.h"
+#include "core/download/postprocessor.h"
+#include "core/download/filemover.h"
+#include "core/download/segmenteddownloader.h"
 #include <QMutex>
 #include <QMutexLocker>
+#include <QTimer>
+#include <QSet>
+#include <QPair>
 #include <QDebug>
 
+namespace {
+constexpr int kBatchScanLimit = 64;  // 组批时最多检查的排队任务数
+constexpr int kMaxTaskConnections = 16;                     // 单个任务最多的并行连接数
+constexpr qint64 kSingleConnectionBytes = 32 * 1024 * 1024; // 小于此大小的任务只用一个连接
+}
+
 TaskQueue::TaskQueue(int max, QObject *parent)
-    : QObject(parent), maxConcurrent(max), paused(false)
+    : QObject(parent), m_pool(new DownloaderPool(max, this)), m_postProcessor(new PostProcessor(this)),
+      m_mover(new FileMover(this)), m_retryTimer(new QTimer(this)),
+      m_bandwidthLimit(0), m_rebalanceTimer(new QTimer(this)), m_failures(0), m_adaptive(false),
+      m_sampleTimer(new QTimer(this)), m_pauseMode(PauseMode::Suspend), m_batchSize(1),
+      m_connectionBudget(0), m_configuredMax(max), maxConcurrent(max), paused(false)
 {
+    m_clock.start();
+
+    // 主机限速时，等令牌补充后再次尝试调度
+    m_retryTimer->setSingleShot(true);
+    connect(m_retryTimer, &QTimer::timeout, this, &TaskQueue::startNext);
+
+    // 任务启动/结束往往成批出现，合并后再重新分配带宽，减少 yt-dlp 重启次数
+    m_rebalanceTimer->setSingleShot(true);
+    m_rebalanceTimer->setInterval(2000);
+    connect(m_rebalanceTimer, &QTimer::timeout, this, &TaskQueue::rebalanceBandwidth);
+
+    // 自适应并发：定期采样总吞吐
+    m_sampleTimer->setInterval(5000);
+    connect(m_sampleTimer, &QTimer::timeout, this, &TaskQueue::sampleThroughput);
+    connect(m_pool, &DownloaderPool::progressUpdated, this, &TaskQueue::onProgressUpdated);
+
+    // 工作线程池中的下载器长期存在，信号只需连接一次
+    connect(m_pool, &DownloaderPool::logMessage, this, &TaskQueue::logMessage);
+    connect(m_pool, &DownloaderPool::taskFinished, this, &TaskQueue::onTaskFinished);
+
+    // 后处理阶段与下载槽位分开，合并完成后才算任务结束
+    connect(m_postProcessor, &PostProcessor::logMessage, this, &TaskQueue::logMessage);
+    connect(m_postProcessor, &PostProcessor::finished, this, &TaskQueue::onPostProcessed);
+
+    // 暂存目录中的文件移动到保存路径后才算任务结束
+    connect(m_mover, &FileMover::logMessage, this, &TaskQueue::logMessage);
+    connect(m_mover, &FileMover::progress, this, &TaskQueue::taskMoveProgress);
+    connect(m_mover, &FileMover::finished, this, &TaskQueue::onMoved);
+
     qDebug() << "Max concurrent threads set to:" << maxConcurrent;
 }
 
 void TaskQueue::enqueue(const DownloadTask &task)
+{
+    // 主机键只在入队时解析一次，startNext 扫描队列时不再逐个解析 URL
+    DownloadTask queued = task;
+    if (queued.host.isEmpty()) {
+        queued.host = HostAdmission::hostOf(queued.video.url);
+    }
+
+    QMutexLocker locker(&m_mutex);
+    pending.push(queued);
+}
+
+bool TaskQueue::setTaskPriority(const QString &taskId, int priority)
 {
     QMutexLocker locker(&m_mutex);
-    pending.enqueue(task);
+    return pending.setPriority(taskId, priority);
+}
+
+bool TaskQueue::setTaskDeadline(const QString &taskId, const QDateTime &deadline)
+{
+    QMutexLocker locker(&m_mutex);
+    return pending.setDeadline(taskId, deadline);
+}
+
+bool TaskQueue::moveTaskToFront(const QString &taskId)
+{
+    QMutexLocker locker(&m_mutex);
+    return pending.moveToFront(taskId);
+}
+
+bool TaskQueue::removeTask(const QString &taskId)
+{
+    QMutexLocker locker(&m_mutex);
+    return pending.remove(taskId);
+}
+
+QStringList TaskQueue::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    const QStringList ids = pending.ids();
+    pending.clear();
+    return ids;
 }
 
 void TaskQueue::startQueue()
@@ -22,27 +105,66 @@ void TaskQueue::startQueue()
     {
         QMutexLocker locker(&m_mutex);
         paused = false;
+
+        // 恢复被挂起的下载，从暂停处继续
+        for (auto *downloader : std::as_const(m_suspended)) {
+            QMetaObject::invokeMethod(downloader, "resume", Qt::QueuedConnection);
+        }
+        m_suspended.clear();
     }
     startNext();
 }
 
 void TaskQueue::pauseQueue()
 {
+    QMutexLocker locker(&m_mutex);
+    paused = true;
+
+    const bool suspend = m_pauseMode == PauseMode::Suspend && VideoDownloader::canSuspend();
+    for (auto *downloader : running)
     {
-        QMutexLocker locker(&m_mutex);
-        paused = true;
+        if (!downloader || m_suspended.contains(downloader)) {
+            continue;
+        }
+
+        // 使用 QMetaObject::invokeMethod 确保在下载器所在线程中调用
+        if (suspend) {
+            m_suspended.insert(downloader);
+            QMetaObject::invokeMethod(downloader, "suspend", Qt::QueuedConnection);
+        } else {
+            // 结束进程后在 onTaskFinished 中放回队首，恢复时 yt-dlp 续传 .part 文件
+            m_interrupted.insert(downloader);
+            QMetaObject::invokeMethod(downloader, "cancel", Qt::QueuedConnection);
+        }
     }
+}
 
-    // 使用 QMetaObject::invokeMethod 在线程中安全调用 cancel
-    QMutexLocker locker(&m_mutex);
-    for (auto *downloader : running)
+void TaskQueue::stopQueue()
+{
     {
-        if (downloader)
+        QMutexLocker locker(&m_mutex);
+        paused = true;
+
+        // cancel() 会先恢复被挂起的进程组再结束进程
+        m_suspended.clear();
+        m_interrupted.clear();
+        for (auto *downloader : running)
         {
-            // 使用 QMetaObject::invokeMethod 确保在线程中调用
-            QMetaObject::invokeMethod(downloader, "cancel", Qt::QueuedConnection);
+            if (downloader)
+            {
+                QMetaObject::invokeMethod(downloader, "cancel", Qt::QueuedConnection);
+            }
         }
     }
+
+    // 等待后处理的任务一并取消（已下载的流文件保留）；在锁外发出结束信号
+    m_postProcessor->cancelAll();
+}
+
+void TaskQueue::setPauseMode(PauseMode mode)
+{
+    QMutexLocker locker(&m_mutex);
+    m_pauseMode = mode;
 }
 
 bool TaskQueue::isPaused() const
@@ -58,29 +180,249 @@ int TaskQueue::getTaskSize() const
 }
 
 void TaskQueue::setMaxConcurrent(int max)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        // 每次开始下载都会重新应用设置；自适应并发开启且线程数没变时保留它调整到的级别
+        if (m_adaptive && max == m_configuredMax) {
+            return;
+        }
+        m_configuredMax = max;
+        m_controller.reset(max);
+    }
+    applyConcurrency(max);
+}
+
+void TaskQueue::applyConcurrency(int max)
+{
+    bool grew = false;
+    bool shouldStartNext = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        grew = max > maxConcurrent;
+        maxConcurrent = max;
+        shouldStartNext = grew && !paused;
+    }
+
+    // 在线调整线程池大小：扩容时立即填充空闲槽位，缩容时多余线程在任务结束后回收
+    m_pool->resize(max);
+    qDebug() << "Max concurrent threads updated to:" << max;
+
+    if (shouldStartNext) {
+        QMetaObject::invokeMethod(this, "startNext", Qt::QueuedConnection);
+    }
+}
+
+void TaskQueue::setReactorMode(bool enabled)
+{
+    m_pool->setReactorMode(enabled);
+}
+
+void TaskQueue::setFairShare(bool enabled)
+{
+    QMutexLocker locker(&m_mutex);
+    pending.setFairShare(enabled);
+}
+
+void TaskQueue::setBatchSize(int size)
+{
+    QMutexLocker locker(&m_mutex);
+    m_batchSize = qMax(1, size);
+}
+
+void TaskQueue::setConnectionBudget(int connections)
+{
+    bool shouldStartNext = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_connectionBudget = qMax(0, connections);
+        shouldStartNext = !paused;
+    }
+
+    // 预算变大或关闭后可能有等待连接的任务可以启动
+    if (shouldStartNext) {
+        QMetaObject::invokeMethod(this, "startNext", Qt::QueuedConnection);
+    }
+}
+
+void TaskQueue::setStaging(const QString &directory, int moveJobs)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stagingDir = directory;
+    }
+    m_mover->setMaxJobs(moveJobs);
+}
+
+void TaskQueue::setShortestJobFirst(bool enabled)
 {
     QMutexLocker locker(&m_mutex);
-    maxConcurrent = max;
-    qDebug() << "Max concurrent threads updated to:" << maxConcurrent;
+    pending.setShortestJobFirst(enabled);
+}
+
+void TaskQueue::setHostLimits(int maxPerHost, double requestsPerSecond, int burst)
+{
+    bool shouldStartNext = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_admission.setMaxPerHost(maxPerHost);
+        m_admission.setRequestRate(requestsPerSecond, burst);
+        shouldStartNext = !paused;
+    }
+
+    // 放宽限制后可能有被阻塞的任务可以启动
+    if (shouldStartNext) {
+        QMetaObject::invokeMethod(this, "startNext", Qt::QueuedConnection);
+    }
+}
+
+void TaskQueue::setBandwidthLimit(qint64 bytesPerSecond)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        bytesPerSecond = qMax<qint64>(0, bytesPerSecond);
+        if (m_bandwidthLimit == bytesPerSecond) {
+            return;
+        }
+        m_bandwidthLimit = bytesPerSecond;
+    }
+    scheduleRebalance();
+}
+
+void TaskQueue::setAdaptiveConcurrency(bool enabled, int maxLevel)
+{
+    bool restore = false;
+    int configured = 0;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_controller.setRange(1, maxLevel);
+        if (enabled && !m_adaptive) {
+            m_controller.reset(maxConcurrent);
+            m_failures = 0;
+        }
+        // 关闭自适应时回到用户设置的线程数，不停留在控制器最后选择的级别
+        restore = !enabled && m_adaptive && maxConcurrent != m_configuredMax;
+        configured = m_configuredMax;
+        m_adaptive = enabled;
+    }
+
+    if (enabled) {
+        m_sampleTimer->start();
+    } else {
+        m_sampleTimer->stop();
+    }
+    if (restore) {
+        applyConcurrency(configured);
+    }
+}
+
+void TaskQueue::onProgressUpdated(VideoDownloader *downloader, const DownloadProgress &progress)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        // 已结束或已回收的下载器可能还有迟到的进度，忽略
+        if (!running.contains(downloader)) {
+            return;
+        }
+        m_speeds.insert(downloader, progress.speed);
+    }
+    emit taskProgress(progress);
+}
+
+void TaskQueue::sampleThroughput()
+{
+    int level = 0;
+    QString reason;
+    {
+        QMutexLocker locker(&m_mutex);
+        // 暂停或空闲时没有意义的样本，不参与评估
+        if (!m_adaptive || paused || running.isEmpty()) {
+            return;
+        }
+
+        qint64 throughput = 0;
+        for (qint64 speed : std::as_const(m_speeds)) {
+            throughput += speed;
+        }
+        bool saturated = !pending.isEmpty() && running.size() >= maxConcurrent;
+        int failures = m_failures;
+        m_failures = 0;
+
+        if (!m_controller.addSample(throughput, failures, saturated)) {
+            return;
+        }
+        level = m_controller.level();
+        reason = m_controller.reason();
+    }
+
+    applyConcurrency(level);
+    emit logMessage(QString("⚙️ 并发调整为 %1: %2").arg(level).arg(reason));
+    emit concurrencyChanged(level, reason);
 }
 
 void TaskQueue::onTaskFinished(VideoDownloader *downloader, const DownloadTask &task)
 {
-    // 从运行列表中移除（线程安全）
+    bool workerDone = false;
+    bool shouldRebalance = false;
+    bool requeued = false;
     {
         QMutexLocker locker(&m_mutex);
-        running.removeOne(downloader);
+
+        // 因暂停而被结束的任务放回队首，不算完成
+        if (m_interrupted.contains(downloader) && task.status == DownloadStatus::Canceled) {
+            DownloadTask resumable = task;
+            resumable.status = DownloadStatus::Success;
+            pending.pushFront(resumable);
+            requeued = true;
+        }
+        if (task.status == DownloadStatus::Failed) {
+            ++m_failures;
+        }
+
+        // 批量模式下一个进程对应多个任务，全部结束后才从运行列表中移除并释放主机槽位
+        auto it = m_outstanding.find(downloader);
+        if (it == m_outstanding.end() || --it.value() <= 0) {
+            if (it != m_outstanding.end()) {
+                m_outstanding.erase(it);
+            }
+            workerDone = true;
+            running.removeOne(downloader);
+            m_suspended.remove(downloader);
+            m_interrupted.remove(downloader);
+            m_admission.release(m_hosts.take(downloader));
+            shouldRebalance = m_rateShares.remove(downloader) > 0 && m_bandwidthLimit > 0;
+            m_speeds.remove(downloader);
+            m_connections.remove(downloader);
+        }
+    }
+
+    // 剩余任务可以分回这部分带宽
+    if (shouldRebalance) {
+        scheduleRebalance();
     }
     
-    // downloader 会在线程结束时自动删除（通过 connect(thread->finished, downloader->deleteLater)）
-    // 不需要在这里手动删除
+    // 下载器归还线程池复用，不再销毁线程
+    if (workerDone) {
+        m_pool->release(downloader);
+    }
 
     // 发射信号（使用 QueuedConnection 确保在主线程中处理）
-    emit taskFinished(task);
+    if (requeued) {
+        emit logMessage(QString("⏸️ 已暂停，恢复后继续下载: %1").arg(task.video.title));
+    } else if (task.status == DownloadStatus::Success && task.deferPostProcess && !task.files.isEmpty()) {
+        // 数据已下载完，合并等后处理在独立阶段进行，下载槽位已经释放
+        m_postProcessor->enqueue(task);
+    } else {
+        finishTask(task);
+    }
+
+    // 批量中的其他任务仍在下载，没有空出槽位
+    if (!workerDone) {
+        return;
+    }
 
     // 在锁外调用 startNext，避免死锁
     bool shouldStartNext = false;
-    bool shouldEmitAllFinished = false;
     
     {
         QMutexLocker locker(&m_mutex);
@@ -88,11 +430,6 @@ void TaskQueue::onTaskFinished(VideoDownloader *downloader, const DownloadTask &
         {
             shouldStartNext = true;
         }
-
-        if (pending.isEmpty() && running.isEmpty())
-        {
-            shouldEmitAllFinished = true;
-        }
     }
     
     // 使用 QMetaObject::invokeMethod 确保在主线程中执行
@@ -100,7 +437,51 @@ void TaskQueue::onTaskFinished(VideoDownloader *downloader, const DownloadTask &
         QMetaObject::invokeMethod(this, "startNext", Qt::QueuedConnection);
     }
     
-    if (shouldEmitAllFinished) {
+    checkAllFinished();
+}
+
+void TaskQueue::onPostProcessed(const DownloadTask &task)
+{
+    finishTask(task);
+    checkAllFinished();
+}
+
+void TaskQueue::onMoved(const DownloadTask &task)
+{
+    emit taskFinished(task);
+    checkAllFinished();
+}
+
+void TaskQueue::finishTask(const DownloadTask &task)
+{
+    // 下载到暂存目录的文件先移动到保存路径；失败的任务保留在暂存目录中
+    if (task.status == DownloadStatus::Success && !task.stagingPath.isEmpty()) {
+        if (!task.files.isEmpty()) {
+            m_mover->enqueue(task);
+            return;
+        }
+        // 暂存目录由所有任务共用，无法扫描出属于该任务的文件；
+        // 下载器没有报告文件时文件仍在暂存目录中，不能报告成功
+        DownloadTask failed = task;
+        failed.status = DownloadStatus::Failed;
+        emit logMessage(QString("❌ 下载器未报告文件，无法移出暂存目录 %1: %2")
+                            .arg(task.stagingPath, task.video.title));
+        emit taskFinished(failed);
+        return;
+    }
+    emit taskFinished(task);
+}
+
+void TaskQueue::checkAllFinished()
+{
+    bool shouldEmitAllFinished = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        shouldEmitAllFinished = pending.isEmpty() && running.isEmpty();
+    }
+
+    // 后处理阶段和移动只在 TaskQueue 所在线程中访问
+    if (shouldEmitAllFinished && m_postProcessor->isIdle() && m_mover->isIdle()) {
         emit allFinished();  // 信号本身就是线程安全的
     }
 }
@@ -111,56 +492,257 @@ void TaskQueue::startNext()
     while (true)
     {
         DownloadTask task;
+        QList<DownloadTask> batch;
         bool shouldStart = false;
         int currentRunning = 0;
+        QString host;
+        qint64 retryInMs = -1;
         
         {
             QMutexLocker locker(&m_mutex);
             if (paused || pending.isEmpty() || running.size() >= maxConcurrent) {
                 break;
             }
+            // 连接预算用完时等运行中的任务结束
+            if (m_connectionBudget > 0 && connectionsInUse() >= m_connectionBudget) {
+                break;
+            }
             
-            task = pending.dequeue();
-            shouldStart = true;
+            if (!m_admission.isEnabled()) {
+                task = pending.pop();
+                shouldStart = true;
+            } else {
+                // 按调度顺序找第一个主机可准入的任务，被限流的任务保留原位
+                const qint64 now = m_clock.elapsed();
+                QSet<QString> blocked;
+                shouldStart = pending.takeFirst([&](const DownloadTask &candidate) {
+                    if (blocked.contains(candidate.host)) {
+                        return false;
+                    }
+                    qint64 wait = -1;
+                    if (m_admission.tryAcquire(candidate.host, now, &wait)) {
+                        host = candidate.host;
+                        return true;
+                    }
+                    blocked.insert(candidate.host);
+                    if (wait > 0 && (retryInMs < 0 || wait < retryInMs)) {
+                        retryInMs = wait;
+                    }
+                    return false;
+                }, &task);
+            }
             currentRunning = running.size();
+
+            // 批量模式：把可以共用一个 yt-dlp 进程的后续任务一起取出（同站点、同保存路径和格式）
+            if (shouldStart) {
+                batch.append(task);
+                // 内置分段下载按单个任务执行，不参与批量
+                while (task.backend == DownloadBackend::YtDlp && batch.size() < m_batchSize) {
+                    // 只看队列前面的一部分，避免在很长的队列上反复扫描
+                    DownloadTask extra;
+                    bool found = pending.takeFirst([&](const DownloadTask &candidate) {
+                        return candidate.backend == DownloadBackend::YtDlp
+                            && candidate.savePath == task.savePath
+                            && candidate.video.formatId == task.video.formatId
+                            && candidate.host == task.host;
+                    }, &extra, kBatchScanLimit);
+                    if (!found) {
+                        break;
+                    }
+                    batch.append(extra);
+                }
+            }
         }
         
         if (!shouldStart) {
+            // 所有待处理任务的主机都被限制；若是限速则定时重试，并发上限则等任务结束
+            if (retryInMs > 0) {
+                QMetaObject::invokeMethod(m_retryTimer, [this, retryInMs]() {
+                    if (!m_retryTimer->isActive() || m_retryTimer->remainingTime() > retryInMs) {
+                        m_retryTimer->start(static_cast<int>(retryInMs));
+                    }
+                }, Qt::QueuedConnection);
+            }
             break;
         }
         
-        // 在锁外创建线程和下载器，避免长时间持有锁
-        QThread *thread = new QThread(this);
-        VideoDownloader *downloader = new VideoDownloader();
-        
-        // 将下载器移动到工作线程
-        downloader->moveToThread(thread);
-        
-        // 连接信号和槽
-        connect(thread, &QThread::started, [downloader, task]() {
-            downloader->start(task);
-        });
-        
-        // 使用 QueuedConnection 确保信号在主线程中处理
-        connect(downloader, &VideoDownloader::logMessage, this, &TaskQueue::logMessage, Qt::QueuedConnection);
-        connect(downloader, &VideoDownloader::taskFinished, this, [this, downloader, thread](VideoDownloader*, const DownloadTask &task) {
-            // 先通知任务完成（在主线程中处理）
-            onTaskFinished(downloader, task);
-            // 然后退出线程（在线程中调用）
-            QMetaObject::invokeMethod(thread, "quit", Qt::QueuedConnection);
-        }, Qt::QueuedConnection);
+        // 从线程池取出空闲的下载器（必要时新建工作线程）
+        VideoDownloader *downloader = m_pool->acquire();
+        if (!downloader) {
+            QMutexLocker locker(&m_mutex);
+            // 任务没有启动，槽位和令牌都要还回去
+            m_admission.refund(host);
+            // 倒序放回队首，保持原有顺序
+            for (auto it = batch.crbegin(); it != batch.crend(); ++it) {
+                pending.pushFront(*it);
+            }
+            break;
+        }
         
-        // 线程结束时清理（只清理线程，downloader 由线程清理）
-        connect(thread, &QThread::finished, thread, &QThread::deleteLater);
-        connect(thread, &QThread::finished, downloader, &VideoDownloader::deleteLater);
+        const QDateTime now = QDateTime::currentDateTime();
+        for (const DownloadTask &item : std::as_const(batch)) {
+            if (item.deadline.isValid() && item.deadline < now) {
+                emit logMessage(QString("⚠️ 任务已超过截止时间: %1").arg(item.video.title));
+            }
+        }
         
-        // 在锁外启动线程
-        thread->start();
+        // 新任务直接按启动后的份额限速（一个进程占一份）；运行中的任务立即降到同一份额，
+        // 否则在合并调整之前总带宽会超过上限。份额增加仍留给合并调整
+        qint64 share = 0;
+        int connections = 0;
+        QString stagingDir;
+        QList<QPair<VideoDownloader*, qint64>> shrunk;
+        {
+            QMutexLocker locker(&m_mutex);
+            share = bandwidthShare(running.size() + 1);
+            if (share > 0) {
+                for (auto *other : std::as_const(running)) {
+                    const qint64 current = m_rateShares.value(other);
+                    if (current == 0 || current > share) {
+                        m_rateShares.insert(other, share);
+                        shrunk.append(qMakePair(other, share));
+                    }
+                }
+            }
+            if (m_connectionBudget > 0) {
+                connections = connectionShare(task);
+            }
+            stagingDir = m_stagingDir;
+        }
+        for (DownloadTask &item : batch) {
+            item.rateLimit = share;
+            if (connections > 0) {
+                item.connections = connections;
+            }
+            // 派发时决定是否把合并等后处理留给后处理阶段
+            item.deferPostProcess = PostProcessor::shouldDefer(item);
+            item.stagingPath = stagingDir;
+        }
+        applyRateShares(shrunk);
+        if (connections > 1) {
+            emit logMessage(QString("🔀 %1 个并行连接: %2").arg(connections).arg(task.video.title));
+        }
+
+        if (batch.size() == 1) {
+            m_pool->dispatch(downloader, batch.first());
+        } else {
+            m_pool->dispatch(downloader, batch);
+            emit logMessage(QString("📦 批量下载 %1 个任务（%2）").arg(batch.size()).arg(task.host));
+        }
         
         // 快速添加 running 列表
         {
             QMutexLocker locker(&m_mutex);
             running.append(downloader);
+            m_outstanding.insert(downloader, batch.size());
+            if (m_admission.isEnabled()) {
+                m_hosts.insert(downloader, host);
+            }
+            m_rateShares.insert(downloader, share);
+            if (connections > 0) {
+                m_connections.insert(downloader, connections);
+            }
+        }
+
+        for (const DownloadTask &item : std::as_const(batch)) {
+            emit taskStarted(item);
+        }
+
+        if (share > 0) {
+            scheduleRebalance();
+        }
+    }
+}
+
+void TaskQueue::rebalanceBandwidth()
+{
+    QList<QPair<VideoDownloader*, qint64>> updates;
+    {
+        QMutexLocker locker(&m_mutex);
+        // 暂停期间不调整，恢复后有任务启动或结束时会再次分配
+        if (paused) {
+            return;
+        }
+        const qint64 share = bandwidthShare(running.size());
+        for (auto *downloader : running) {
+            qint64 current = m_rateShares.value(downloader);
+            if (current == share) {
+                continue;
+            }
+
+            // 份额增加不足 25% 时不重启，避免频繁打断下载；份额减少总是生效，否则总带宽会超过上限；
+            // 限速的开启/关闭也总是生效
+            if (current > 0 && share > current && share * 4 < current * 5) {
+                continue;
+            }
+
+            m_rateShares.insert(downloader, share);
+            updates.append(qMakePair(downloader, share));
         }
     }
+
+    applyRateShares(updates);
+}
+
+void TaskQueue::applyRateShares(const QList<QPair<VideoDownloader*, qint64>> &updates)
+{
+    for (const auto &update : updates) {
+        VideoDownloader *downloader = update.first;
+        qint64 share = update.second;
+        QMetaObject::invokeMethod(downloader, [downloader, share]() {
+            downloader->setRateLimit(share);
+        }, Qt::QueuedConnection);
+    }
+
+    if (!updates.isEmpty()) {
+        qint64 share = updates.first().second;
+        emit logMessage(QString("⚙️ 带宽重新分配: %1 个任务，%2")
+                            .arg(updates.size())
+                            .arg(share > 0 ? QString("每个 %1 KB/s").arg(share / 1024) : QString("不限速")));
+    }
+}
+
+qint64 TaskQueue::bandwidthShare(int runningCount) const
+{
+    // 调用方需持有 m_mutex
+    if (m_bandwidthLimit <= 0 || runningCount <= 0) {
+        return 0;
+    }
+    return qMax<qint64>(1, m_bandwidthLimit / runningCount);
+}
+
+int TaskQueue::connectionsInUse() const
+{
+    // 调用方需持有 m_mutex
+    int total = 0;
+    for (int connections : std::as_const(m_connections)) {
+        total += connections;
+    }
+    return total;
+}
+
+int TaskQueue::connectionShare(const DownloadTask &task) const
+{
+    // 调用方需持有 m_mutex；task 已从队列取出，尚未加入 running
+    if (TaskScheduler::estimatedCost(task) < kSingleConnectionBytes) {
+        return 1;
+    }
+
+    // 剩余预算平均分给现在就能启动的任务：队列里只有少数任务时每个任务分到更多连接，
+    // 任务很多时受并发上限约束，每个任务一个连接
+    const int available = qMax(1, m_connectionBudget - connectionsInUse());
+    const int startable = qMax(1, qMin(maxConcurrent - static_cast<int>(running.size()), pending.size() + 1));
+    // 内置分段下载器每个主机最多使用 maxSegments() 个连接，多分的连接留给其他任务
+    const int limit = task.backend == DownloadBackend::Native ? SegmentedDownloader::maxSegments() : kMaxTaskConnections;
+    return qBound(1, available / startable, limit);
+}
+
+void TaskQueue::scheduleRebalance()
+{
+    // 定时器属于 TaskQueue 所在线程，通过事件循环启动；已在计时时不重置，保证最长延迟固定
+    QMetaObject::invokeMethod(m_rebalanceTimer, [this]() {
+        if (!m_rebalanceTimer->isActive()) {
+            m_rebalanceTimer->start();
+        }
+    }, Qt::QueuedConnection);
 }
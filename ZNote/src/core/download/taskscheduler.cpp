@@ -0,0 +1,382 @@
+#include "core/download/taskscheduler.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+constexpr qint64 kNoDeadline = std::numeric_limits<qint64>::max();
+constexpr qint64 kUnknownCost = std::numeric_limits<qint64>::max();
+constexpr qint64 kNominalBytesPerSecond = 320 * 1024;  // 只有时长时按约 2.5 Mbps 估算大小
+}
+
+bool TaskScheduler::Key::operator<(const Key &other) const
+{
+    if (priority != other.priority) {
+        return priority > other.priority;  // 优先级高的在前
+    }
+    if (deadline != other.deadline) {
+        return deadline < other.deadline;  // 截止时间早的在前
+    }
+    if (cost != other.cost) {
+        return cost < other.cost;          // 短作业优先模式下预计越小越先
+    }
+    return sequence < other.sequence;      // 同级按入队顺序（FIFO）
+}
+
+TaskScheduler::TaskScheduler()
+    : m_cursor(0)
+    , m_size(0)
+    , m_backSequence(0)
+    , m_frontSequence(-1)
+    , m_fairShare(false)
+    , m_shortestJobFirst(false)
+{
+}
+
+void TaskScheduler::setFairShare(bool enabled)
+{
+    if (m_fairShare == enabled) {
+        return;
+    }
+    rebuild(enabled, m_shortestJobFirst);
+}
+
+bool TaskScheduler::isFairShare() const
+{
+    return m_fairShare;
+}
+
+void TaskScheduler::setShortestJobFirst(bool enabled)
+{
+    if (m_shortestJobFirst == enabled) {
+        return;
+    }
+    rebuild(m_fairShare, enabled);
+}
+
+bool TaskScheduler::isShortestJobFirst() const
+{
+    return m_shortestJobFirst;
+}
+
+qint64 TaskScheduler::estimatedCost(const DownloadTask &task)
+{
+    if (task.video.filesize > 0) {
+        return task.video.filesize;
+    }
+    if (task.video.duration > 0) {
+        return task.video.duration * kNominalBytesPerSecond;
+    }
+    return kUnknownCost;
+}
+
+void TaskScheduler::push(const DownloadTask &task)
+{
+    insert(makeKey(task, m_backSequence++), task);
+}
+
+void TaskScheduler::pushFront(const DownloadTask &task)
+{
+    insert(makeKey(task, m_frontSequence--), task);
+}
+
+DownloadTask TaskScheduler::pop()
+{
+    if (m_size == 0) {
+        return DownloadTask();
+    }
+
+    int groupIndex = nextGroupIndex();
+    Queue &queue = m_groups[m_rotation.at(groupIndex)];
+    return takeAt(groupIndex, queue.begin());
+}
+
+bool TaskScheduler::takeFirst(const std::function<bool(const DownloadTask &)> &accept, DownloadTask *task, int maxScan)
+{
+    if (m_size == 0) {
+        return false;
+    }
+
+    // 子队列的访问顺序与 pop() 一致：队首优先级高的在前，同级按轮转顺序
+    const int count = m_rotation.size();
+    QList<int> order;
+    order.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        order.append((m_cursor + i) % count);
+    }
+    // 非公平模式只有一个子队列，不需要排序
+    if (count > 1) {
+        std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+            return m_groups.find(m_rotation.at(a)).value().begin()->first.priority
+                 > m_groups.find(m_rotation.at(b)).value().begin()->first.priority;
+        });
+    }
+
+    // 限制扫描数量时，超出部分的任务不再交给谓词
+    int scanned = 0;
+    for (int groupIndex : order) {
+        Queue &queue = m_groups[m_rotation.at(groupIndex)];
+        for (auto it = queue.begin(); it != queue.end(); ++it) {
+            if (maxScan > 0 && scanned++ >= maxScan) {
+                return false;
+            }
+            if (accept(it->second)) {
+                *task = takeAt(groupIndex, it);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+const DownloadTask *TaskScheduler::peek() const
+{
+    if (m_size == 0) {
+        return nullptr;
+    }
+    const Queue &queue = m_groups.find(m_rotation.at(nextGroupIndex())).value();
+    return &queue.begin()->second;
+}
+
+bool TaskScheduler::isEmpty() const
+{
+    return m_size == 0;
+}
+
+int TaskScheduler::size() const
+{
+    return m_size;
+}
+
+int TaskScheduler::groupCount() const
+{
+    return m_rotation.size();
+}
+
+bool TaskScheduler::contains(const QString &taskId) const
+{
+    return m_index.contains(taskId);
+}
+
+QStringList TaskScheduler::ids() const
+{
+    return m_index.keys();
+}
+
+bool TaskScheduler::setPriority(const QString &taskId, int priority)
+{
+    DownloadTask task;
+    if (!take(taskId, task)) {
+        return false;
+    }
+
+    // 调整优先级后排到新优先级的队尾，保持同级 FIFO
+    task.priority = priority;
+    push(task);
+    return true;
+}
+
+bool TaskScheduler::setDeadline(const QString &taskId, const QDateTime &deadline)
+{
+    auto indexIt = m_index.constFind(taskId);
+    if (indexIt == m_index.constEnd()) {
+        return false;
+    }
+
+    // 截止时间变化不影响同级的入队顺序
+    qint64 sequence = indexIt.value().key.sequence;
+    DownloadTask task;
+    take(taskId, task);
+
+    task.deadline = deadline;
+    insert(makeKey(task, sequence), task);
+    return true;
+}
+
+bool TaskScheduler::moveToFront(const QString &taskId)
+{
+    DownloadTask task;
+    if (!take(taskId, task)) {
+        return false;
+    }
+
+    Key key = makeKey(task, m_frontSequence--);
+    if (m_size > 0) {
+        const Key &head = m_groups.find(m_rotation.at(nextGroupIndex())).value().begin()->first;
+        if (head.priority > key.priority) {
+            key.priority = head.priority;
+            task.priority = head.priority;
+        }
+        // 截止时间只提前排序键，不写回任务，否则没有截止时间的任务会被误报超时
+        key.deadline = qMin(key.deadline, head.deadline);
+        key.cost = qMin(key.cost, head.cost);
+    }
+
+    insert(key, task);
+
+    // 公平模式下让该任务所在的子队列下一个被轮到
+    int groupIndex = m_rotation.indexOf(groupOf(task));
+    if (groupIndex >= 0 && m_cursor < m_rotation.size()) {
+        int target = groupIndex < m_cursor ? m_cursor - 1 : m_cursor;
+        m_rotation.move(groupIndex, target);
+        m_cursor = target;
+    }
+    return true;
+}
+
+bool TaskScheduler::remove(const QString &taskId)
+{
+    DownloadTask task;
+    return take(taskId, task);
+}
+
+void TaskScheduler::clear()
+{
+    m_groups.clear();
+    m_rotation.clear();
+    m_index.clear();
+    m_cursor = 0;
+    m_size = 0;
+}
+
+TaskScheduler::Key TaskScheduler::makeKey(const DownloadTask &task, qint64 sequence) const
+{
+    Key key;
+    key.priority = task.priority;
+    key.deadline = task.deadline.isValid() ? task.deadline.toMSecsSinceEpoch() : kNoDeadline;
+    key.cost = m_shortestJobFirst ? estimatedCost(task) : 0;
+    key.sequence = sequence;
+    return key;
+}
+
+QString TaskScheduler::groupOf(const DownloadTask &task) const
+{
+    return m_fairShare ? task.groupId : QString();
+}
+
+int TaskScheduler::nextGroupIndex() const
+{
+    // 从轮转游标开始，选择队首优先级最高的子队列；同级时按轮转顺序
+    const int count = m_rotation.size();
+    int best = -1;
+    int bestPriority = 0;
+    for (int i = 0; i < count; ++i) {
+        int index = (m_cursor + i) % count;
+        const Queue &queue = m_groups.find(m_rotation.at(index)).value();
+        int priority = queue.begin()->first.priority;
+        if (best < 0 || priority > bestPriority) {
+            best = index;
+            bestPriority = priority;
+        }
+    }
+    return best;
+}
+
+DownloadTask TaskScheduler::takeAt(int groupIndex, Queue::iterator it)
+{
+    Queue &queue = m_groups[m_rotation.at(groupIndex)];
+    DownloadTask task = it->second;
+
+    m_index.remove(task.id);
+    queue.erase(it);
+    --m_size;
+
+    // 轮转到下一个子队列
+    m_cursor = groupIndex + 1;
+    dropGroupIfEmpty(groupIndex);
+    return task;
+}
+
+void TaskScheduler::rebuild(bool fairShare, bool shortestJobFirst)
+{
+    // 按新的规则重建子队列，保留每个任务原有的排序键，只重新计算作业大小
+    QHash<QString, Queue> groups;
+    QStringList rotation = m_rotation;
+    groups.swap(m_groups);
+    m_rotation.clear();
+    m_index.clear();
+    m_cursor = 0;
+    m_size = 0;
+    m_fairShare = fairShare;
+    m_shortestJobFirst = shortestJobFirst;
+
+    for (const QString &group : rotation) {
+        const Queue &queue = groups.find(group).value();
+        for (const auto &entry : queue) {
+            Key key = entry.first;
+            key.cost = m_shortestJobFirst ? estimatedCost(entry.second) : 0;
+            insert(key, entry.second);
+        }
+    }
+}
+
+void TaskScheduler::insert(const Key &key, const DownloadTask &task)
+{
+    // 同一 ID 重复入队时替换旧条目，否则旧条目失去索引，再也无法删除或调整
+    DownloadTask previous;
+    take(task.id, previous);
+
+    QString group = groupOf(task);
+    auto groupIt = m_groups.find(group);
+    if (groupIt == m_groups.end()) {
+        // 新的子队列插在游标处，下一轮立即被服务，缩短新提交的首个文件等待时间
+        groupIt = m_groups.insert(group, Queue());
+        m_rotation.insert(qMin(m_cursor, m_rotation.size()), group);
+    }
+
+    groupIt.value().emplace(key, task);
+    m_index.insert(task.id, Position{group, key});
+    ++m_size;
+}
+
+bool TaskScheduler::take(const QString &taskId, DownloadTask &task)
+{
+    auto indexIt = m_index.find(taskId);
+    if (indexIt == m_index.end()) {
+        return false;
+    }
+
+    Position position = indexIt.value();
+    m_index.erase(indexIt);
+
+    auto groupIt = m_groups.find(position.group);
+    if (groupIt == m_groups.end()) {
+        return false;
+    }
+    auto it = groupIt.value().find(position.key);
+    if (it == groupIt.value().end()) {
+        return false;
+    }
+
+    task = it->second;
+    groupIt.value().erase(it);
+    --m_size;
+    dropGroupIfEmpty(m_rotation.indexOf(position.group));
+    return true;
+}
+
+void TaskScheduler::dropGroupIfEmpty(int groupIndex)
+{
+    if (groupIndex < 0 || groupIndex >= m_rotation.size()) {
+        return;
+    }
+
+    const QString group = m_rotation.at(groupIndex);
+    auto groupIt = m_groups.find(group);
+    if (groupIt != m_groups.end() && !groupIt.value().empty()) {
+        if (m_cursor >= m_rotation.size()) {
+            m_cursor = 0;
+        }
+        return;
+    }
+
+    if (groupIt != m_groups.end()) {
+        m_groups.erase(groupIt);
+    }
+    m_rotation.removeAt(groupIndex);
+    if (groupIndex < m_cursor) {
+        --m_cursor;
+    }
+    if (m_cursor >= m_rotation.size()) {
+        m_cursor = 0;
+    }
+}
@@ -0,0 +1,278 @@
+#include "core/download/toolregistry.h"
+#include "utils/logger.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QStringList>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+namespace {
+constexpr int kToolCount = 3;
+constexpr int kProbeTimeoutMs = 15000;  // 首次启动 yt-dlp（PyInstaller 解包）可能需要数秒
+
+struct Registry
+{
+    QMutex mutex;
+    QWaitCondition changed;
+    ToolRegistry::Overrides overrides;
+    bool configured = false;
+    quint64 generation = 0;             // 每次重新查找加一，丢弃过期的结果
+    bool located = false;               // 路径已确定
+    bool probed = false;                // 版本和能力已探测
+    ToolRegistry::ToolInfo tools[kToolCount];
+};
+
+Registry &registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+int toolIndex(ToolRegistry::Tool tool)
+{
+    return static_cast<int>(tool);
+}
+
+QString configuredPath(const ToolRegistry::Overrides &overrides, ToolRegistry::Tool tool)
+{
+    switch (tool) {
+    case ToolRegistry::Tool::Ffmpeg:
+        return overrides.ffmpeg;
+    case ToolRegistry::Tool::Aria2c:
+        return overrides.aria2c;
+    case ToolRegistry::Tool::YtDlp:
+        break;
+    }
+    return overrides.ytdlp;
+}
+
+QString locate(ToolRegistry::Tool tool, const QString &configured)
+{
+    if (!configured.isEmpty()) {
+        const QFileInfo info(configured);
+        if (info.isFile() && info.isExecutable()) {
+            return info.absoluteFilePath();
+        }
+        const QString found = QStandardPaths::findExecutable(configured);
+        if (!found.isEmpty()) {
+            return found;
+        }
+        LOG_WARNING(QString("Configured %1 not found: %2, searching default locations")
+                        .arg(ToolRegistry::name(tool), configured));
+    }
+
+    // 先找随程序发布的版本（程序目录和项目 bin 目录），再找 PATH
+    const QString name = ToolRegistry::name(tool);
+    const QDir appDir(QCoreApplication::applicationDirPath());
+    const QStringList candidates = {appDir.filePath(name + ".exe"), appDir.filePath(name),
+                                    appDir.absoluteFilePath("../bin/" + name + ".exe"),
+                                    appDir.absoluteFilePath("../bin/" + name)};
+    for (const QString &candidate : candidates) {
+        const QFileInfo info(candidate);
+        if (info.isFile() && info.isExecutable()) {
+            return info.absoluteFilePath();
+        }
+    }
+    return QStandardPaths::findExecutable(name);
+}
+
+// 运行一次工具并返回标准输出；超时或启动失败时返回空
+QString runProbe(const QString &program, const QStringList &args)
+{
+    QProcess process;
+    process.start(program, args);
+    if (!process.waitForFinished(kProbeTimeoutMs)) {
+        process.kill();
+        process.waitForFinished();
+        return QString();
+    }
+    return QString::fromLocal8Bit(process.readAllStandardOutput());
+}
+
+void probe(ToolRegistry::Tool tool, ToolRegistry::ToolInfo *info)
+{
+    if (!info->isAvailable()) {
+        return;
+    }
+
+    switch (tool) {
+    case ToolRegistry::Tool::YtDlp:
+        info->version = runProbe(info->path, {"--version"}).trimmed();
+        break;
+    case ToolRegistry::Tool::Ffmpeg: {
+        // 第一行：ffmpeg version <版本> Copyright ...
+        const QString banner = runProbe(info->path, {"-hide_banner", "-version"}).section('\n', 0, 0);
+        info->version = banner.section(' ', 2, 2);
+        // 编码器列表：" V....D libx264   描述"，跳过 "------" 之前的说明
+        const QStringList lines = runProbe(info->path, {"-hide_banner", "-encoders"}).split('\n');
+        bool listed = false;
+        for (const QString &line : lines) {
+            const QString trimmed = line.trimmed();
+            if (trimmed.startsWith("------")) {
+                listed = true;
+            } else if (listed && !trimmed.isEmpty()) {
+                info->capabilities.insert(trimmed.section(' ', 1, 1, QString::SectionSkipEmpty));
+            }
+        }
+        break;
+    }
+    case ToolRegistry::Tool::Aria2c: {
+        // 第一行：aria2 version <版本>；"Enabled Features: Async DNS, BitTorrent, ..."
+        const QStringList lines = runProbe(info->path, {"--version"}).split('\n');
+        if (!lines.isEmpty()) {
+            info->version = lines.first().section(' ', 2, 2).trimmed();
+        }
+        for (const QString &line : lines) {
+            if (line.startsWith("Enabled Features:")) {
+                const QStringList features = line.section(':', 1).split(',', Qt::SkipEmptyParts);
+                for (const QString &feature : features) {
+                    info->capabilities.insert(feature.trimmed());
+                }
+            }
+        }
+        break;
+    }
+    }
+}
+
+void discover(const ToolRegistry::Overrides &overrides, quint64 generation)
+{
+    ToolRegistry::ToolInfo found[kToolCount];
+    const ToolRegistry::Tool tools[kToolCount] = {ToolRegistry::Tool::YtDlp, ToolRegistry::Tool::Ffmpeg,
+                                                  ToolRegistry::Tool::Aria2c};
+    for (ToolRegistry::Tool tool : tools) {
+        found[toolIndex(tool)].path = locate(tool, configuredPath(overrides, tool));
+    }
+
+    // 路径先发布，启动下载不必等待版本探测
+    Registry &state = registry();
+    {
+        QMutexLocker locker(&state.mutex);
+        if (generation != state.generation) {
+            return;
+        }
+        for (int i = 0; i < kToolCount; ++i) {
+            state.tools[i] = found[i];
+        }
+        state.located = true;
+        state.changed.wakeAll();
+    }
+
+    for (ToolRegistry::Tool tool : tools) {
+        ToolRegistry::ToolInfo &info = found[toolIndex(tool)];
+        probe(tool, &info);
+        if (info.isAvailable()) {
+            LOG_INFO(QString("Found %1 %2 at %3").arg(ToolRegistry::name(tool), info.version, info.path));
+        } else {
+            LOG_WARNING(QString("%1 not found").arg(ToolRegistry::name(tool)));
+        }
+    }
+
+    QMutexLocker locker(&state.mutex);
+    if (generation != state.generation) {
+        return;
+    }
+    for (int i = 0; i < kToolCount; ++i) {
+        state.tools[i] = found[i];
+    }
+    state.probed = true;
+    state.changed.wakeAll();
+}
+
+// 未配置时按默认设置开始查找；调用时持有锁
+void ensureConfigured(QMutexLocker<QMutex> &locker)
+{
+    Registry &state = registry();
+    if (state.configured) {
+        return;
+    }
+    locker.unlock();
+    ToolRegistry::configure(ToolRegistry::Overrides());
+    locker.relock();
+}
+}
+
+void ToolRegistry::configure(const Overrides &overrides)
+{
+    Registry &state = registry();
+    quint64 generation = 0;
+    {
+        QMutexLocker locker(&state.mutex);
+        if (state.configured && state.overrides == overrides) {
+            return;
+        }
+        state.configured = true;
+        state.overrides = overrides;
+        generation = ++state.generation;
+        state.located = false;
+        state.probed = false;
+    }
+
+    QThreadPool::globalInstance()->start([overrides, generation]() {
+        discover(overrides, generation);
+    });
+}
+
+QString ToolRegistry::path(Tool tool)
+{
+    Registry &state = registry();
+    QMutexLocker locker(&state.mutex);
+    ensureConfigured(locker);
+    while (!state.located) {
+        state.changed.wait(&state.mutex);
+    }
+    const QString found = state.tools[toolIndex(tool)].path;
+    return found.isEmpty() ? name(tool) : found;
+}
+
+bool ToolRegistry::isAvailable(Tool tool)
+{
+    Registry &state = registry();
+    QMutexLocker locker(&state.mutex);
+    ensureConfigured(locker);
+    while (!state.located) {
+        state.changed.wait(&state.mutex);
+    }
+    return state.tools[toolIndex(tool)].isAvailable();
+}
+
+ToolRegistry::ToolInfo ToolRegistry::info(Tool tool)
+{
+    Registry &state = registry();
+    QMutexLocker locker(&state.mutex);
+    ensureConfigured(locker);
+    while (!state.probed) {
+        state.changed.wait(&state.mutex);
+    }
+    return state.tools[toolIndex(tool)];
+}
+
+bool ToolRegistry::tryInfo(Tool tool, ToolInfo *info)
+{
+    Registry &state = registry();
+    QMutexLocker locker(&state.mutex);
+    ensureConfigured(locker);
+    if (!state.probed) {
+        return false;
+    }
+    *info = state.tools[toolIndex(tool)];
+    return true;
+}
+
+QString ToolRegistry::name(Tool tool)
+{
+    switch (tool) {
+    case Tool::Ffmpeg:
+        return "ffmpeg";
+    case Tool::Aria2c:
+        return "aria2c";
+    case Tool::YtDlp:
+        break;
+    }
+    return "yt-dlp";
+}
@@ -1,61 +1,57 @@
 #include "core/download/urlparser.h"
+#include "core/download/ytdlphelper.h"
+#include "core/download/processpolicy.h"
+#include "core/download/toolregistry.h"
+#include "core/download/parsecache.h"
+#include "core/download/infojsonextractor.h"
 #include "utils/logger.h"
-#include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
-#include <QStandardPaths>
-#include <QDir>
-#include <QCoreApplication>
 #include <QDebug>
 
+namespace {
+constexpr int kLineCapacity = 64 * 1024;
+constexpr int kMaxLineCapacity = 64 * 1024 * 1024; // 单个视频信息可能有数 MB
+}
+
 UrlParser::UrlParser(QObject *parent)
     : QObject(parent)
     , m_process(new QProcess(this))
     , m_isRunning(false)
+    , m_pending(false)
     , m_hasParsedEntries(false)
+    , m_helper(nullptr)
+    , m_helperJobCount(0)
+    , m_usingHelper(false)
+    , m_helperUnavailable(false)
+    , m_cache(nullptr)
+    , m_revalidate(false)
+    , m_revalidating(false)
+    , m_flatPlaylist(false)
+    , m_stdout(kLineCapacity, kMaxLineCapacity)
+    , m_generation(0)
+    , m_decodePending(0)
+    , m_decodeFailures(0)
+    , m_processFinished(false)
+    , m_exitCode(0)
+    , m_exitStatus(QProcess::NormalExit)
 {
-    // 先连接信号（必须在所有return之前）
+    // 只用一个线程，解码批次按提交顺序完成，条目顺序与输出一致
+    m_decoder.setMaxThreadCount(1);
+
+    // 连接进程信号
     connect(m_process, &QProcess::finished, this, &UrlParser::onProcessFinished);
     connect(m_process, &QProcess::errorOccurred, this, &UrlParser::onProcessError);
     connect(m_process, &QProcess::readyReadStandardOutput, this, &UrlParser::onStandardOutput);
     connect(m_process, &QProcess::readyReadStandardError, this, &UrlParser::onStandardError);
-    
-    // 查找yt-dlp可执行文件
-    QStringList possiblePaths;
-    
-    // 1. 检查项目bin目录
-    QString appDir = QCoreApplication::applicationDirPath();
-    QString binPath = QDir(appDir).filePath("yt-dlp.exe");
-    if (QFile::exists(binPath)) {
-        m_program = binPath;
-        LOG_INFO(QString("Found yt-dlp at: %1").arg(m_program));
-        return;
-    }
-    
-    // 2. 检查系统PATH
-    QString systemPath = QStandardPaths::findExecutable("yt-dlp.exe");
-    if (!systemPath.isEmpty()) {
-        m_program = systemPath;
-        LOG_INFO(QString("Found yt-dlp in PATH: %1").arg(m_program));
-        return;
-    }
-    
-    // 3. 尝试不带.exe后缀（Linux/Mac）
-    systemPath = QStandardPaths::findExecutable("yt-dlp");
-    if (!systemPath.isEmpty()) {
-        m_program = systemPath;
-        LOG_INFO(QString("Found yt-dlp in PATH: %1").arg(m_program));
-        return;
-    }
-    
-    // 默认值
-    m_program = "yt-dlp.exe";
-    LOG_WARNING("yt-dlp not found, will try to use: yt-dlp.exe");
 }
 
 UrlParser::~UrlParser()
 {
     cancel();
+    // 解码任务引用 this，必须在析构完成前结束
+    m_decoder.clear();
+    m_decoder.waitForDone();
 }
 
 void UrlParser::parse(const QString &url)
@@ -67,27 +63,128 @@ void UrlParser::parse(const QString &url)
     
     if (!isValidUrl(url)) {
         emit errorOccurred("Invalid URL format");
+        emit finished();
         return;
     }
     
-    m_isRunning = true;
     m_hasParsedEntries = false;  // 重置标志
+    ++m_generation;
+    m_decodePending = 0;
+    m_decodeFailures = 0;
+    m_processFinished = false;
+    m_stdout.clear();
+    m_currentUrl = url;
+    m_collected.clear();
+    m_delivered.clear();
+    m_revalidating = false;
+    
+    // 命中缓存时立即发送，不再启动 yt-dlp；过期的结果按配置先发送，再在后台重新解析
+    if (m_cache) {
+        QList<ParsedEntry> cached;
+        const ParseCache::Lookup result = m_cache->lookup(url, &cached);
+        if (result == ParseCache::Lookup::Fresh || (result == ParseCache::Lookup::Stale && m_revalidate)) {
+            for (const ParsedEntry &entry : std::as_const(cached)) {
+                m_delivered.insert(entry.id);
+                emit entryParsed(entry);
+            }
+            log(QString("Loaded %1 entries from parse cache").arg(cached.size()));
+            if (result == ParseCache::Lookup::Fresh) {
+                emit finished();
+                return;
+            }
+            m_revalidating = true;
+            log("Cached entries are stale, revalidating in background");
+        }
+    }
     
+    m_isRunning = true;
+    m_pending = true;
+    
+    // 启用助手时复用常驻进程，省去每次解析启动 yt-dlp 的开销
+    m_usingHelper = YtDlpHelper::settings().enabled && !m_helperUnavailable && startHelper(url);
+    if (!m_usingHelper) {
+        startProcess(url);
+    }
+}
+
+void UrlParser::startProcess(const QString &url)
+{
     QStringList arguments;
     arguments << "--dump-json";
+    if (m_flatPlaylist) {
+        // 只列出播放列表中的 ID、标题和链接，几秒内即可返回；单个视频仍然完整解析
+        arguments << "--flat-playlist";
+    }
     // 移除 --no-playlist，允许解析播放列表
     // 如果URL是播放列表，yt-dlp会返回JSON数组
     arguments << url;
     
+    // yt-dlp 路径由 ToolRegistry 在启动时查找并缓存
+    m_program = ToolRegistry::path(ToolRegistry::Tool::YtDlp);
     log(QString("Starting yt-dlp parse: %1").arg(url));
+    ProcessPolicy::apply(m_process, ProcessPolicy::Stage::Parse);
     m_process->start(m_program, arguments);
     
     // 不等待启动，避免阻塞UI线程
     // QProcess::start() 是异步的，错误会通过 errorOccurred 信号通知
 }
 
+bool UrlParser::startHelper(const QString &url)
+{
+    if (m_helper == nullptr) {
+        m_helper = new YtDlpHelper(this);
+        m_helper->setStage(ProcessPolicy::Stage::Parse);
+        connect(m_helper, &YtDlpHelper::eventReceived, this, &UrlParser::onHelperEvent);
+        connect(m_helper, &YtDlpHelper::logMessage, this, &UrlParser::log);
+        connect(m_helper, &YtDlpHelper::failed, this, &UrlParser::onHelperFailed);
+    }
+    if (!m_helper->start()) {
+        m_helperUnavailable = true;
+        log("yt-dlp helper unavailable, falling back to yt-dlp process");
+        return false;
+    }
+
+    // 请求 ID 用于丢弃已取消请求的迟到事件
+    m_helperJob = QString("parse-%1").arg(++m_helperJobCount);
+    QJsonObject request;
+    request["id"] = m_helperJob;
+    request["op"] = "extract";
+    request["url"] = url;
+    if (m_flatPlaylist) {
+        request["flat"] = true;
+    }
+    m_helper->send(request);
+
+    log(QString("Sent parse request to yt-dlp helper: %1").arg(url));
+    return true;
+}
+
+void UrlParser::setCache(ParseCache *cache, bool revalidate)
+{
+    m_cache = cache;
+    m_revalidate = revalidate;
+}
+
+void UrlParser::setFlatPlaylist(bool flat)
+{
+    m_flatPlaylist = flat;
+}
+
 void UrlParser::cancel()
 {
+    // 取消的解析不再发出 finished，尚未返回的解码结果也一并丢弃
+    m_pending = false;
+    ++m_generation;
+    m_decodePending = 0;
+    m_processFinished = false;
+    m_decoder.clear();
+    if (m_isRunning && m_usingHelper) {
+        // extract_info 无法中途打断，直接结束助手，下次解析时重新启动
+        m_helper->kill();
+        m_isRunning = false;
+        log("Parser cancelled");
+        return;
+    }
     if (m_isRunning && m_process->state() != QProcess::NotRunning) {
         m_process->kill();
         // 不等待完成，避免阻塞UI线程
@@ -103,58 +200,76 @@ void UrlParser::onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
     
     log(QString("Process finished with exit code: %1, status: %2").arg(exitCode).arg(exitStatus));
     
-    if (exitStatus == QProcess::CrashExit) {
+    // 读取剩余输出；最后一行可能没有换行符
+    onStandardOutput();
+    QByteArrayView tail;
+    if (m_stdout.takeRemainder(&tail) && !tail.trimmed().isEmpty()) {
+        queueDecode({tail.toByteArray()});
+    }
+    
+    m_exitCode = exitCode;
+    m_exitStatus = exitStatus;
+    m_processFinished = true;
+    // 等所有输出行解码完成后再判断结果，保证条目都先于 finished 发出
+    if (m_decodePending == 0) {
+        completeProcess();
+    }
+}
+
+void UrlParser::completeProcess()
+{
+    m_processFinished = false;
+    
+    if (m_exitStatus == QProcess::CrashExit) {
         QString errorMsg = "yt-dlp process crashed";
         log(errorMsg);
-        emit errorOccurred(errorMsg);
+        reportError(errorMsg);
+        finishParse();
         return;
     }
     
-    if (exitCode != 0) {
+    if (m_exitCode != 0) {
         // 读取错误输出
         QByteArray errorOutput = m_process->readAllStandardError();
-        QString errorMsg = QString("yt-dlp exited with code: %1").arg(exitCode);
+        QString errorMsg = QString("yt-dlp exited with code: %1").arg(m_exitCode);
         if (!errorOutput.isEmpty()) {
             errorMsg += QString("\nError output: %1").arg(QString::fromUtf8(errorOutput));
         }
         log(errorMsg);
-        emit errorOccurred(errorMsg);
+        reportError(errorMsg);
+        finishParse();
         return;
     }
     
-    // 读取标准输出（可能包含多行JSON，每行一个JSON对象，用于播放列表）
-    QByteArray output = m_process->readAllStandardOutput();
-    
-    // 如果已经通过流式读取解析了条目，且输出为空，说明已经处理完毕，不需要报错
-    if (output.isEmpty() && m_hasParsedEntries) {
-        log("Process finished: All entries were already parsed via stream reading");
-        return;  // 正常完成，不报错
-    }
-    
-    if (output.isEmpty()) {
+    if (!m_hasParsedEntries) {
+        if (m_decodeFailures > 0) {
+            reportError("Failed to parse yt-dlp output");
+            finishParse();
+            return;
+        }
         // 也检查错误输出，可能信息在那里
         QByteArray errorOutput = m_process->readAllStandardError();
         if (!errorOutput.isEmpty()) {
             log(QString("No stdout, but stderr: %1").arg(QString::fromUtf8(errorOutput)));
-            emit errorOccurred(QString("yt-dlp error: %1").arg(QString::fromUtf8(errorOutput)));
+            reportError(QString("yt-dlp error: %1").arg(QString::fromUtf8(errorOutput)));
         } else {
-            emit errorOccurred("No output from yt-dlp");
+            reportError("No output from yt-dlp");
         }
+        finishParse();
         return;
     }
     
-    log(QString("Received %1 bytes from yt-dlp").arg(output.size()));
-    
-    // yt-dlp 对于播放列表，可能返回多行JSON（每行一个JSON对象）
-    // 或者返回单个JSON数组
-    QString outputStr = QString::fromUtf8(output);
-    parseOutput(outputStr);
+    // 发送批量信号（保留用于兼容性）；重新验证时条目已从缓存发送过
+    if (!m_revalidating) {
+        emit urlParsed(m_collected);
+    }
+    log(QString("Parsed %1 entries").arg(m_collected.size()));
+    storeResults();
+    finishParse();
 }
 
 void UrlParser::onProcessError(QProcess::ProcessError error)
 {
-    m_isRunning = false;
-    
     QString errorMsg;
     switch (error) {
         case QProcess::FailedToStart:
@@ -176,33 +291,86 @@ void UrlParser::onProcessError(QProcess::ProcessError error)
             errorMsg = QString("Unknown error: %1").arg(error);
     }
     
-    emit errorOccurred(errorMsg);
+    // 除启动失败外，进程随后还会发出 finished，由 onProcessFinished 报告错误，避免同一次解析报告两次
+    if (error != QProcess::FailedToStart) {
+        log(errorMsg);
+        return;
+    }
+    
+    m_isRunning = false;
+    reportError(errorMsg);
+    finishParse();
 }
 
 void UrlParser::onStandardOutput()
 {
-    // 流式读取输出，每读取一行就解析并发送（生产者-消费者模式）
-    while (m_process->canReadLine()) {
-        QByteArray line = m_process->readLine();
-        QString lineStr = QString::fromUtf8(line).trimmed();
-        
-        if (lineStr.isEmpty()) {
-            continue;
+    // GUI 线程只切分行，JSON 解码交给后台线程（生产者-消费者模式）
+    QList<QByteArray> lines;
+    while (m_stdout.readFrom(m_process) > 0) {
+        QByteArrayView line;
+        while (m_stdout.nextLine(&line)) {
+            line = line.trimmed();
+            if (!line.isEmpty()) {
+                lines.append(line.toByteArray());
+            }
         }
-        
-        // 尝试解析这一行（可能是JSON对象）
-        QJsonParseError error;
-        QJsonDocument doc = QJsonDocument::fromJson(lineStr.toUtf8(), &error);
-        
-        if (error.error == QJsonParseError::NoError && doc.isObject()) {
-            ParsedEntry entry = parseSingleEntry(doc.object());
+    }
+    queueDecode(lines);
+}
+
+void UrlParser::queueDecode(const QList<QByteArray> &lines)
+{
+    if (lines.isEmpty()) {
+        return;
+    }
+    ++m_decodePending;
+    const quint64 generation = m_generation;
+    m_decoder.start([this, lines, generation]() {
+        // 只提取 parseSingleEntry 用到的字段，不构造完整的 QJsonDocument
+        QList<ParsedEntry> entries;
+        int failures = 0;
+        for (const QByteArray &line : lines) {
+            QJsonObject info;
+            if (!InfoJsonExtractor::extract(line, &info)) {
+                ++failures;
+                continue;
+            }
+            ParsedEntry entry = parseSingleEntry(info);
             if (!entry.vid.isEmpty()) {
-                // 立即发送单个条目信号（生产者-消费者模式）
-                emit entryParsed(entry);
-                m_hasParsedEntries = true;  // 标记已解析条目
-                log(QString("Parsed entry: %1").arg(entry.title));
+                entries.append(entry);
             }
         }
+        QMetaObject::invokeMethod(this, [this, entries, failures, generation]() {
+            onDecoded(entries, failures, generation);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void UrlParser::onDecoded(const QList<ParsedEntry> &entries, int failures, quint64 generation)
+{
+    // 已取消或已开始新的解析
+    if (generation != m_generation) {
+        return;
+    }
+    --m_decodePending;
+    
+    for (const ParsedEntry &entry : entries) {
+        // 立即发送单个条目信号
+        deliverEntry(entry);
+    }
+    // 大播放列表每批一行日志，不再每个条目一行
+    if (entries.size() == 1) {
+        log(QString("Parsed entry: %1").arg(entries.first().title));
+    } else if (!entries.isEmpty()) {
+        log(QString("Parsed %1 entries, last: %2").arg(entries.size()).arg(entries.last().title));
+    }
+    if (failures > 0) {
+        m_decodeFailures += failures;
+        log(QString("Skipped %1 unparsable output line(s)").arg(failures));
+    }
+    
+    if (m_processFinished && m_decodePending == 0) {
+        completeProcess();
     }
 }
 
@@ -213,107 +381,65 @@ void UrlParser::onStandardError()
     log(QString("yt-dlp stderr: %1").arg(errorStr));
 }
 
-void UrlParser::parseOutput(const QString &output)
+void UrlParser::onHelperEvent(const QJsonObject &event)
 {
-    QList<ParsedEntry> entries = parseJsonOutput(output);
-    
-    if (entries.isEmpty()) {
-        emit errorOccurred("Failed to parse yt-dlp output");
+    if (!m_isRunning || event["id"].toString() != m_helperJob) {
         return;
     }
-    
-    // 发送批量信号（保留用于兼容性）
-    emit urlParsed(entries);
-    log(QString("Parsed %1 entries").arg(entries.size()));
-}
 
-QList<ParsedEntry> UrlParser::parseJsonOutput(const QString &jsonOutput)
-{
-    QList<ParsedEntry> entries;
-    
-    if (jsonOutput.trimmed().isEmpty()) {
-        log("JSON output is empty");
-        return entries;
-    }
-    
-    // yt-dlp 对于播放列表，可能返回：
-    // 1. 多行JSON（每行一个JSON对象）- 可以逐行解析并立即发送
-    // 2. 单个JSON数组 - 需要解析后逐个发送
-    // 3. 单个JSON对象（单个视频）- 可以立即解析并发送
-    
-    QStringList lines = jsonOutput.split('\n', Qt::SkipEmptyParts);
-    
-    // 如果只有一行，尝试解析为JSON数组或对象
-    if (lines.size() == 1) {
-        QJsonParseError error;
-        QJsonDocument doc = QJsonDocument::fromJson(jsonOutput.toUtf8(), &error);
-        
-        if (error.error != QJsonParseError::NoError) {
-            log(QString("JSON parse error: %1 at position %2").arg(error.errorString()).arg(error.offset));
-            log(QString("JSON content: %1").arg(jsonOutput.left(500))); // 只显示前500字符
-            return entries;
+    const QString type = event["event"].toString();
+    if (type == "info") {
+        // 与 --dump-json 的逐行输出相同：每个视频一个对象，解析一个发送一个
+        ParsedEntry entry = parseSingleEntry(event["info"].toObject());
+        if (!entry.vid.isEmpty()) {
+            deliverEntry(entry);
+            log(QString("Parsed entry: %1").arg(entry.title));
         }
-        
-        // 解析数组（播放列表）- 逐个解析并立即发送
-        if (doc.isArray()) {
-            QJsonArray array = doc.array();
-            log(QString("Parsing JSON array with %1 items").arg(array.size()));
-            for (const QJsonValue &value : array) {
-                if (value.isObject()) {
-                    ParsedEntry entry = parseSingleEntry(value.toObject());
-                    if (!entry.vid.isEmpty()) {
-                        entries.append(entry);
-                        // 立即发送单个条目信号（生产者-消费者模式）
-                        emit entryParsed(entry);
-                        m_hasParsedEntries = true;  // 标记已解析条目
-                    }
-                }
-            }
-        } 
-        // 解析单个对象 - 立即发送
-        else if (doc.isObject()) {
-            log("Parsing single JSON object");
-            ParsedEntry entry = parseSingleEntry(doc.object());
-            if (!entry.vid.isEmpty()) {
-                entries.append(entry);
-                // 立即发送单个条目信号
-                emit entryParsed(entry);
-                m_hasParsedEntries = true;  // 标记已解析条目
-            }
-        } else {
-            log("JSON document is neither array nor object");
+    } else if (type == "log") {
+        log(event["message"].toString());
+    } else if (type == "done") {
+        m_isRunning = false;
+        m_helper->jobDone();
+
+        const QString status = event["status"].toString();
+        if (status == "error") {
+            QString errorMsg = event["error"].toString("yt-dlp helper failed to parse the URL");
+            log(errorMsg);
+            reportError(errorMsg);
+        } else if (status == "ok" && !m_hasParsedEntries) {
+            reportError("No output from yt-dlp");
+        } else if (status == "ok") {
+            storeResults();
         }
-    } 
-    // 多行JSON（每行一个JSON对象，播放列表格式）- 逐行解析并立即发送
-    else {
-        log(QString("Parsing %1 lines of JSON (playlist format)").arg(lines.size()));
-        for (const QString &line : lines) {
-            if (line.trimmed().isEmpty()) {
-                continue;
-            }
-            
-            QJsonParseError error;
-            QJsonDocument doc = QJsonDocument::fromJson(line.toUtf8(), &error);
-            
-            if (error.error != QJsonParseError::NoError) {
-                log(QString("JSON parse error in line: %1").arg(error.errorString()));
-                continue;
-            }
-            
-            if (doc.isObject()) {
-                ParsedEntry entry = parseSingleEntry(doc.object());
-                if (!entry.vid.isEmpty()) {
-                    entries.append(entry);
-                    // 立即发送单个条目信号（生产者-消费者模式）
-                    emit entryParsed(entry);
-                    m_hasParsedEntries = true;  // 标记已解析条目
-                }
-            }
+
+        // 已处理足够多的请求时回收助手，限制内存增长
+        if (m_helper->isExhausted()) {
+            log("Recycling yt-dlp helper");
+            m_helper->stop();
         }
+        finishParse();
     }
-    
-    log(QString("Successfully parsed %1 entries").arg(entries.size()));
-    return entries;
+}
+
+void UrlParser::onHelperFailed(const QString &error)
+{
+    log(error);
+    if (!m_isRunning || !m_usingHelper) {
+        return;
+    }
+
+    if (!m_helper->isReady()) {
+        // 助手从未就绪，回退到 yt-dlp 进程重新解析当前 URL
+        m_helperUnavailable = true;
+        m_usingHelper = false;
+        log("yt-dlp helper unavailable, falling back to yt-dlp process");
+        startProcess(m_currentUrl);
+        return;
+    }
+
+    m_isRunning = false;
+    reportError(error);
+    finishParse();
 }
 
 ParsedEntry UrlParser::parseSingleEntry(const QJsonObject &json)
@@ -324,7 +450,7 @@ ParsedEntry UrlParser::parseSingleEntry(const QJsonObject &json)
     entry.vid = entry.id;  // vid与id相同
     entry.title = json["title"].toString();
     entry.url = json["webpage_url"].toString();
-    entry.duration = json["duration"].toInt(0);
+    entry.duration = qRound(json["duration"].toDouble(0));  // duration 可能是小数
     entry.thumbnail = json["thumbnail"].toString();
     
     // 提取格式信息，优先选择视频格式
@@ -333,6 +459,7 @@ ParsedEntry UrlParser::parseSingleEntry(const QJsonObject &json)
         // 优先选择最佳视频格式（包含视频流的格式）
         QString bestVideoFormatId;
         QString bestVideoExt;
+        qint64 bestVideoSize = 0;
         int bestHeight = 0;
         
         for (const QJsonValue &formatValue : formats) {
@@ -351,12 +478,14 @@ ParsedEntry UrlParser::parseSingleEntry(const QJsonObject &json)
                 bestHeight = height;
                 bestVideoFormatId = format["format_id"].toString();
                 bestVideoExt = format["ext"].toString();
+                bestVideoSize = static_cast<qint64>(format["filesize"].toDouble(format["filesize_approx"].toDouble(0)));
             }
         }
         
         if (!bestVideoFormatId.isEmpty()) {
             entry.formatId = bestVideoFormatId;
             entry.ext = bestVideoExt;
+            entry.filesize = bestVideoSize;
         } else {
             // 如果找不到视频格式，使用默认的 bestvideo+bestaudio/best
             entry.formatId = "";  // 空字符串表示使用默认格式选择
@@ -368,16 +497,31 @@ ParsedEntry UrlParser::parseSingleEntry(const QJsonObject &json)
         entry.ext = json["ext"].toString("mp4");
     }
     
+    // 未选定格式时，使用 yt-dlp 对默认格式组合给出的（预估）大小
+    if (entry.filesize <= 0) {
+        entry.filesize = static_cast<qint64>(json["filesize"].toDouble(json["filesize_approx"].toDouble(0)));
+    }
+    
     // 设置默认值
     if (entry.ext.isEmpty()) {
         entry.ext = "mp4";
     }
     
+    // --flat-playlist 列出的条目只是指向视频页面的链接，没有格式信息
+    const QString resultType = json["_type"].toString();
+    if (resultType == "url" || resultType == "url_transparent") {
+        entry.resolved = false;
+        if (entry.url.isEmpty()) {
+            entry.url = json["url"].toString();
+        }
+    }
+    
     // 判断类型
     if (json.contains("playlist") || json.contains("playlist_index")) {
         entry.type = UrlType::Lists;
         entry.index = json["playlist_index"].toInt(1);
         entry.playlistCount = json["playlist_count"].toInt(1);
+        entry.playlistTitle = json["playlist_title"].toString(json["playlist"].toString());
     } else {
         entry.type = UrlType::Single;
         entry.index = 1;
@@ -403,3 +547,43 @@ bool UrlParser::isValidUrl(const QString &url)
     return url.startsWith("http://") || url.startsWith("https://");
 }
 
+void UrlParser::deliverEntry(const ParsedEntry &entry)
+{
+    m_collected.append(entry);
+    m_hasParsedEntries = true;  // 标记已解析条目
+    
+    // 重新验证时已从缓存发送过的条目不再重复发送，只发送新增的条目
+    if (!m_delivered.contains(entry.id)) {
+        m_delivered.insert(entry.id);
+        emit entryParsed(entry);
+    }
+}
+
+void UrlParser::reportError(const QString &error)
+{
+    // 重新验证失败时界面上已有缓存的结果，只记录日志
+    if (m_revalidating) {
+        log(QString("Revalidation failed: %1").arg(error));
+        return;
+    }
+    emit errorOccurred(error);
+}
+
+void UrlParser::storeResults()
+{
+    if (m_cache && !m_collected.isEmpty()) {
+        m_cache->store(m_currentUrl, m_collected);
+        if (m_revalidating) {
+            log(QString("Parse cache revalidated: %1 entries").arg(m_collected.size()));
+        }
+    }
+}
+
+void UrlParser::finishParse()
+{
+    if (!m_pending) {
+        return;
+    }
+    m_pending = false;
+    emit finished();
+}
@@ -0,0 +1,151 @@
+#include "core/download/urlparserpool.h"
+#include "core/download/urlparser.h"
+
+namespace {
+constexpr int kDefaultParsers = 4;
+}
+
+UrlParserPool::UrlParserPool(QObject *parent)
+    : QObject(parent)
+    , m_maxParsers(kDefaultParsers)
+    , m_cache(nullptr)
+    , m_revalidate(false)
+    , m_flatPlaylist(false)
+{
+}
+
+UrlParserPool::~UrlParserPool()
+{
+    // 解析器是子对象，析构时结束各自的 yt-dlp 进程；这里只断开信号，不再发出结果
+    m_queue.clear();
+    for (auto it = m_busy.cbegin(); it != m_busy.cend(); ++it) {
+        disconnect(it.key(), nullptr, this, nullptr);
+    }
+}
+
+void UrlParserPool::setMaxParsers(int parsers)
+{
+    m_maxParsers = qMax(1, parsers);
+
+    // 多余的空闲解析器直接释放
+    while (!m_idle.isEmpty() && m_idle.size() + m_busy.size() > m_maxParsers) {
+        m_idle.takeLast()->deleteLater();
+    }
+    startNext();
+}
+
+void UrlParserPool::setCache(ParseCache *cache, bool revalidate)
+{
+    m_cache = cache;
+    m_revalidate = revalidate;
+    for (UrlParser *parser : std::as_const(m_idle)) {
+        parser->setCache(cache, revalidate);
+    }
+    for (auto it = m_busy.cbegin(); it != m_busy.cend(); ++it) {
+        it.key()->setCache(cache, revalidate);
+    }
+}
+
+void UrlParserPool::setFlatPlaylist(bool flat)
+{
+    m_flatPlaylist = flat;
+    for (UrlParser *parser : std::as_const(m_idle)) {
+        parser->setFlatPlaylist(flat);
+    }
+    for (auto it = m_busy.cbegin(); it != m_busy.cend(); ++it) {
+        it.key()->setFlatPlaylist(flat);
+    }
+}
+
+void UrlParserPool::enqueue(const QString &requestId, const QString &url)
+{
+    m_queue.append(Request{requestId, url});
+    // 在事件循环中开始，同一批入队的请求都排好后再分配解析器
+    QMetaObject::invokeMethod(this, [this]() { startNext(); }, Qt::QueuedConnection);
+}
+
+void UrlParserPool::cancel(const QString &requestId)
+{
+    for (int i = 0; i < m_queue.size(); ++i) {
+        if (m_queue.at(i).id == requestId) {
+            m_queue.removeAt(i);
+            return;
+        }
+    }
+
+    for (auto it = m_busy.begin(); it != m_busy.end(); ++it) {
+        if (it.value() == requestId) {
+            // 被取消的 yt-dlp 进程可能尚未退出，不复用该解析器
+            UrlParser *parser = it.key();
+            m_busy.erase(it);
+            disconnect(parser, nullptr, this, nullptr);
+            parser->cancel();
+            parser->deleteLater();
+            startNext();
+            return;
+        }
+    }
+}
+
+void UrlParserPool::cancelAll()
+{
+    m_queue.clear();
+    const QStringList running = m_busy.values();
+    for (const QString &id : running) {
+        cancel(id);
+    }
+}
+
+bool UrlParserPool::isIdle() const
+{
+    return m_queue.isEmpty() && m_busy.isEmpty();
+}
+
+void UrlParserPool::startNext()
+{
+    while (!m_queue.isEmpty() && m_busy.size() < m_maxParsers) {
+        UrlParser *parser = m_idle.isEmpty() ? createParser() : m_idle.takeLast();
+        const Request request = m_queue.takeFirst();
+        m_busy.insert(parser, request.id);
+        parser->parse(request.url);
+    }
+}
+
+UrlParser *UrlParserPool::createParser()
+{
+    UrlParser *parser = new UrlParser(this);
+    parser->setCache(m_cache, m_revalidate);
+    parser->setFlatPlaylist(m_flatPlaylist);
+
+    // 结果信号直接转发；finished 排队处理，parse() 内同步结束（无效 URL、命中缓存）时不会重入 startNext()
+    connect(parser, &UrlParser::entryParsed, this, [this, parser](const ParsedEntry &entry) {
+        emit entryParsed(m_busy.value(parser), entry);
+    });
+    connect(parser, &UrlParser::errorOccurred, this, [this, parser](const QString &error) {
+        emit errorOccurred(m_busy.value(parser), error);
+    });
+    connect(parser, &UrlParser::logMessage, this, &UrlParserPool::logMessage);
+    connect(parser, &UrlParser::finished, this, [this, parser]() {
+        onParserFinished(parser);
+    }, Qt::QueuedConnection);
+    return parser;
+}
+
+void UrlParserPool::onParserFinished(UrlParser *parser)
+{
+    auto it = m_busy.find(parser);
+    if (it == m_busy.end()) {
+        return;
+    }
+    const QString id = it.value();
+    m_busy.erase(it);
+
+    if (m_idle.size() + m_busy.size() < m_maxParsers) {
+        m_idle.append(parser);
+    } else {
+        parser->deleteLater();
+    }
+
+    emit finished(id);
+    startNext();
+}
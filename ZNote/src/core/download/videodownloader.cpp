@@ -1,94 +1,203 @@
 #include "core/download/videodownloader.h"
+#include "core/download/ytdlphelper.h"
+#include "core/download/segmenteddownloader.h"
+#include "core/download/processpolicy.h"
+#include "core/download/toolregistry.h"
 #include "utils/downloadutils.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocale>
 #include <QStringList>
 #include <QOverload>
-#include <QStandardPaths>
 #include <QDateTime>
 #include <QDebug>
-#include <QCoreApplication>
 #include <QDir>
 #include <QFile>
+#include <QTemporaryFile>
+#include <QTimer>
 
+#ifdef Q_OS_UNIX
+#include <csignal>
+#include <unistd.h>
+#endif
 
 
+namespace {
+constexpr int kFlushIntervalMs = 250;  // 进度和日志的最大投递延迟
+
+// 从 yt-dlp -j 的输出中取出内置下载器所需的信息，不适用时给出原因
+bool directSourceFrom(const QByteArray &output, SegmentedDownloader::Source *source, QString *reason)
+{
+    QJsonParseError error;
+    const QJsonDocument doc = QJsonDocument::fromJson(output.trimmed(), &error);
+    if (error.error != QJsonParseError::NoError || !doc.isObject()) {
+        *reason = "no media info";
+        return false;
+    }
+    const QJsonObject info = doc.object();
+
+    // 需要合并的多个流（如 bestvideo+bestaudio）以及 HLS/DASH 分片由 yt-dlp 处理
+    if (info["requested_formats"].toArray().size() > 1) {
+        *reason = "the format needs merging";
+        return false;
+    }
+    const QString protocol = info["protocol"].toString();
+    if (protocol != "https" && protocol != "http") {
+        *reason = QString("protocol %1").arg(protocol);
+        return false;
+    }
+    QString filename = info["filename"].toString();
+    if (filename.isEmpty()) {
+        filename = info["_filename"].toString();
+    }
+    const QUrl url(info["url"].toString());
+    if (!url.isValid() || filename.isEmpty()) {
+        *reason = "no direct URL";
+        return false;
+    }
+
+    source->url = url;
+    source->filePath = filename;
+    source->headers.clear();
+    const QJsonObject headers = info["http_headers"].toObject();
+    for (auto it = headers.begin(); it != headers.end(); ++it) {
+        source->headers.insert(it.key().toUtf8(), it.value().toString().toUtf8());
+    }
+    source->sizeHint = static_cast<qint64>(info["filesize"].toDouble());
+    if (source->sizeHint <= 0) {
+        source->sizeHint = static_cast<qint64>(info["filesize_approx"].toDouble());
+    }
+    return true;
+}
+}
+
 VideoDownloader::VideoDownloader(QObject *parent)
     : QObject(parent),
     process(nullptr),
-    program(QString("yt-dlp.exe"))
+    program(ToolRegistry::name(ToolRegistry::Tool::YtDlp)),
+    rateLimit(0),
+    flushTimer(new QTimer(this)),
+    helper(nullptr),
+    usingHelper(false),
+    helperUnavailable(false),
+    native(nullptr),
+    resolver(nullptr),
+    usingNative(false),
+    restarting(false),
+    canceled(false),
+    suspended(false),
+    rateLimitPending(false),
+    startFailed(false)
 {
+    // 定时器是子对象，随下载器一起移动到工作线程
+    flushTimer->setSingleShot(true);
+    flushTimer->setInterval(kFlushIntervalMs);
+    connect(flushTimer, &QTimer::timeout, this, &VideoDownloader::flush);
+
     // process 将在 start() 方法中创建，确保在正确的线程中创建
-    // 先查找yt-dlp可执行文件路径
-    QString executable = QStandardPaths::findExecutable(program);
-    if (executable.isEmpty()) {
-        // 尝试在项目bin目录中查找
-        QString projectPath = QDir(QCoreApplication::applicationDirPath()).absoluteFilePath("../bin/yt-dlp.exe");
-        if (QFile::exists(projectPath)) {
-            program = projectPath;
-        } else {
-            // 尝试在应用程序目录中查找
-            QString appDir = QCoreApplication::applicationDirPath();
-            QString binPath = QDir(appDir).filePath("yt-dlp.exe");
-            if (QFile::exists(binPath)) {
-                program = binPath;
-            }
-        }
-    } else {
-        program = executable;
-    }
 }
 
+VideoDownloader::~VideoDownloader() = default;
+
 void VideoDownloader::start(const DownloadTask &task)
 {
-    currentTask = task;
+    start(QList<DownloadTask>{task});
+}
+
+void VideoDownloader::start(const QList<DownloadTask> &batch)
+{
+    tasks = batch;
+    rateLimit = batch.isEmpty() ? 0 : batch.first().rateLimit;
+    // yt-dlp 路径由 ToolRegistry 统一查找并缓存，配置修改后自动更新
+    program = ToolRegistry::path(ToolRegistry::Tool::YtDlp);
 
-    // 在线程中创建 QProcess，确保在正确的线程中
+    // 在线程中创建 QProcess，确保在正确的线程中；之后的任务复用同一个 QProcess
     if (process == nullptr)
     {
         process = new QProcess(this);
-        
-        // 查找yt-dlp可执行文件
-        QString executable = QStandardPaths::findExecutable(program);
-        if (executable.isEmpty()) {
-            // 尝试在项目bin目录中查找
-            QString projectPath = QDir(QCoreApplication::applicationDirPath()).absoluteFilePath("../bin/yt-dlp.exe");
-            if (QFile::exists(projectPath)) {
-                program = projectPath;
-            } else {
-                // 尝试在应用程序目录中查找
-                QString appDir = QCoreApplication::applicationDirPath();
-                QString binPath = QDir(appDir).filePath("yt-dlp.exe");
-                if (QFile::exists(binPath)) {
-                    program = binPath;
-                } else {
-                    emit logMessage("❌ Cannot find yt-dlp.exe in PATH or project bin directory");
-                }
-            }
-        } else {
-            program = executable;
+
+        if (!ToolRegistry::isAvailable(ToolRegistry::Tool::YtDlp)) {
+            log("❌ Cannot find yt-dlp in the configured path, PATH or project bin directory");
         }
         
         // 连接信号
         connect(process, &QProcess::readyReadStandardOutput, this, &VideoDownloader::handleStdOutput);
         connect(process, &QProcess::finished, this, &VideoDownloader::handleFinished);
+        connect(process, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+            // 启动失败时不会发出 finished，需要手动结束任务，否则工作线程会一直被占用
+            if (error == QProcess::FailedToStart) {
+                log(QString("❌ Failed to start %1").arg(program));
+                startFailed = true;
+                handleFinished();
+            }
+        });
         connect(process, &QProcess::readyReadStandardError, [this](){
-            emit logMessage(QString::fromUtf8(process->readAllStandardError()));
+            log(QString::fromUtf8(process->readAllStandardError()));
         });
     }
 
-    QStringList args = znote::utils::buildDownloadCommand(task);
+    restarting = false;
+    canceled = false;
+    suspended = false;
+    rateLimitPending = false;
+    startFailed = false;
 
-    znote::utils::printCommand(args);
+    const QDateTime now = QDateTime::currentDateTime();
+    for (DownloadTask &task : tasks) {
+        task.status = DownloadStatus::Success;
+        task.startTime = now;
+        task.files.clear();
+    }
 
-    // QProcess::start 是异步的，不会阻塞
-    process->start(program, args);
+    usingHelper = false;
+    usingNative = false;
+    if (tasks.size() == 1 && tasks.first().backend == DownloadBackend::Native) {
+        resolveDirectUrl();
+    } else {
+        launchYtDlp();
+    }
 
-    currentTask.startTime = QDateTime::currentDateTime();
+    for (const DownloadTask &task : std::as_const(tasks)) {
+        emit taskStarted(task);
+    }
+}
 
-    emit taskStarted(currentTask);
+bool VideoDownloader::canSuspend()
+{
+#ifdef Q_OS_UNIX
+    return true;
+#else
+    return false;
+#endif
 }
 
 void VideoDownloader::cancel()
 {
+    restarting = false;
+    canceled = true;
+    // 被挂起的进程组先恢复，避免子进程在 yt-dlp 被结束后一直停在后台
+#ifdef Q_OS_UNIX
+    if (suspended && activePid() > 0) {
+        ::kill(-static_cast<pid_t>(activePid()), SIGCONT);
+    }
+#endif
+    suspended = false;
+    rateLimitPending = false;
+    if (resolver && resolver->state() != QProcess::NotRunning) {
+        // 直链尚未解析完成，结束解析进程后按取消结束
+        resolver->kill();
+        return;
+    }
+    if (usingNative) {
+        native->cancel();
+        return;
+    }
+    if (usingHelper) {
+        // 助手中止当前下载并丢弃排队的任务，每个任务回报一次 canceled；助手进程本身保留复用
+        helper->send({{"op", "cancel"}});
+        return;
+    }
     if (process && process->state() == QProcess::Running)
     {
         process->kill();
@@ -97,25 +206,530 @@ void VideoDownloader::cancel()
     }
 }
 
+void VideoDownloader::suspend()
+{
+    if (usingNative) {
+        // 内置下载器停止读取数据，不涉及子进程
+        if (!suspended) {
+            native->suspend();
+            suspended = true;
+            log(QString("⏸️ 已暂停: %1").arg(describe()));
+        }
+        return;
+    }
+#ifdef Q_OS_UNIX
+    if (activePid() > 0 && !suspended) {
+        ::kill(-static_cast<pid_t>(activePid()), SIGSTOP);
+        suspended = true;
+        log(QString("⏸️ 已暂停: %1").arg(describe()));
+    }
+#endif
+}
+
+void VideoDownloader::resume()
+{
+    if (usingNative) {
+        if (suspended) {
+            native->resume();
+            log(QString("▶️ 继续下载: %1").arg(describe()));
+        }
+        suspended = false;
+        return;
+    }
+#ifdef Q_OS_UNIX
+    if (activePid() > 0 && suspended) {
+        ::kill(-static_cast<pid_t>(activePid()), SIGCONT);
+        log(QString("▶️ 继续下载: %1").arg(describe()));
+    }
+#endif
+    suspended = false;
+
+    // 挂起期间修改的限速：进程组已恢复运行，现在按新限速重启并续传
+    if (rateLimitPending) {
+        rateLimitPending = false;
+        if (process && process->state() == QProcess::Running) {
+            restarting = true;
+            process->kill();
+        }
+    }
+}
+
+void VideoDownloader::setRateLimit(qint64 bytesPerSecond)
+{
+    if (rateLimit == bytesPerSecond) {
+        return;
+    }
+    rateLimit = bytesPerSecond;
+    for (DownloadTask &task : tasks) {
+        task.rateLimit = bytesPerSecond;
+    }
+
+    if (usingNative) {
+        // 内置下载器按新的额度读取数据，不需要重启
+        native->setRateLimit(rateLimit);
+        return;
+    }
+
+    if (usingHelper) {
+        // 助手在下载过程中直接修改 YoutubeDL 的限速参数，不需要重启
+        helper->send({{"op", "set"}, {"ratelimit", rateLimit}});
+        return;
+    }
+
+    // yt-dlp 不支持运行中修改限速，只能结束进程后用新参数重新启动；
+    // 已下载的 .part 文件会被续传，批量模式下只重新下载尚未完成的条目。
+    // 挂起中的任务先记下，恢复时再重启，否则子进程组停止时被结束会留下停住的 ffmpeg
+    if (process && process->state() == QProcess::Running) {
+        if (suspended) {
+            rateLimitPending = true;
+        } else {
+            restarting = true;
+            process->kill();
+        }
+    }
+}
+
+void VideoDownloader::launchYtDlp()
+{
+    // 启用助手时由常驻进程执行，省去每个任务启动解释器的开销；助手不可用时回退到 yt-dlp 进程
+    usingHelper = YtDlpHelper::settings().enabled && !helperUnavailable && launchHelper();
+    if (!usingHelper) {
+        launch();
+    }
+}
+
+void VideoDownloader::launch()
+{
+    // 重启后 yt-dlp 会对已完成的流再报告一次 finished，重新累计
+    finishedBytes.clear();
+    stdoutBuffer.clear();
+
+    QStringList args;
+    if (tasks.size() == 1) {
+        args = znote::utils::buildDownloadCommand(tasks.first());
+    } else {
+        // 批量模式：URL 写入批处理文件，由一个 yt-dlp 进程依次下载，省去每个任务的解释器启动开销
+        batchFile.reset(new QTemporaryFile(QDir(QDir::tempPath()).filePath("znote-batch-XXXXXX.txt")));
+        if (batchFile->open()) {
+            for (const DownloadTask &task : std::as_const(tasks)) {
+                batchFile->write(task.video.url.toUtf8());
+                batchFile->write("\n");
+            }
+            batchFile->close();
+        } else {
+            // 没有批处理文件 yt-dlp 无法下载任何条目，不启动进程，整批按失败结束（与启动失败相同）
+            log(QString("❌ Cannot create batch file: %1").arg(batchFile->errorString()));
+            startFailed = true;
+            QMetaObject::invokeMethod(this, [this]() { handleFinished(); }, Qt::QueuedConnection);
+            return;
+        }
+        args = znote::utils::buildBatchDownloadCommand(tasks, batchFile->fileName());
+    }
+
+    znote::utils::printCommand(args);
+
+    // 子进程放到独立进程组并应用下载阶段的资源限制；QProcess::start 是异步的，不会阻塞
+    ProcessPolicy::apply(process, ProcessPolicy::Stage::Download);
+    process->start(program, args);
+}
+
+bool VideoDownloader::launchHelper()
+{
+    if (helper == nullptr) {
+        helper = new YtDlpHelper(this);
+        connect(helper, &YtDlpHelper::eventReceived, this, &VideoDownloader::handleHelperEvent);
+        connect(helper, &YtDlpHelper::logMessage, this, &VideoDownloader::log);
+        connect(helper, &YtDlpHelper::failed, this, &VideoDownloader::handleHelperFailed);
+    }
+    if (!helper->start()) {
+        helperUnavailable = true;
+        log("⚠️ yt-dlp helper unavailable, falling back to yt-dlp processes");
+        return false;
+    }
+
+    // 请求按顺序写入助手的 stdin，进程尚未启动完成时由 QProcess 缓冲
+    helper->send({{"op", "set"}, {"ratelimit", rateLimit}});
+    for (const DownloadTask &task : std::as_const(tasks)) {
+        QJsonObject request;
+        request["id"] = task.id;
+        request["op"] = "download";
+        request["url"] = task.video.url;
+        request["options"] = znote::utils::buildHelperDownloadOptions(task);
+        helper->send(request);
+    }
+    return true;
+}
+
+void VideoDownloader::resolveDirectUrl()
+{
+    if (resolver == nullptr) {
+        resolver = new QProcess(this);
+        connect(resolver, &QProcess::readyReadStandardOutput, this, [this]() {
+            resolverOutput += resolver->readAllStandardOutput();
+        });
+        connect(resolver, &QProcess::readyReadStandardError, this, [this]() {
+            log(QString::fromUtf8(resolver->readAllStandardError()).trimmed());
+        });
+        connect(resolver, &QProcess::finished, this, &VideoDownloader::handleResolved);
+        connect(resolver, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+            // 启动失败时不会发出 finished，按解析失败处理（回退到 yt-dlp 下载）
+            if (error == QProcess::FailedToStart) {
+                handleResolved();
+            }
+        });
+    }
+
+    resolverOutput.clear();
+    const QList<QString> args = znote::utils::buildResolveCommand(tasks.first());
+    znote::utils::printCommand(args);
+    ProcessPolicy::apply(resolver, ProcessPolicy::Stage::Download);
+    resolver->start(program, args);
+}
+
+qint64 VideoDownloader::activePid() const
+{
+    if (resolver && resolver->state() == QProcess::Running) {
+        return resolver->processId();
+    }
+    if (usingNative) {
+        return 0;
+    }
+    if (usingHelper) {
+        return helper->isRunning() ? helper->processId() : 0;
+    }
+    return process && process->state() == QProcess::Running ? process->processId() : 0;
+}
+
+QString VideoDownloader::describe() const
+{
+    if (tasks.size() == 1) {
+        return tasks.first().video.title;
+    }
+    return QString("%1 个任务（批量）").arg(tasks.size());
+}
+
 void VideoDownloader::check()
 {
-    program = QStandardPaths::findExecutable(program);
-    if (program.isEmpty()) {
-        emit logMessage(QString("❌ Cannot find %1 in PATH").arg(program));
+    program = ToolRegistry::path(ToolRegistry::Tool::YtDlp);
+    if (!ToolRegistry::isAvailable(ToolRegistry::Tool::YtDlp)) {
+        log(QString("❌ Cannot find %1 in PATH").arg(program));
+    }
+}
+
+void VideoDownloader::log(const QString &msg)
+{
+    pendingLogs.append(msg);
+    scheduleFlush();
+}
+
+void VideoDownloader::scheduleFlush()
+{
+    if (!flushTimer->isActive()) {
+        flushTimer->start();
+    }
+}
+
+void VideoDownloader::flush()
+{
+    flushTimer->stop();
+
+    if (!pendingLogs.isEmpty()) {
+        QStringList batch;
+        batch.swap(pendingLogs);
+        emit logBatch(batch);
+    }
+
+    QHash<QString, DownloadProgress> progress;
+    progress.swap(pendingProgress);
+    for (const DownloadProgress &item : std::as_const(progress)) {
+        emit progressUpdated(this, item);
     }
 }
 
 void VideoDownloader::handleStdOutput()
 {
-    while (process->canReadLine())
-    {
-        QString line = QString::fromLocal8Bit(process->readLine()).trimmed();
-        if (!line.isEmpty()) emit logMessage(line);
+    // 在固定缓冲区上按字节切分行，不为每行分配 QByteArray
+    while (stdoutBuffer.readFrom(process) > 0) {
+        QByteArrayView line;
+        while (stdoutBuffer.nextLine(&line)) {
+            handleLine(line);
+        }
+    }
+}
+
+void VideoDownloader::handleLine(QByteArrayView line)
+{
+    line = line.trimmed();
+    if (line.isEmpty()) {
+        return;
+    }
+
+    // 批量模式下每个条目完成时 yt-dlp 会打印一行标记，据此单独结束对应任务
+    QString finishedId;
+    if (znote::utils::parseBatchItemDone(line, &finishedId)) {
+        finishItem(finishedId);
+        return;
+    }
+
+    // 推迟后处理时记录每个下载好的流文件，交给后处理阶段合并
+    DownloadedFile file;
+    if (znote::utils::parseFileMarker(line, &finishedId, &file)) {
+        addFile(finishedId, file);
+        return;
+    }
+
+    // 进度行（--newline 下每秒多次）直接在字节上解析，不进入日志
+    DownloadProgress progress;
+    bool streamFinished = false;
+    if (znote::utils::parseProgressLine(line, &progress, &streamFinished)) {
+        reportProgress(progress, streamFinished);
+        return;
+    }
+
+    // 只有需要显示的行才转换为字符串
+    log(QString::fromLocal8Bit(line));
+}
+
+void VideoDownloader::reportProgress(DownloadProgress progress, bool streamFinished)
+{
+    // 单任务模式下直接归属当前任务；批量模式下依靠进度行中的视频 ID 区分
+    if (tasks.size() == 1) {
+        progress.taskId = tasks.first().id;
+    }
+
+    // bestvideo+bestaudio 会依次下载两个流，之前完成的流计入同一任务的进度
+    const qint64 streamTotal = progress.totalBytes;
+    const qint64 earlier = finishedBytes.value(progress.taskId);
+    progress.downloadedBytes += earlier;
+    progress.totalBytes += earlier;
+    progress.percent = progress.totalBytes > 0
+        ? progress.downloadedBytes * 100.0 / progress.totalBytes
+        : 0.0;
+
+    if (streamFinished) {
+        finishedBytes.insert(progress.taskId, earlier + streamTotal);
+        log(QString("[download] 100% of %1").arg(QLocale::system().formattedDataSize(streamTotal)));
+    }
+
+    // 同一任务在一个刷新间隔内只投递最新的进度
+    pendingProgress.insert(progress.taskId, progress);
+    scheduleFlush();
+}
+
+void VideoDownloader::addFile(const QString &taskId, const DownloadedFile &file)
+{
+    if (file.path.isEmpty()) {
+        return;
+    }
+    for (DownloadTask &task : tasks) {
+        // 单任务模式下直接归属当前任务；重启后 yt-dlp 会再次报告已下载的文件，去重
+        const bool collects = task.deferPostProcess || !task.stagingPath.isEmpty();
+        if (collects && (tasks.size() == 1 || task.id == taskId)) {
+            for (const DownloadedFile &known : std::as_const(task.files)) {
+                if (known.path == file.path) {
+                    return;
+                }
+            }
+            task.files.append(file);
+            return;
+        }
+    }
+}
+
+void VideoDownloader::finishItem(const QString &taskId, DownloadStatus status)
+{
+    for (int i = 0; i < tasks.size(); ++i) {
+        if (tasks.at(i).id == taskId) {
+            DownloadTask task = tasks.takeAt(i);
+            finishedBytes.remove(taskId);
+            // 先投递该任务之前的日志和进度，保证顺序
+            flush();
+            task.endTime = QDateTime::currentDateTime();
+            task.status = status;
+            emit taskFinished(this, task);
+            return;
+        }
     }
 }
 
 void VideoDownloader::handleFinished()
 {
-    currentTask.endTime = QDateTime::currentDateTime();
-    emit taskFinished(this, currentTask);
+    if (restarting) {
+        // 限速调整导致的重启，任务尚未结束；在下一轮事件循环中重新启动进程，
+        // 期间若被 cancel() 则按正常结束处理
+        QMetaObject::invokeMethod(this, [this]() {
+            if (restarting) {
+                restarting = false;
+                launch();
+            } else {
+                handleFinished();
+            }
+        }, Qt::QueuedConnection);
+        return;
+    }
+
+    // 读取剩余输出，避免最后一个条目的完成标记还在缓冲区中
+    if (process && process->bytesAvailable() > 0) {
+        handleStdOutput();
+    }
+    QByteArrayView tail;
+    if (stdoutBuffer.takeRemainder(&tail)) {
+        handleLine(tail);
+    }
+
+    // 剩余条目（单任务模式下即唯一的任务）按进程退出状态结束
+    DownloadStatus status = DownloadStatus::Success;
+    if (canceled) {
+        status = DownloadStatus::Canceled;
+    } else if (startFailed
+               || (process && process->state() == QProcess::NotRunning
+                   && (process->exitStatus() != QProcess::NormalExit || process->exitCode() != 0))) {
+        status = DownloadStatus::Failed;
+    }
+
+    finishRemaining(status);
+}
+
+void VideoDownloader::finishRemaining(DownloadStatus status)
+{
+    const QDateTime now = QDateTime::currentDateTime();
+    QList<DownloadTask> remaining;
+    remaining.swap(tasks);
+    finishedBytes.clear();
+    batchFile.reset();
+    flush();
+    for (DownloadTask &task : remaining) {
+        task.endTime = now;
+        task.status = status;
+        emit taskFinished(this, task);
+    }
+}
+
+void VideoDownloader::handleHelperEvent(const QJsonObject &event)
+{
+    const QString type = event["event"].toString();
+
+    if (type == "progress") {
+        DownloadProgress progress;
+        progress.taskId = event["id"].toString();
+        progress.downloadedBytes = static_cast<qint64>(event["downloaded"].toDouble());
+        progress.totalBytes = qMax(static_cast<qint64>(event["total"].toDouble()), progress.downloadedBytes);
+        progress.speed = static_cast<qint64>(event["speed"].toDouble());
+        progress.eta = event["eta"].toInt(-1);
+        reportProgress(progress, event["status"].toString() == "finished");
+    } else if (type == "log") {
+        log(event["message"].toString());
+    } else if (type == "file") {
+        DownloadedFile file;
+        file.path = event["path"].toString();
+        file.hasVideo = event["video"].toBool(true);
+        addFile(event["id"].toString(), file);
+    } else if (type == "done") {
+        helper->jobDone();
+        const QString status = event["status"].toString();
+        if (status == "ok") {
+            finishItem(event["id"].toString(), DownloadStatus::Success);
+        } else if (status == "canceled") {
+            finishItem(event["id"].toString(), DownloadStatus::Canceled);
+        } else {
+            if (event.contains("error")) {
+                log(QString("❌ %1").arg(event["error"].toString()));
+            }
+            finishItem(event["id"].toString(), DownloadStatus::Failed);
+        }
+
+        // 空闲且已处理足够多的任务时回收助手，限制解释器长期运行的内存增长
+        if (tasks.isEmpty() && helper->isExhausted()) {
+            log("♻️ Recycling yt-dlp helper");
+            helper->stop();
+        }
+    }
+}
+
+void VideoDownloader::handleHelperFailed(const QString &error)
+{
+    log(QString("❌ %1").arg(error));
+    if (!usingHelper || tasks.isEmpty()) {
+        // 空闲时退出的助手在下一个任务开始时重新启动
+        return;
+    }
+
+    if (!helper->isReady()) {
+        // 助手从未就绪（没有 Python 或 yt_dlp 模块），本下载器之后都使用 yt-dlp 进程
+        helperUnavailable = true;
+        usingHelper = false;
+        log("⚠️ yt-dlp helper unavailable, falling back to yt-dlp processes");
+        if (canceled) {
+            finishRemaining(DownloadStatus::Canceled);
+        } else {
+            launch();
+        }
+        return;
+    }
+
+    // 下载过程中助手异常退出，剩余任务按失败结束
+    finishRemaining(canceled ? DownloadStatus::Canceled : DownloadStatus::Failed);
+}
+
+void VideoDownloader::handleResolved()
+{
+    resolverOutput += resolver->readAllStandardOutput();
+    QByteArray output;
+    output.swap(resolverOutput);
+    if (tasks.isEmpty()) {
+        return;
+    }
+    if (canceled) {
+        finishRemaining(DownloadStatus::Canceled);
+        return;
+    }
+
+    SegmentedDownloader::Source source;
+    QString reason;
+    if (resolver->exitStatus() != QProcess::NormalExit || resolver->exitCode() != 0
+        || !directSourceFrom(output, &source, &reason)) {
+        log(QString("⚠️ Native download not applicable (%1), using yt-dlp").arg(reason.isEmpty() ? QString("resolve failed") : reason));
+        launchYtDlp();
+        return;
+    }
+
+    if (native == nullptr) {
+        native = new SegmentedDownloader(this);
+        connect(native, &SegmentedDownloader::progress, this, &VideoDownloader::handleNativeProgress);
+        connect(native, &SegmentedDownloader::logMessage, this, &VideoDownloader::log);
+        connect(native, &SegmentedDownloader::finished, this, &VideoDownloader::handleNativeFinished);
+    }
+    usingNative = true;
+    native->setRateLimit(rateLimit);
+    native->start(source, tasks.first().connections);
+}
+
+void VideoDownloader::handleNativeProgress(qint64 downloaded, qint64 total, qint64 speed)
+{
+    if (tasks.isEmpty()) {
+        return;
+    }
+
+    DownloadProgress progress;
+    progress.taskId = tasks.first().id;
+    progress.downloadedBytes = downloaded;
+    progress.totalBytes = total;
+    progress.speed = speed;
+    progress.eta = speed > 0 && total > downloaded ? static_cast<int>((total - downloaded) / speed) : -1;
+    reportProgress(progress, false);
+}
+
+void VideoDownloader::handleNativeFinished(bool success, const QString &error)
+{
+    usingNative = false;
+    if (success) {
+        addFile(tasks.first().id, DownloadedFile{native->filePath(), true});
+        finishRemaining(DownloadStatus::Success);
+    } else if (canceled) {
+        finishRemaining(DownloadStatus::Canceled);
+    } else {
+        // 分段重试用尽或服务器不配合（如直链过期），交给 yt-dlp 重新下载
+        log(QString("⚠️ Native download failed (%1), retrying with yt-dlp").arg(error));
+        launchYtDlp();
+    }
 }
@@ -0,0 +1,263 @@
+#include "core/download/ytdlphelper.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QStandardPaths>
+#include <QTimer>
+
+namespace {
+constexpr int kStopTimeoutMs = 5000;  // 关闭 stdin 后等待助手自行退出的时间
+constexpr int kLineCapacity = 64 * 1024;           // 进度事件很短，初始缓冲足够
+constexpr int kMaxLineCapacity = 64 * 1024 * 1024; // extract 的单个视频信息可能有数 MB
+
+QMutex &settingsMutex()
+{
+    static QMutex mutex;
+    return mutex;
+}
+
+YtDlpHelper::Settings &sharedSettings()
+{
+    static YtDlpHelper::Settings settings;
+    return settings;
+}
+}
+
+void YtDlpHelper::setSettings(const Settings &settings)
+{
+    QMutexLocker locker(&settingsMutex());
+    sharedSettings() = settings;
+}
+
+YtDlpHelper::Settings YtDlpHelper::settings()
+{
+    QMutexLocker locker(&settingsMutex());
+    return sharedSettings();
+}
+
+QString YtDlpHelper::scriptPath()
+{
+    return QDir(QCoreApplication::applicationDirPath()).filePath("ytdlp_helper.py");
+}
+
+YtDlpHelper::YtDlpHelper(QObject *parent)
+    : QObject(parent)
+    , m_process(nullptr)
+    , m_stdout(kLineCapacity, kMaxLineCapacity)
+    , m_jobs(0)
+    , m_maxJobs(1)
+    , m_ready(false)
+    , m_stage(ProcessPolicy::Stage::Download)
+{
+}
+
+YtDlpHelper::~YtDlpHelper()
+{
+    // QProcess 作为子对象被删除时会结束仍在运行的助手进程，此时不再处理其信号
+    if (m_process) {
+        disconnect(m_process, nullptr, this, nullptr);
+    }
+}
+
+bool YtDlpHelper::start()
+{
+    if (isRunning()) {
+        return true;
+    }
+
+    const Settings config = settings();
+    const QString script = scriptPath();
+    if (!QFile::exists(script)) {
+        emit logMessage(QString("❌ yt-dlp helper script not found: %1").arg(script));
+        return false;
+    }
+    const QString python = findPython(config.python);
+    if (python.isEmpty()) {
+        emit logMessage("❌ Cannot find a Python interpreter for the yt-dlp helper");
+        return false;
+    }
+
+    // 每次启动使用新的 QProcess，旧进程可能还在退出过程中
+    m_process = new QProcess(this);
+    // 与 yt-dlp 进程相同，放到独立进程组（挂起时连同 ffmpeg 一起暂停）并应用所属阶段的资源限制
+    ProcessPolicy::apply(m_process, m_stage);
+    connect(m_process, &QProcess::readyReadStandardOutput, this, &YtDlpHelper::handleStdOutput);
+    connect(m_process, &QProcess::readyReadStandardError, this, [this]() {
+        emit logMessage(QString::fromUtf8(m_process->readAllStandardError()).trimmed());
+    });
+    connect(m_process, &QProcess::finished, this, &YtDlpHelper::handleFinished);
+    connect(m_process, &QProcess::errorOccurred, this, [this, python](QProcess::ProcessError error) {
+        // 启动失败时不会发出 finished；部分平台在 start() 内同步报错，
+        // 延迟到下一轮事件循环再通知，保证调用方已记录 start() 的结果
+        if (error == QProcess::FailedToStart) {
+            stop();
+            QMetaObject::invokeMethod(this, [this, python]() {
+                emit failed(QString("Failed to start %1").arg(python));
+            }, Qt::QueuedConnection);
+        }
+    });
+
+    m_stdout.clear();
+    m_fatal.clear();
+    m_jobs = 0;
+    m_maxJobs = qMax(1, config.maxJobs);
+    m_ready = false;
+
+    // -u：关闭输出缓冲，事件逐行实时到达
+    m_process->start(python, {"-u", script});
+    return true;
+}
+
+void YtDlpHelper::stop()
+{
+    if (!m_process) {
+        return;
+    }
+
+    // 与旧进程断开，之后的 start() 会创建新进程；旧进程读到 EOF 后自行退出
+    QProcess *process = m_process;
+    m_process = nullptr;
+    disconnect(process, nullptr, this, nullptr);
+    connect(process, &QProcess::finished, process, &QObject::deleteLater);
+
+    if (process->state() == QProcess::NotRunning) {
+        process->deleteLater();
+        return;
+    }
+    process->closeWriteChannel();
+    QTimer::singleShot(kStopTimeoutMs, process, [process]() {
+        if (process->state() != QProcess::NotRunning) {
+            process->kill();
+        }
+    });
+}
+
+void YtDlpHelper::kill()
+{
+    if (m_process && m_process->state() != QProcess::NotRunning) {
+        m_process->kill();
+    }
+    stop();
+}
+
+bool YtDlpHelper::isRunning() const
+{
+    return m_process && m_process->state() != QProcess::NotRunning;
+}
+
+bool YtDlpHelper::isReady() const
+{
+    return m_ready;
+}
+
+qint64 YtDlpHelper::processId() const
+{
+    return m_process ? m_process->processId() : 0;
+}
+
+void YtDlpHelper::send(const QJsonObject &request)
+{
+    if (!isRunning()) {
+        return;
+    }
+    m_process->write(QJsonDocument(request).toJson(QJsonDocument::Compact) + '\n');
+}
+
+void YtDlpHelper::jobDone()
+{
+    ++m_jobs;
+}
+
+bool YtDlpHelper::isExhausted() const
+{
+    return m_jobs >= m_maxJobs;
+}
+
+void YtDlpHelper::setStage(ProcessPolicy::Stage stage)
+{
+    m_stage = stage;
+}
+
+void YtDlpHelper::handleStdOutput()
+{
+    while (m_process && m_stdout.readFrom(m_process) > 0) {
+        QByteArrayView view;
+        while (m_stdout.nextLine(&view)) {
+            handleLine(view);
+        }
+    }
+}
+
+void YtDlpHelper::handleLine(QByteArrayView view)
+{
+    view = view.trimmed();
+    if (view.isEmpty()) {
+        return;
+    }
+
+    // fromRawData 不复制数据，只在解析期间引用行缓冲
+    const QByteArray line = QByteArray::fromRawData(view.data(), view.size());
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(line, &error);
+    if (error.error != QJsonParseError::NoError || !doc.isObject()) {
+        // 不是协议事件（例如第三方库直接打印的内容），作为日志输出
+        emit logMessage(QString::fromUtf8(line));
+        return;
+    }
+
+    const QJsonObject event = doc.object();
+    const QString type = event["event"].toString();
+    if (type == "ready") {
+        m_ready = true;
+        emit logMessage(QString("yt-dlp helper ready (yt-dlp %1)").arg(event["version"].toString()));
+    } else if (type == "fatal") {
+        m_fatal = event["error"].toString();
+    } else {
+        emit eventReceived(event);
+    }
+}
+
+void YtDlpHelper::handleFinished()
+{
+    if (m_process && m_process->bytesAvailable() > 0) {
+        handleStdOutput();
+    }
+
+    QString error = m_fatal;
+    if (error.isEmpty() && m_process) {
+        error = m_process->exitStatus() == QProcess::CrashExit
+            ? QString("yt-dlp helper crashed")
+            : QString("yt-dlp helper exited with code %1").arg(m_process->exitCode());
+    }
+
+    // 意外退出的进程不再使用，下次 start() 重新启动
+    stop();
+    emit failed(error);
+}
+
+QString YtDlpHelper::findPython(const QString &configured)
+{
+    if (!configured.isEmpty()) {
+        if (QFile::exists(configured)) {
+            return configured;
+        }
+        return QStandardPaths::findExecutable(configured);
+    }
+
+#ifdef Q_OS_WIN
+    const QStringList candidates = {"python", "python3", "py"};
+#else
+    const QStringList candidates = {"python3", "python"};
+#endif
+    for (const QString &candidate : candidates) {
+        QString path = QStandardPaths::findExecutable(candidate);
+        if (!path.isEmpty()) {
+            return path;
+        }
+    }
+    return QString();
+}
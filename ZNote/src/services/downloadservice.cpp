@@ -1,8 +1,16 @@
 #include "services/downloadservice.h"
 #include "core/download/taskqueue.h"
-#include "core/download/urlparser.h"
+#include "core/download/parseworker.h"
+#include "core/download/urlparserpool.h"
+#include "core/download/entryresolver.h"
+#include "core/download/ytdlphelper.h"
+#include "core/download/postprocessor.h"
+#include "core/download/processpolicy.h"
+#include "core/download/toolregistry.h"
 #include "utils/logger.h"
 #include <QTimer>
+#include <QThread>
+#include <QSet>
 #include <QDebug>
 #include <algorithm>
 
@@ -13,16 +21,17 @@ DownloadService::DownloadService(IConfigService *configService,
     , m_configService(configService)
     , m_historyService(historyService)
     , m_taskQueue(nullptr)
-    , m_urlParser(nullptr)
+    , m_parseThread(nullptr)
+    , m_parseWorker(nullptr)
     , m_progressTimer(new QTimer(this))
     , m_totalTasks(0)
     , m_completedCount(0)
+    , m_completedBytes(0)
+    , m_completedUnknown(0)
     , m_totalEverAdded(0)
     , m_isRunning(false)
     , m_isPaused(false)
-    , m_parseTotal(0)
-    , m_parseSuccess(0)
-    , m_parseFailed(0)
+    , m_submissionCount(0)
 {
     if (!m_configService) {
         LOG_ERROR("ConfigService is null");
@@ -32,11 +41,42 @@ DownloadService::DownloadService(IConfigService *configService,
     // 创建任务队列
     int threadCount = m_configService->getValue("download.threadCount", 4).toInt();
     m_taskQueue = std::make_unique<TaskQueue>(threadCount, this);
+    applyQueueSettings();
+    
+    // 解析在独立线程中进行，结果按批送回；解析器池和 resolver 在移动到线程之前配置
+    m_parseWorker = new ParseWorker(m_configService->getValue("download.parseBatchInterval", 50).toInt());
+    UrlParserPool *parserPool = m_parseWorker->pool();
+    // 多个 URL 并发解析
+    parserPool->setMaxParsers(m_configService->getValue("download.parseJobs", 4).toInt());
+    
+    // 两阶段解析：播放列表先只列出条目，再按需并行解析可见和已选中的条目
+    parserPool->setFlatPlaylist(m_configService->getValue("download.flatPlaylist", true).toBool());
+    m_parseWorker->resolver()->setMaxJobs(m_configService->getValue("download.resolveJobs", 4).toInt());
+    
+    // 解析结果缓存：再次解析同一 URL 时直接使用上次的结果，不再启动 yt-dlp
+    if (m_configService->getValue("download.parseCache", true).toBool()) {
+        m_parseCache = std::make_unique<ParseCache>();
+        m_parseCache->setTtl(m_configService->getValue("download.parseCacheTtl", 24).toLongLong() * 3600);
+        m_parseCache->setMaxEntries(m_configService->getValue("download.parseCacheMaxEntries", 5000).toInt());
+        parserPool->setCache(m_parseCache.get(),
+                             m_configService->getValue("download.parseCacheRevalidate", true).toBool());
+        m_parseWorker->setCache(m_parseCache.get());
+    }
     
-    // 创建URL解析器
-    m_urlParser = std::make_unique<UrlParser>(this);
+    m_parseThread = new QThread(this);
+    m_parseThread->setObjectName("ParseThread");
+    m_parseWorker->moveToThread(m_parseThread);
+    // 线程结束时在解析线程中删除 worker，其中的 yt-dlp 进程随之结束
+    connect(m_parseThread, &QThread::finished, m_parseWorker, &ParseWorker::deleteLater);
     
     setupConnections();
+    m_parseThread->start();
+    
+    // 恢复上次退出时未完成的任务
+    if (m_configService->getValue("download.journal", true).toBool()) {
+        m_journal = std::make_unique<TaskJournal>();
+        restoreQueue();
+    }
     
     // 设置进度更新定时器
     m_progressTimer->setInterval(1000); // 每秒更新一次
@@ -48,46 +88,105 @@ DownloadService::~DownloadService()
     if (m_isRunning) {
         stopDownload();
     }
+    
+    // 解析线程使用解析缓存，必须在缓存销毁前结束
+    if (m_parseThread) {
+        m_parseThread->quit();
+        m_parseThread->wait();
+    }
 }
 
-void DownloadService::parseUrl(const QString &url, const QString &savePath)
+QString DownloadService::parseUrl(const QString &url, const QString &savePath)
 {
-    if (url.isEmpty()) {
+    return parseUrls(QStringList{url}, savePath).value(0);
+}
+
+QStringList DownloadService::parseUrls(const QStringList &urls, const QString &savePath)
+{
+    if (urls.isEmpty() || std::any_of(urls.cbegin(), urls.cend(), [](const QString &url) { return url.isEmpty(); })) {
         emit taskError("", "URL is empty");
-        return;
+        return QStringList();
     }
     
     if (savePath.isEmpty()) {
         emit taskError("", "Save path is empty");
-        return;
+        return QStringList();
     }
     
-    // 保存当前解析的保存路径
+    // 保存最近一次解析的保存路径
     m_currentSavePath = savePath;
     
-    // 重置解析统计
+    for (const QString &url : urls) {
+        LOG_INFO(QString("Parsing URL: %1").arg(url));
+    }
+    emit logMessage(urls.size() == 1 ? QString("⏳ 正在解析URL，请稍候...")
+                                     : QString("⏳ 正在解析 %1 个URL，请稍候...").arg(urls.size()));
+    
+    // 结果经事件循环送回本线程，返回前登记请求即可
+    const QStringList ids = m_parseWorker->parse(urls);
     {
         QMutexLocker locker(&m_mutex);
-        m_parseTotal = 0;
-        m_parseSuccess = 0;
-        m_parseFailed = 0;
+        for (const QString &id : ids) {
+            m_parseRequests.insert(id, ParseRequest{savePath});
+        }
     }
+    return ids;
+}
+
+void DownloadService::cancelParse(const QString &requestId)
+{
+    m_parseWorker->cancel(requestId);
     
-    LOG_INFO(QString("Parsing URL: %1").arg(url));
-    emit logMessage(QString("⏳ 正在解析URL，请稍候..."));
-    m_urlParser->parse(url);
+    QMutexLocker locker(&m_mutex);
+    m_parseRequests.remove(requestId);
 }
 
-void DownloadService::addTask(const DownloadTask &task)
+void DownloadService::resolveTasks(const QList<DownloadTask> &selected, const QList<DownloadTask> &visible)
+{
+    // 只需要链接和播放列表位置，解析结果按 ID 对应回任务
+    auto toEntries = [](const QList<DownloadTask> &tasks) {
+        QList<ParsedEntry> entries;
+        for (const DownloadTask &task : tasks) {
+            if (task.video.resolved || task.video.url.isEmpty()) {
+                continue;
+            }
+            ParsedEntry entry;
+            entry.id = task.id;
+            entry.vid = task.id;
+            entry.url = task.video.url;
+            entry.title = task.video.title;
+            entry.playlistTitle = task.video.playlistTitle;
+            entry.type = task.type;
+            entry.index = task.index;
+            entry.playlistCount = task.playlistCount;
+            entry.resolved = false;
+            entries.append(entry);
+        }
+        return entries;
+    };
+    m_parseWorker->setWanted(toEntries(selected), toEntries(visible));
+}
+
+void DownloadService::addTask(const DownloadTask &newTask)
 {
     QMutexLocker locker(&m_mutex);
     
+    // 单个添加的任务自成一个提交批次
+    DownloadTask task = newTask;
+    if (task.groupId.isEmpty()) {
+        task.groupId = QString::number(++m_submissionCount);
+    }
+    
     if (m_taskQueue) {
         m_taskQueue->enqueue(task);
         m_pendingTasks.append(task);
         m_totalTasks++;
         m_totalEverAdded++;  // 增加进入过下载列表的总数
         
+        if (m_journal) {
+            m_journal->recordEnqueue({task});
+        }
+        
         LOG_INFO(QString("Task added: %1").arg(task.id));
         emit taskReady(task);
     }
@@ -97,16 +196,44 @@ void DownloadService::addTasks(const QList<DownloadTask> &tasks)
 {
     QMutexLocker locker(&m_mutex);
     
-    for (const auto &task : tasks) {
+    // 每次提交按播放列表分组，公平调度模式下各组轮流占用下载槽位
+    const QString submission = QString::number(++m_submissionCount);
+    QList<DownloadTask> queued;
+    queued.reserve(tasks.size());
+    
+    // 已在下载列表中的任务不再重复入队，否则会被重复计数，完成一次后进度永远到不了 100%
+    QSet<QString> pendingIds;
+    pendingIds.reserve(m_pendingTasks.size());
+    for (const DownloadTask &task : std::as_const(m_pendingTasks)) {
+        pendingIds.insert(task.id);
+    }
+    
+    for (DownloadTask task : tasks) {
+        if (pendingIds.contains(task.id)) {
+            LOG_WARNING(QString("Task already queued, ignored: %1").arg(task.id));
+            continue;
+        }
+        pendingIds.insert(task.id);
+        if (task.groupId.isEmpty()) {
+            task.groupId = task.video.playlistTitle.isEmpty()
+                ? submission
+                : QString("%1/%2").arg(submission, task.video.playlistTitle);
+        }
         if (m_taskQueue) {
             m_taskQueue->enqueue(task);
             m_pendingTasks.append(task);
             m_totalTasks++;
             m_totalEverAdded++;  // 增加进入过下载列表的总数
+            queued.append(task);
         }
     }
     
-    LOG_INFO(QString("Added %1 tasks").arg(tasks.size()));
+    // 整批写入日志，只产生一次文件写入
+    if (m_journal) {
+        m_journal->recordEnqueue(queued);
+    }
+    
+    LOG_INFO(QString("Added %1 tasks").arg(queued.size()));
 }
 
 void DownloadService::removeTask(const QString &taskId)
@@ -122,8 +249,18 @@ void DownloadService::removeTask(const QString &taskId)
     if (it != m_pendingTasks.end()) {
         m_pendingTasks.erase(it);
         m_totalTasks--;
+        m_taskProgress.remove(taskId);
         LOG_INFO(QString("Task removed: %1").arg(taskId));
     }
+    
+    // 同时从调度队列中移除（尚未开始的任务）
+    if (m_taskQueue) {
+        m_taskQueue->removeTask(taskId);
+    }
+    
+    if (m_journal) {
+        m_journal->recordCancel(taskId);
+    }
 }
 
 void DownloadService::clearTasks()
@@ -135,21 +272,180 @@ void DownloadService::clearTasks()
     m_failedTasks.clear();
     m_totalTasks = 0;
     m_completedCount = 0;
-    
-    if (m_taskQueue) {
-        // Note: TaskQueue doesn't have a clear method yet
-        // Tasks will be cleared when queue is stopped
+    m_taskProgress.clear();
+    m_completedBytes = 0;
+    m_completedUnknown = 0;
+    
+    // 只清除尚未开始的任务，正在运行的任务由 stop 控制；
+    // 日志中也只取消这些任务，运行中的任务在结束前崩溃时仍能恢复
+    const QStringList cleared = m_taskQueue ? m_taskQueue->clear() : QStringList();
+    if (m_journal) {
+        m_journal->recordCancel(cleared);
     }
     
     LOG_INFO("All tasks cleared");
 }
 
+bool DownloadService::setTaskPriority(const QString &taskId, int priority)
+{
+    if (!m_taskQueue || !m_taskQueue->setTaskPriority(taskId, priority)) {
+        return false;
+    }
+    
+    QMutexLocker locker(&m_mutex);
+    for (auto &task : m_pendingTasks) {
+        if (task.id == taskId) {
+            task.priority = priority;
+            if (m_journal) {
+                m_journal->recordEnqueue({task});
+            }
+        }
+    }
+    
+    LOG_INFO(QString("Task priority changed: %1 -> %2").arg(taskId).arg(priority));
+    return true;
+}
+
+bool DownloadService::setTaskDeadline(const QString &taskId, const QDateTime &deadline)
+{
+    if (!m_taskQueue || !m_taskQueue->setTaskDeadline(taskId, deadline)) {
+        return false;
+    }
+    
+    QMutexLocker locker(&m_mutex);
+    for (auto &task : m_pendingTasks) {
+        if (task.id == taskId) {
+            task.deadline = deadline;
+            if (m_journal) {
+                m_journal->recordEnqueue({task});
+            }
+        }
+    }
+    
+    LOG_INFO(QString("Task deadline changed: %1 -> %2").arg(taskId, deadline.toString(Qt::ISODate)));
+    return true;
+}
+
+bool DownloadService::moveTaskToFront(const QString &taskId)
+{
+    if (!m_taskQueue || !m_taskQueue->moveTaskToFront(taskId)) {
+        return false;
+    }
+    
+    if (m_journal) {
+        m_journal->recordMoveToFront(taskId);
+    }
+    
+    LOG_INFO(QString("Task moved to front: %1").arg(taskId));
+    return true;
+}
+
+void DownloadService::applyQueueSettings()
+{
+    // 外部工具只在启动时和路径配置修改后在后台查找一次
+    ToolRegistry::Overrides tools;
+    tools.ytdlp = m_configService->getValue("download.ytdlpPath", "").toString();
+    tools.ffmpeg = m_configService->getValue("download.ffmpegPath", "").toString();
+    tools.aria2c = m_configService->getValue("download.aria2cPath", "").toString();
+    ToolRegistry::configure(tools);
+    m_taskQueue->setReactorMode(m_configService->getValue("download.reactorMode", false).toBool());
+    m_taskQueue->setFairShare(m_configService->getValue("download.fairShare", false).toBool());
+    m_taskQueue->setShortestJobFirst(m_configService->getValue("download.shortestJobFirst", false).toBool());
+    m_taskQueue->setBatchSize(m_configService->getValue("download.batchSize", 1).toInt());
+    // 暂停方式：suspend 挂起进程（仅 POSIX），requeue 结束进程并在恢复时续传
+    m_taskQueue->setPauseMode(m_configService->getValue("download.pauseMode", "suspend").toString() == "requeue"
+                                  ? TaskQueue::PauseMode::Requeue
+                                  : TaskQueue::PauseMode::Suspend);
+    m_taskQueue->setHostLimits(m_configService->getValue("download.perHostLimit", 0).toInt(),
+                               m_configService->getValue("download.hostRequestRate", 0.0).toDouble(),
+                               m_configService->getValue("download.hostBurst", 2).toInt());
+    // 全局带宽上限，单位 KB/s，0 表示不限速
+    m_taskQueue->setBandwidthLimit(m_configService->getValue("download.bandwidthLimit", 0).toLongLong() * 1024);
+    // 自适应并发以 threadCount 为起点，上限可单独配置
+    m_taskQueue->setAdaptiveConcurrency(m_configService->getValue("download.adaptiveConcurrency", false).toBool(),
+                                        m_configService->getValue("download.maxAdaptiveThreads", 16).toInt());
+    // 连接预算：在同时运行的任务数和每个任务的并行连接数之间分配，0 表示不限制
+    m_taskQueue->setConnectionBudget(m_configService->getValue("download.connectionBudget", 0).toInt());
+    // 暂存目录（如本地 SSD 或 tmpfs）：下载完成后再移动到保存路径，移动并发数单独限制
+    m_taskQueue->setStaging(m_configService->getValue("download.stagingDir", "").toString(),
+                            m_configService->getValue("download.moverJobs", 2).toInt());
+    // 常驻 yt-dlp 助手：下载和解析复用 Python 进程，处理 helperMaxJobs 个任务后回收
+    YtDlpHelper::Settings helper;
+    helper.enabled = m_configService->getValue("download.useHelper", false).toBool();
+    helper.python = m_configService->getValue("download.helperPython", "").toString();
+    helper.maxJobs = m_configService->getValue("download.helperMaxJobs", 50).toInt();
+    YtDlpHelper::setSettings(helper);
+    // 独立后处理阶段：合并、嵌入缩略图/字幕和转码在下载槽位释放后进行，并发数默认等于 CPU 核数
+    PostProcessor::Settings post;
+    post.enabled = m_configService->getValue("download.postProcessStage", false).toBool();
+    post.maxJobs = m_configService->getValue("download.postProcessJobs", 0).toInt();
+    post.mergeFormat = m_configService->getValue("download.mergeFormat", "mp4").toString();
+    post.embedThumbnail = m_configService->getValue("download.embedThumbnail", false).toBool();
+    post.embedSubtitles = m_configService->getValue("download.embedSubtitles", false).toBool();
+    post.transcodeArgs = m_configService->getValue("download.transcodeArgs", "").toString();
+    PostProcessor::setSettings(post);
+    // 子进程的资源限制：按阶段（下载、解析、后处理）设置 nice、I/O 优先级、CPU 亲和性和 cgroup
+    const auto policyAt = [this](const QString &prefix) {
+        ProcessPolicy::Policy policy;
+        policy.nice = m_configService->getValue(prefix + ".nice", 0).toInt();
+        policy.ioClass = ProcessPolicy::ioClassFromString(m_configService->getValue(prefix + ".ioClass", "").toString());
+        policy.ioLevel = m_configService->getValue(prefix + ".ioLevel", 4).toInt();
+        policy.cpus = ProcessPolicy::cpuListFromString(m_configService->getValue(prefix + ".cpus", "").toString());
+        policy.cgroup = m_configService->getValue(prefix + ".cgroup", false).toBool();
+        policy.memoryMax = m_configService->getValue(prefix + ".memoryMax", "").toString();
+        policy.cpuMax = m_configService->getValue(prefix + ".cpuMax", "").toString();
+        return policy;
+    };
+    ProcessPolicy::Settings processes;
+    processes.download = policyAt("process.download");
+    processes.parse = policyAt("process.parse");
+    processes.postProcess = policyAt("process.postProcess");
+    processes.cgroupRoot = m_configService->getValue("process.cgroupRoot", "").toString();
+    ProcessPolicy::setSettings(processes);
+}
+
+void DownloadService::restoreQueue()
+{
+    QList<DownloadTask> tasks = m_journal->replay();
+    if (tasks.isEmpty()) {
+        return;
+    }
+    
+    {
+        QMutexLocker locker(&m_mutex);
+        for (const DownloadTask &task : tasks) {
+            m_taskQueue->enqueue(task);
+            m_pendingTasks.append(task);
+            m_totalTasks++;
+            m_totalEverAdded++;
+            
+            // 新的提交批次编号不能与恢复的分组重复
+            m_submissionCount = qMax(m_submissionCount, task.groupId.section('/', 0, 0).toInt());
+        }
+    }
+    
+    LOG_INFO(QString("Restored %1 unfinished tasks from %2").arg(tasks.size()).arg(m_journal->path()));
+    
+    // 构造函数中界面还没有连接信号：等事件循环启动后再通知界面，与下面的自动开始下载顺序一致。
+    // 恢复的任务已经在下载队列中，不能作为解析结果送到解析列表，否则会被再次添加
+    QMetaObject::invokeMethod(this, [this, tasks]() {
+        emit tasksRestored(tasks);
+        emit logMessage(QString("♻️ 已恢复 %1 个未完成的下载任务").arg(tasks.size()));
+    }, Qt::QueuedConnection);
+    
+    // 在事件循环启动后再开始下载，保证界面已完成信号连接
+    if (m_configService->getValue("download.resumeOnStartup", false).toBool()) {
+        QMetaObject::invokeMethod(this, &DownloadService::startDownload, Qt::QueuedConnection);
+    }
+}
+
 void DownloadService::startDownload()
 {
     // 更新线程数（从设置中读取）
     if (m_configService && m_taskQueue) {
         int threadCount = m_configService->getValue("download.threadCount", 4).toInt();
         m_taskQueue->setMaxConcurrent(threadCount);
+        applyQueueSettings();
         LOG_INFO(QString("Thread count updated to: %1").arg(threadCount));
     }
     
@@ -238,7 +534,7 @@ void DownloadService::stopDownload()
     m_isPaused = false;
     
     if (m_taskQueue) {
-        m_taskQueue->pauseQueue();
+        m_taskQueue->stopQueue();
     }
     
     m_progressTimer->stop();
@@ -274,15 +570,40 @@ float DownloadService::getProgress() const
 {
     QMutexLocker locker(&m_mutex);
     
-    // 下载进度 = 已完成数 / (已完成数 + 待处理数)
-    // 这样更准确地反映当前下载队列的进度
-    int totalTasks = m_completedCount + m_pendingTasks.size();
+    // 按字节加权：已结束的任务计全部大小，未结束的任务计已下载字节，
+    // 一个大文件下载到一半时整体进度也能反映出来
+    double doneBytes = static_cast<double>(m_completedBytes);
+    double totalBytes = static_cast<double>(m_completedBytes);
+    int known = m_completedCount - m_completedUnknown;
+    // 大小未知的任务按已知任务的平均大小估计，先按比例累计
+    int unknown = m_completedUnknown;
+    double unknownDone = m_completedUnknown;
+    
+    for (const DownloadTask &task : m_pendingTasks) {
+        auto it = m_taskProgress.constFind(task.id);
+        const bool started = it != m_taskProgress.constEnd();
+        // 合并音视频时实际总大小可能超过解析时的预估
+        const qint64 size = qMax(started ? it->totalBytes : 0, task.video.filesize);
+        if (size > 0) {
+            totalBytes += size;
+            doneBytes += started ? qMin(it->downloadedBytes, size) : 0;
+            ++known;
+        } else {
+            ++unknown;
+            unknownDone += started ? it->percent / 100.0 : 0.0;
+        }
+    }
     
-    if (totalTasks == 0) {
+    if (known + unknown == 0) {
         return 0.0f;
     }
     
-    return static_cast<float>(m_completedCount) / static_cast<float>(totalTasks);
+    // 全部未知时退化为按任务数计算
+    const double average = known > 0 ? totalBytes / known : 1.0;
+    totalBytes += unknown * average;
+    doneBytes += unknownDone * average;
+    
+    return totalBytes > 0 ? static_cast<float>(doneBytes / totalBytes) : 0.0f;
 }
 
 QList<DownloadHistoryItem> DownloadService::getHistory() const
@@ -311,35 +632,59 @@ void DownloadService::setupConnections()
 {
     // 连接任务队列信号（使用 QueuedConnection 确保线程安全）
     if (m_taskQueue) {
+        connect(m_taskQueue.get(), &TaskQueue::taskStarted,
+                this, [this](const DownloadTask &task) {
+                    if (m_journal) {
+                        m_journal->recordStart(task.id);
+                    }
+                    emit taskStarted(task);
+                }, Qt::QueuedConnection);
+        connect(m_taskQueue.get(), &TaskQueue::taskProgress,
+                this, &DownloadService::onTaskProgress, Qt::QueuedConnection);
         connect(m_taskQueue.get(), &TaskQueue::taskFinished,
                 this, &DownloadService::onTaskFinished, Qt::QueuedConnection);
         connect(m_taskQueue.get(), &TaskQueue::allFinished,
                 this, &DownloadService::onAllTasksFinished, Qt::QueuedConnection);
         connect(m_taskQueue.get(), &TaskQueue::logMessage,
                 this, &DownloadService::logMessage, Qt::QueuedConnection);
+        // 调整已由 TaskQueue::logMessage 记录，这里只转发
+        connect(m_taskQueue.get(), &TaskQueue::concurrencyChanged,
+                this, &DownloadService::concurrencyChanged, Qt::QueuedConnection);
     }
     
-    // 连接URL解析器信号
-    if (m_urlParser) {
-        // 连接单个条目解析信号（生产者-消费者模式：解析一个就发送一个）
-        connect(m_urlParser.get(), &UrlParser::entryParsed,
-                this, &DownloadService::onEntryParsed);
-        // 保留批量信号用于兼容性
-        connect(m_urlParser.get(), &UrlParser::urlParsed,
-                this, &DownloadService::onUrlParsed);
-        connect(m_urlParser.get(), &UrlParser::errorOccurred,
-                this, &DownloadService::onUrlParseError);
-        connect(m_urlParser.get(), &UrlParser::logMessage,
-                this, &DownloadService::logMessage);
+    // 连接解析线程信号（跨线程，使用 QueuedConnection）
+    if (m_parseWorker) {
+        connect(m_parseWorker, &ParseWorker::entriesParsed,
+                this, &DownloadService::onEntriesParsed, Qt::QueuedConnection);
+        connect(m_parseWorker, &ParseWorker::errorOccurred,
+                this, &DownloadService::onUrlParseError, Qt::QueuedConnection);
+        connect(m_parseWorker, &ParseWorker::finished,
+                this, &DownloadService::onUrlParseFinished, Qt::QueuedConnection);
+        connect(m_parseWorker, &ParseWorker::entryResolved,
+                this, &DownloadService::onEntryResolved, Qt::QueuedConnection);
+        connect(m_parseWorker, &ParseWorker::logBatch,
+                this, [this](const QStringList &messages) {
+                    // 一批日志合并为一条多行消息，界面只追加一次
+                    if (!messages.isEmpty()) {
+                        emit logMessage(messages.join('\n'));
+                    }
+                }, Qt::QueuedConnection);
     }
 }
 
 void DownloadService::updateTaskProgress()
 {
-    emit taskProgress("", getProgress());
+    emit taskProgress("", getProgress(), DownloadProgress());
 }
 
 DownloadTask DownloadService::createDownloadTask(const ParsedEntry &entry, const QString &savePath)
+{
+    DownloadTask task = taskFromEntry(entry, savePath);
+    addTask(task);
+    return task;
+}
+
+DownloadTask DownloadService::taskFromEntry(const ParsedEntry &entry, const QString &savePath) const
 {
     DownloadTask task;
     task.id = entry.id;
@@ -348,12 +693,24 @@ DownloadTask DownloadService::createDownloadTask(const ParsedEntry &entry, const
     task.type = entry.type;
     task.video.title = entry.title;
     task.video.url = entry.url;
+    task.video.playlistTitle = entry.playlistTitle;
     task.video.formatId = entry.formatId;  // 传递格式ID
     task.video.ext = entry.ext;  // 传递扩展名
+    task.video.duration = entry.duration;
+    task.video.filesize = entry.filesize;
+    task.video.resolved = entry.resolved;
     task.savePath = savePath;
     task.resolveTime = QDateTime::currentDateTime();
-    
-    addTask(task);
+    if (m_configService) {
+        // native：可直接下载的单个文件使用内置分段下载，其余情况自动回退到 yt-dlp
+        task.backend = m_configService->getValue("download.backend", "ytdlp").toString() == "native"
+            ? DownloadBackend::Native
+            : DownloadBackend::YtDlp;
+        // yt-dlp 任务的分片并发数由 TaskQueue 按连接预算分配
+        if (task.backend == DownloadBackend::Native) {
+            task.connections = m_configService->getValue("download.segments", 4).toInt();
+        }
+    }
     return task;
 }
 
@@ -372,6 +729,14 @@ void DownloadService::onTaskFinished(const DownloadTask &task)
         m_completedCount++;
         m_completedTasks.append(task);
         
+        // 记录该任务在整体进度中的权重
+        const qint64 size = qMax(m_taskProgress.take(task.id).totalBytes, task.video.filesize);
+        if (size > 0) {
+            m_completedBytes += size;
+        } else {
+            m_completedUnknown++;
+        }
+        
         // 从待处理任务中移除
         auto it = std::find_if(m_pendingTasks.begin(), m_pendingTasks.end(),
                               [&task](const DownloadTask &t) {
@@ -394,16 +759,31 @@ void DownloadService::onTaskFinished(const DownloadTask &task)
     historyItem.savePath = task.savePath;
     historyItem.startTime = task.startTime;
     historyItem.endTime = task.endTime;
-    historyItem.status = DownloadStatus::Success;
+    historyItem.status = task.status;
     
     addHistory(historyItem);
     
+    // 暂停/停止导致的取消不算完成，保留在日志中以便下次启动时恢复
+    if (m_journal && task.status != DownloadStatus::Canceled) {
+        m_journal->recordFinish(task.id);
+    }
+    
     emit taskFinished(task);
     updateTaskProgress();
     
     LOG_INFO(QString("Task completed: %1").arg(task.id));
 }
 
+void DownloadService::onTaskProgress(const DownloadProgress &progress)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_taskProgress.insert(progress.taskId, progress);
+    }
+    
+    emit taskProgress(progress.taskId, static_cast<float>(progress.percent / 100.0), progress);
+}
+
 void DownloadService::onAllTasksFinished()
 {
     QMutexLocker locker(&m_mutex);
@@ -422,81 +802,82 @@ void DownloadService::onTaskError(const QString &taskId, const QString &error)
     LOG_ERROR(QString("Task error [%1]: %2").arg(taskId).arg(error));
 }
 
-void DownloadService::onEntryParsed(const ParsedEntry &entry)
+void DownloadService::onEntriesParsed(const QString &requestId, const QList<ParsedEntry> &entries)
 {
-    QString savePath = m_currentSavePath.isEmpty() ? 
-        m_configService->getValue("download.defaultPath").toString() : 
-        m_currentSavePath;
-    
-    // 更新解析统计
+    // 更新该请求的解析统计
+    ParseRequest request;
     {
         QMutexLocker locker(&m_mutex);
-        m_parseTotal++;
-        m_parseSuccess++;
+        auto it = m_parseRequests.find(requestId);
+        if (it == m_parseRequests.end()) {
+            return;  // 已取消的请求
+        }
+        it->total += entries.size();
+        it->success += entries.size();
+        request = it.value();
     }
     
-    // 创建任务对象并立即发送（生产者-消费者模式：解析一个就显示一个）
-    DownloadTask task;
-    task.id = entry.id;
-    task.index = entry.index;
-    task.playlistCount = entry.playlistCount;
-    task.type = entry.type;
-    task.video.title = entry.title;
-    task.video.url = entry.url;
-    task.video.formatId = entry.formatId;
-    task.video.ext = entry.ext;
-    task.savePath = savePath;
-    task.resolveTime = QDateTime::currentDateTime();
+    QString savePath = request.savePath.isEmpty() ? 
+        m_configService->getValue("download.defaultPath").toString() : 
+        request.savePath;
     
-    // 立即发送 taskReady 信号，UI会立即显示
-    emit taskReady(task);
+    // 整批创建任务对象，界面一次插入一批行
+    QList<DownloadTask> tasks;
+    tasks.reserve(entries.size());
+    for (const ParsedEntry &entry : entries) {
+        tasks.append(taskFromEntry(entry, savePath));
+    }
+    emit tasksReady(tasks);
     
     // 发送解析统计更新信号
-    emit parseStatsUpdated(m_parseTotal, m_parseSuccess, m_parseFailed);
+    emit parseStatsUpdated(requestId, request.total, request.success, request.failed);
 }
 
-void DownloadService::onUrlParsed(const QList<ParsedEntry> &entries)
+void DownloadService::onUrlParseError(const QString &requestId, const QString &error)
 {
-    // 保留用于兼容性，但主要使用 onEntryParsed
-    // 如果某些情况下仍然使用批量信号，这里也会处理
-    QString savePath = m_currentSavePath.isEmpty() ? 
-        m_configService->getValue("download.defaultPath").toString() : 
-        m_currentSavePath;
-    
-    for (const auto &entry : entries) {
-        DownloadTask task;
-        task.id = entry.id;
-        task.index = entry.index;
-        task.playlistCount = entry.playlistCount;
-        task.type = entry.type;
-        task.video.title = entry.title;
-        task.video.url = entry.url;
-        task.video.formatId = entry.formatId;
-        task.video.ext = entry.ext;
-        task.savePath = savePath;
-        task.resolveTime = QDateTime::currentDateTime();
-        
-        emit taskReady(task);
+    // 更新该请求的解析统计
+    ParseRequest request;
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_parseRequests.find(requestId);
+        if (it == m_parseRequests.end()) {
+            return;
+        }
+        it->total++;
+        it->failed++;
+        request = it.value();
     }
     
-    LOG_INFO(QString("URL parsed successfully: %1 entries").arg(entries.size()));
-    emit logMessage(QString("✅ 解析完成，共找到 %1 个视频").arg(entries.size()));
+    emit parseError(requestId, error);
+    LOG_ERROR(QString("URL parse error [%1]: %2").arg(requestId, error));
+    
+    // 发送解析统计更新信号
+    emit parseStatsUpdated(requestId, request.total, request.success, request.failed);
 }
 
-void DownloadService::onUrlParseError(const QString &error)
+void DownloadService::onUrlParseFinished(const QString &requestId)
 {
-    // 更新解析统计
+    ParseRequest request;
     {
         QMutexLocker locker(&m_mutex);
-        m_parseTotal++;
-        m_parseFailed++;
+        if (!m_parseRequests.contains(requestId)) {
+            return;
+        }
+        request = m_parseRequests.take(requestId);
     }
     
-    emit taskError("", error);
-    LOG_ERROR(QString("URL parse error: %1").arg(error));
-    
-    // 发送解析统计更新信号
-    emit parseStatsUpdated(m_parseTotal, m_parseSuccess, m_parseFailed);
+    LOG_INFO(QString("URL parse finished [%1]: %2 entries, %3 errors")
+                 .arg(requestId).arg(request.success).arg(request.failed));
+    if (request.success > 0) {
+        emit logMessage(QString("✅ 解析完成，共找到 %1 个视频").arg(request.success));
+    }
+    emit parseFinished(requestId, request.success, request.failed);
+}
+
+void DownloadService::onEntryResolved(const ParsedEntry &entry)
+{
+    // 解析缓存已在解析线程中更新；保存路径和勾选状态由界面保留，这里只更新视频信息
+    emit taskResolved(taskFromEntry(entry, m_currentSavePath));
 }
 
 void DownloadService::updateProgress()
@@ -19,10 +19,13 @@
 #include <QComboBox>
 #include <QStackedWidget>
 #include <QHeaderView>
+#include <QScrollBar>
+#include <QTimer>
 #include <QSoundEffect>
 #include <QDesktopServices>
 #include <QUrl>
 #include <QDir>
+#include <QRegularExpression>
 
 MainWindow::MainWindow(IDownloadService *downloadService,
                        IConfigService *configService,
@@ -38,10 +41,12 @@ MainWindow::MainWindow(IDownloadService *downloadService,
     , m_videoModel(std::make_unique<VideoModel>(this))
     , m_historyModel(std::make_unique<HistoryModel>(this))
     , m_isFirstTaskInBatch(true)
+    , m_parseBatchSize(0)
     , m_parseTotal(0)
     , m_parseSuccess(0)
     , m_parseFailed(0)
     , m_soundEffect(nullptr)
+    , m_resolveTimer(new QTimer(this))
 {
     ui->setupUi(this);
     
@@ -115,6 +120,8 @@ void MainWindow::setupConnections()
     if (m_downloadService) {
         connect(m_downloadService, &IDownloadService::taskReady,
                 this, &MainWindow::onTaskReady, Qt::QueuedConnection);
+        connect(m_downloadService, &IDownloadService::tasksReady,
+                this, &MainWindow::onTasksReady, Qt::QueuedConnection);
         connect(m_downloadService, &IDownloadService::taskProgress,
                 this, &MainWindow::onDownloadProgress, Qt::QueuedConnection);
         connect(m_downloadService, &IDownloadService::taskFinished,
@@ -127,7 +134,30 @@ void MainWindow::setupConnections()
                 this, &MainWindow::onTaskError, Qt::QueuedConnection);
         connect(m_downloadService, &IDownloadService::parseStatsUpdated,
                 this, &MainWindow::onParseStatsUpdated, Qt::QueuedConnection);
-    }
+        connect(m_downloadService, &IDownloadService::parseError,
+                this, &MainWindow::onParseError, Qt::QueuedConnection);
+        connect(m_downloadService, &IDownloadService::parseFinished,
+                this, &MainWindow::onParseFinished, Qt::QueuedConnection);
+        connect(m_downloadService, &IDownloadService::taskResolved,
+                this, &MainWindow::onTaskResolved, Qt::QueuedConnection);
+        connect(m_downloadService, &IDownloadService::tasksRestored,
+                this, &MainWindow::onTasksRestored, Qt::QueuedConnection);
+    }
+    
+    // 扁平列表中的条目在滚动到可见或被勾选时才解析完整信息
+    m_resolveTimer->setSingleShot(true);
+    m_resolveTimer->setInterval(100);
+    connect(m_resolveTimer, &QTimer::timeout, this, &MainWindow::requestResolve);
+    auto scheduleResolve = [this]() { m_resolveTimer->start(); };
+    connect(ui->tblDownloadList->verticalScrollBar(), &QScrollBar::valueChanged, this, scheduleResolve);
+    connect(m_videoModel.get(), &QAbstractItemModel::rowsInserted, this, scheduleResolve);
+    connect(m_videoModel.get(), &QAbstractItemModel::rowsRemoved, this, scheduleResolve);
+    connect(m_videoModel.get(), &QAbstractItemModel::dataChanged, this,
+            [scheduleResolve](const QModelIndex &, const QModelIndex &, const QList<int> &roles) {
+                if (roles.contains(Qt::CheckStateRole)) {
+                    scheduleResolve();
+                }
+            });
 }
 
 void MainWindow::loadSettings()
@@ -277,11 +307,89 @@ void MainWindow::onTaskReady(const DownloadTask &task)
     }
 }
 
+void MainWindow::onTasksReady(const QList<DownloadTask> &tasks)
+{
+    if (!m_videoModel || tasks.isEmpty()) {
+        return;
+    }
+    
+    // 整批插入，日志只追加一行；大播放列表逐条追加会阻塞界面
+    m_videoModel->addTasks(tasks);
+    ui->tbwLog->append(tasks.size() == 1
+                           ? QString("✅ 视频已解析: %1").arg(tasks.first().video.title)
+                           : QString("✅ 已解析 %1 个视频: %2 …").arg(tasks.size()).arg(tasks.first().video.title));
+    
+    // 列宽只在批次的第一批和解析结束时调整，避免每批都测量所有行
+    if (m_isFirstTaskInBatch) {
+        ui->tblDownloadList->resizeColumnsToContents();
+        ui->stwMain->setCurrentIndex(1);
+        ui->btnDownloadList->setChecked(true);
+        m_isFirstTaskInBatch = false;
+    }
+}
+
+void MainWindow::onTaskResolved(const DownloadTask &task)
+{
+    if (m_videoModel) {
+        m_videoModel->updateTask(task);
+    }
+}
+
+void MainWindow::onTasksRestored(const QList<DownloadTask> &tasks)
+{
+    if (tasks.isEmpty()) {
+        return;
+    }
+    
+    // 恢复的任务已在下载队列中，不放进解析列表（否则勾选后会被再次添加），只显示下载进度；
+    // 解析列表为空时点击下载即可继续
+    updateStatusBar();
+}
+
+void MainWindow::requestResolve()
+{
+    if (!m_downloadService || !m_videoModel) {
+        return;
+    }
+    
+    const QList<DownloadTask*> tasks = m_videoModel->getTasks();
+    
+    // 可见范围：视口顶部到底部的行（最后一屏不满时到最后一行）
+    QTableView *view = ui->tblDownloadList;
+    int first = view->rowAt(0);
+    int last = view->rowAt(view->viewport()->height() - 1);
+    if (first < 0) {
+        first = 0;
+    }
+    if (last < 0 || last >= tasks.size()) {
+        last = tasks.size() - 1;
+    }
+    
+    QList<DownloadTask> selected;
+    QList<DownloadTask> visible;
+    for (int row = 0; row < tasks.size(); ++row) {
+        const DownloadTask *task = tasks.at(row);
+        if (task->video.resolved) {
+            continue;
+        }
+        if (task->isSelected) {
+            selected.append(*task);
+        } else if (row >= first && row <= last) {
+            visible.append(*task);
+        }
+    }
+    m_downloadService->resolveTasks(selected, visible);
+}
+
 void MainWindow::onDownloadProgress(const QString &taskId, float progress)
 {
-    Q_UNUSED(taskId)
     Q_UNUSED(progress)
     
+    // 状态栏只显示整体进度，单个任务的进度更新不需要刷新
+    if (!taskId.isEmpty()) {
+        return;
+    }
+    
     // 添加空指针检查，避免在对象销毁时访问无效成员
     if (!this || !m_downloadService || !ui) {
         return;
@@ -435,11 +543,6 @@ void MainWindow::onLogMessage(const QString &message)
 {
     if (ui && ui->tbwLog) {
         ui->tbwLog->append(message);
-        
-        // 如果解析完成，重新启用解析按钮
-        if (message.contains("解析完成")) {
-            ui->btnCrap->setEnabled(true);
-        }
     }
     LOG_INFO(QString("MainWindow: %1").arg(message));
 }
@@ -485,11 +588,21 @@ void MainWindow::playDownloadCompleteSound()
     }
 }
 
-void MainWindow::onParseStatsUpdated(int total, int success, int failed)
+void MainWindow::onParseStatsUpdated(const QString &requestId, int total, int success, int failed)
 {
-    m_parseTotal = total;
-    m_parseSuccess = success;
-    m_parseFailed = failed;
+    // 状态栏显示当前批次所有请求的合计
+    if (!m_pendingParses.contains(requestId)) {
+        return;
+    }
+    m_parseStats.insert(requestId, ParseStats{total, success, failed});
+    m_parseTotal = 0;
+    m_parseSuccess = 0;
+    m_parseFailed = 0;
+    for (const ParseStats &stats : std::as_const(m_parseStats)) {
+        m_parseTotal += stats.total;
+        m_parseSuccess += stats.success;
+        m_parseFailed += stats.failed;
+    }
     
     // 更新状态栏
     updateStatusBar();
@@ -500,6 +613,34 @@ void MainWindow::onParseStatsUpdated(int total, int success, int failed)
     }
 }
 
+void MainWindow::onParseError(const QString &requestId, const QString &error)
+{
+    ui->tbwLog->append(QString("❌ 解析失败: %1").arg(error));
+    
+    // 只解析一个 URL 时弹窗提示；批量解析时只记录日志，避免连续弹窗
+    if (m_parseBatchSize == 1 && m_pendingParses.contains(requestId)) {
+        QMessageBox::warning(this, "错误", error);
+    }
+}
+
+void MainWindow::onParseFinished(const QString &requestId, int success, int failed)
+{
+    Q_UNUSED(success)
+    Q_UNUSED(failed)
+    
+    if (!m_pendingParses.remove(requestId) || !m_pendingParses.isEmpty()) {
+        return;
+    }
+    
+    // 批次中所有请求都已结束，重新启用解析按钮
+    ui->btnCrap->setEnabled(true);
+    ui->tblDownloadList->resizeColumnsToContents();
+    if (m_parseBatchSize > 1) {
+        ui->tbwLog->append(QString("📋 批量解析结束：%1 个URL，成功 %2 个视频，失败 %3 次")
+                               .arg(m_parseBatchSize).arg(m_parseSuccess).arg(m_parseFailed));
+    }
+}
+
 void MainWindow::on_btnResolve_clicked()
 {
     ui->stwMain->setCurrentIndex(0);
@@ -531,8 +672,9 @@ void MainWindow::on_btnAbout_clicked()
 
 void MainWindow::on_btnCrap_clicked()
 {
-    QString url = ui->edtUrl->text().trimmed();
-    if (url.isEmpty()) {
+    // 支持一次粘贴多个 URL（空白分隔），并发解析
+    const QStringList urls = ui->edtUrl->text().split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
+    if (urls.isEmpty()) {
         QMessageBox::warning(this, "警告", "请输入视频URL");
         return;
     }
@@ -548,7 +690,9 @@ void MainWindow::on_btnCrap_clicked()
     
     if (m_downloadService) {
         // 显示解析状态
-        ui->tbwLog->append(QString("⏳ 开始解析URL: %1").arg(url));
+        for (const QString &url : urls) {
+            ui->tbwLog->append(QString("⏳ 开始解析URL: %1").arg(url));
+        }
         ui->tbwLog->append("📡 正在连接服务器，获取视频信息...");
         
         // 禁用解析按钮，避免重复点击
@@ -557,7 +701,11 @@ void MainWindow::on_btnCrap_clicked()
         // 重置标志，以便下次解析时能自动切换页面
         m_isFirstTaskInBatch = true;
         
-        m_downloadService->parseUrl(url, savePath);
+        // 新的批次：清空上一批次的统计
+        m_parseStats.clear();
+        m_parseBatchSize = urls.size();
+        const QStringList ids = m_downloadService->parseUrls(urls, savePath);
+        m_pendingParses = QSet<QString>(ids.cbegin(), ids.cend());
     }
 }
 
@@ -567,9 +715,13 @@ void MainWindow::on_btnDownload_clicked()
         return;
     }
     
-    // 检查是否有任务
+    // 检查是否有任务；解析列表为空时，下载队列中可能还有从日志恢复的任务
     int rowCount = m_videoModel->rowCount();
     if (rowCount == 0) {
+        if (m_downloadService->getTaskCount() > m_downloadService->getCompletedCount()) {
+            m_downloadService->startDownload();
+            return;
+        }
         QMessageBox::information(this, "提示", "没有可下载的任务");
         return;
     }
@@ -287,7 +287,10 @@ void DownloadWidget::onTaskReady(const DownloadTask &task)
 
 void DownloadWidget::onTaskProgress(const QString &taskId, float progress)
 {
-    Q_UNUSED(taskId)
+    // 这里只显示整体进度，单个任务的进度忽略
+    if (!taskId.isEmpty()) {
+        return;
+    }
     
     m_progressBar->setValue(static_cast<int>(progress * 100));
     
@@ -1,36 +1,109 @@
 #include "utils/downloadutils.h"
 #include "core/interfaces/iconfigservice.h"
+#include "core/download/postprocessor.h"
 #include <QDebug>
 #include <QDir>
+#include <QJsonObject>
 
 namespace znote {
 namespace utils {
 
-QList<QString> buildDownloadCommand(const DownloadTask &task, IConfigService *configService)
+namespace {
+
+// 批量模式下每个条目移动到最终位置后输出的标记行
+const char kBatchDoneMarker[] = "[znote] done ";
+
+// 推迟后处理时每个下载好的流文件输出的标记行：视频ID \t 视频编码 \t 文件路径
+const char kFileMarker[] = "[znote] file ";
+const QString kFileTemplate = QStringLiteral("%(id)s\t%(vcodec)s\t%(filepath)s");
+
+// 推迟后处理时各格式分别下载；没有单独的视频/音频流时退回到单个文件
+const QString kSeparateFormats = QStringLiteral("(bv*,ba)/b");
+
+// 机器可读的进度行：状态 已下载 总大小 预估总大小 速度 剩余时间 视频ID（ID 放最后，可能含空格）
+const char kProgressMarker[] = "[znote] progress ";
+constexpr int kProgressFields = 6;  // 视频ID之前的字段数
+const QString kProgressTemplate = QStringLiteral(
+    "%(progress.status)s %(progress.downloaded_bytes)s %(progress.total_bytes)s "
+    "%(progress.total_bytes_estimate)s %(progress.speed)s %(progress.eta)s %(info.id)s");
+
+// 下载时写入的目录：配置了暂存目录时先写到暂存目录，完成后由 FileMover 移动到 savePath
+QString outputDirectory(const DownloadTask &task)
+{
+    return QDir(task.stagingPath.isEmpty() ? task.savePath : task.stagingPath).absolutePath();
+}
+
+// 除 URL 以外的下载参数，单任务和批量下载共用
+QList<QString> buildDownloadOptions(const DownloadTask &task)
 {
-    Q_UNUSED(configService);
     QList<QString> command;
     
     // 输出路径
-    QString outputPath = QDir(task.savePath).absolutePath();
-    command << "-o" << QString("%1/%(title)s.%(ext)s").arg(outputPath);
+    QString outputPath = outputDirectory(task);
     
-    // 视频质量 - 优先选择视频格式
-    if (!task.video.formatId.isEmpty()) {
-        // 使用指定的格式ID
-        command << "-f" << task.video.formatId;
+    if (task.deferPostProcess) {
+        // 每个格式单独成文件，合并、嵌入缩略图/字幕由后处理阶段完成，
+        // yt-dlp 在数据下载完后即退出，不再占用下载槽位
+        const PostProcessor::Settings post = PostProcessor::settings();
+        command << "-o" << QString("%1/%(title)s.f%(format_id)s.%(ext)s").arg(outputPath);
+        command << "-o" << QString("thumbnail:%1/%(title)s.%(ext)s").arg(outputPath);
+        command << "-o" << QString("subtitle:%1/%(title)s.%(ext)s").arg(outputPath);
+        command << "-f" << (task.video.formatId.isEmpty() ? kSeparateFormats : QString(task.video.formatId).replace('+', ','));
+        if (post.embedThumbnail) {
+            command << "--write-thumbnail";
+        }
+        if (post.embedSubtitles) {
+            command << "--write-subs";
+        }
     } else {
-        // 默认选择最佳视频+音频格式（合并为mp4）
-        // bestvideo+bestaudio 会下载最佳视频和最佳音频，然后合并
-        command << "-f" << "bestvideo+bestaudio/best";
-        // 确保输出格式为mp4
-        command << "--merge-output-format" << "mp4";
+        command << "-o" << QString("%1/%(title)s.%(ext)s").arg(outputPath);
+        
+        // 视频质量 - 优先选择视频格式
+        if (!task.video.formatId.isEmpty()) {
+            // 使用指定的格式ID
+            command << "-f" << task.video.formatId;
+        } else {
+            // 默认选择最佳视频+音频格式（合并为mp4）
+            // bestvideo+bestaudio 会下载最佳视频和最佳音频，然后合并
+            command << "-f" << "bestvideo+bestaudio/best";
+            // 确保输出格式为mp4
+            command << "--merge-output-format" << "mp4";
+        }
+    }
+    
+    // 需要后续处理（后处理阶段或移出暂存目录）时报告每个最终文件；--print 默认会开启安静模式，需要关闭
+    if (task.deferPostProcess || !task.stagingPath.isEmpty()) {
+        command << "--print" << QString("after_move:%1%2").arg(QLatin1String(kFileMarker), kFileTemplate);
+        command << "--no-quiet";
     }
     
     // 其他选项
     command << "--no-playlist"; // 不下载播放列表
     command << "--no-warnings"; // 不显示警告信息
     command << "--progress"; // 显示进度条
+    command << "--newline"; // 每次进度更新单独输出一行，便于解析
+    command << "--progress-template" << QString("download:%1%2").arg(QLatin1String(kProgressMarker), kProgressTemplate);
+    command << "--continue"; // 续传已有的 .part 文件（暂停后重新启动时不会从头下载）
+    
+    // 分片格式（DASH/HLS）并发下载的分片数，由 TaskQueue 按连接预算分配
+    if (task.connections > 1) {
+        command << "-N" << QString::number(task.connections);
+    }
+    
+    // 限速（由 TaskQueue 按全局带宽预算分配）
+    if (task.rateLimit > 0) {
+        command << "--limit-rate" << QString::number(task.rateLimit);
+    }
+    
+    return command;
+}
+
+} // namespace
+
+QList<QString> buildDownloadCommand(const DownloadTask &task, IConfigService *configService)
+{
+    Q_UNUSED(configService);
+    QList<QString> command = buildDownloadOptions(task);
     
     // URL
     command << task.video.url;
@@ -38,6 +111,162 @@ QList<QString> buildDownloadCommand(const DownloadTask &task, IConfigService *co
     return command;
 }
 
+QList<QString> buildBatchDownloadCommand(const QList<DownloadTask> &tasks, const QString &batchFile,
+                                         IConfigService *configService)
+{
+    Q_UNUSED(configService);
+    if (tasks.isEmpty()) {
+        return {};
+    }
+    
+    // 同一批次的任务保存路径、格式和限速相同，参数取第一个任务
+    QList<QString> command = buildDownloadOptions(tasks.first());
+    
+    // 每个条目完成后输出标记行，用于区分各任务的完成；--print 默认会开启安静模式，需要关闭。
+    // 分别下载各格式时 after_move 每个文件触发一次，改为在整个视频处理完后输出
+    command << "--print" << QString("%1:%2%(id)s")
+                                .arg(tasks.first().deferPostProcess ? "after_video" : "after_move")
+                                .arg(QLatin1String(kBatchDoneMarker));
+    command << "--no-quiet";
+    command << "--no-abort-on-error"; // 某个条目失败时继续下载后面的条目
+    
+    // 批处理文件（每行一个 URL）
+    command << "-a" << batchFile;
+    
+    return command;
+}
+
+QList<QString> buildResolveCommand(const DownloadTask &task)
+{
+    QList<QString> command;
+    command << "-j"; // 输出 JSON 信息，隐含只模拟不下载
+    command << "-o" << QString("%1/%(title)s.%(ext)s").arg(outputDirectory(task));
+    if (!task.video.formatId.isEmpty()) {
+        command << "-f" << task.video.formatId;
+    } else {
+        // 内置下载器不能合并音视频，优先选择单个 HTTP 文件
+        command << "-f" << "best[protocol=https]/best[protocol=http]/best";
+    }
+    command << "--no-playlist";
+    command << "--no-warnings";
+    command << task.video.url;
+    return command;
+}
+
+QJsonObject buildHelperDownloadOptions(const DownloadTask &task)
+{
+    // 与 buildDownloadOptions 对应的 YoutubeDL 参数；限速由助手的 set 请求单独设置
+    QJsonObject options;
+    const QString outputPath = outputDirectory(task);
+    options["outtmpl"] = QString("%1/%(title)s.%(ext)s").arg(outputPath);
+    if (task.deferPostProcess) {
+        // 与命令行相同：各格式分别下载，助手通过 file 事件报告每个文件
+        const PostProcessor::Settings post = PostProcessor::settings();
+        QJsonObject outtmpl;
+        outtmpl["default"] = QString("%1/%(title)s.f%(format_id)s.%(ext)s").arg(outputPath);
+        outtmpl["thumbnail"] = QString("%1/%(title)s.%(ext)s").arg(outputPath);
+        outtmpl["subtitle"] = QString("%1/%(title)s.%(ext)s").arg(outputPath);
+        options["outtmpl"] = outtmpl;
+        options["format"] = task.video.formatId.isEmpty() ? kSeparateFormats : QString(task.video.formatId).replace('+', ',');
+        options["writethumbnail"] = post.embedThumbnail;
+        options["writesubtitles"] = post.embedSubtitles;
+    } else if (!task.video.formatId.isEmpty()) {
+        options["format"] = task.video.formatId;
+    } else {
+        options["format"] = "bestvideo+bestaudio/best";
+        options["merge_output_format"] = "mp4";
+    }
+    options["noplaylist"] = true;
+    options["no_warnings"] = true;
+    options["continuedl"] = true;
+    if (task.connections > 1) {
+        options["concurrent_fragment_downloads"] = task.connections;
+    }
+    return options;
+}
+
+bool parseBatchItemDone(QByteArrayView line, QString *taskId)
+{
+    const QByteArrayView marker(kBatchDoneMarker);
+    if (!line.startsWith(marker)) {
+        return false;
+    }
+    *taskId = QString::fromUtf8(line.sliced(marker.size()).trimmed());
+    return !taskId->isEmpty();
+}
+
+bool parseFileMarker(QByteArrayView line, QString *taskId, DownloadedFile *file)
+{
+    const QByteArrayView marker(kFileMarker);
+    if (!line.startsWith(marker)) {
+        return false;
+    }
+
+    // 路径可能包含空格，字段之间用制表符分隔
+    const QByteArrayView rest = line.sliced(marker.size());
+    const qsizetype first = rest.indexOf('\t');
+    const qsizetype second = first < 0 ? -1 : rest.indexOf('\t', first + 1);
+    if (second < 0) {
+        return false;
+    }
+    *taskId = QString::fromUtf8(rest.first(first));
+    file->hasVideo = rest.sliced(first + 1, second - first - 1) != QByteArrayView("none");
+    file->path = QString::fromLocal8Bit(rest.sliced(second + 1));
+    return !file->path.isEmpty();
+}
+
+namespace {
+
+// yt-dlp 对未知字段输出 NA
+qint64 parseNumber(QByteArrayView field, qint64 unknown)
+{
+    bool ok = false;
+    double value = field.toDouble(&ok);
+    return ok ? static_cast<qint64>(value) : unknown;
+}
+
+} // namespace
+
+bool parseProgressLine(QByteArrayView line, DownloadProgress *progress, bool *finished)
+{
+    const QByteArrayView marker(kProgressMarker);
+    if (!line.startsWith(marker)) {
+        return false;
+    }
+
+    // 直接在字节上按空格切分，只为视频ID创建字符串
+    QByteArrayView fields[kProgressFields];
+    QByteArrayView rest = line.sliced(marker.size());
+    for (QByteArrayView &field : fields) {
+        rest = rest.trimmed();
+        const qsizetype space = rest.indexOf(' ');
+        if (space < 0) {
+            return false;
+        }
+        field = rest.first(space);
+        rest = rest.sliced(space + 1);
+    }
+    rest = rest.trimmed();
+    if (rest.isEmpty()) {
+        return false;
+    }
+
+    const qint64 downloaded = parseNumber(fields[1], 0);
+    qint64 total = parseNumber(fields[2], 0);
+    if (total <= 0) {
+        total = parseNumber(fields[3], 0);
+    }
+
+    progress->taskId = QString::fromUtf8(rest);
+    progress->downloadedBytes = downloaded;
+    progress->totalBytes = qMax(total, downloaded);
+    progress->percent = progress->totalBytes > 0 ? downloaded * 100.0 / progress->totalBytes : 0.0;
+    progress->speed = parseNumber(fields[4], 0);
+    progress->eta = static_cast<int>(parseNumber(fields[5], -1));
+    *finished = fields[0] == QByteArrayView("finished");
+    return true;
+}
+
 void printCommand(const QList<QString> &command)
 {
     QString cmdStr = command.join(" ");
@@ -0,0 +1,69 @@
+/**
+ * @file bench_downloaderpool.cpp
+ * @brief Scheduling overhead of pooled workers vs. one thread per task
+ *
+ * Each iteration gets a downloader ready on its own thread and runs one
+ * queued call there, which is what TaskQueue does before a task starts
+ * yt-dlp. The yt-dlp process itself is left out, so the numbers show only
+ * the cost of the threading model.
+ */
+
+#include "core/download/downloaderpool.h"
+#include "core/download/videodownloader.h"
+#include <QThread>
+#include <QtTest>
+
+class BenchDownloaderPool : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void pooled();
+    void pooledReactor();
+    void threadPerTask();
+
+private:
+    static void runPooled(bool reactorMode);
+};
+
+void BenchDownloaderPool::runPooled(bool reactorMode)
+{
+    DownloaderPool pool(4);
+    pool.setReactorMode(reactorMode);
+
+    QBENCHMARK {
+        VideoDownloader *downloader = pool.acquire();
+        QVERIFY(downloader != nullptr);
+        QMetaObject::invokeMethod(downloader, []() {}, Qt::BlockingQueuedConnection);
+        pool.release(downloader);
+    }
+}
+
+void BenchDownloaderPool::pooled()
+{
+    runPooled(false);
+}
+
+void BenchDownloaderPool::pooledReactor()
+{
+    runPooled(true);
+}
+
+void BenchDownloaderPool::threadPerTask()
+{
+    // 与引入线程池之前的 TaskQueue 相同：每个任务创建线程和下载器，结束后销毁
+    QBENCHMARK {
+        QThread *thread = new QThread();
+        VideoDownloader *downloader = new VideoDownloader();
+        downloader->moveToThread(thread);
+        connect(thread, &QThread::finished, downloader, &VideoDownloader::deleteLater);
+        thread->start();
+        QMetaObject::invokeMethod(downloader, []() {}, Qt::BlockingQueuedConnection);
+        thread->quit();
+        thread->wait();
+        delete thread;
+    }
+}
+
+QTEST_GUILESS_MAIN(BenchDownloaderPool)
+#include "bench_downloaderpool.moc"
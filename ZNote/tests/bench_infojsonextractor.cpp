@@ -0,0 +1,64 @@
+/**
+ * @file bench_infojsonextractor.cpp
+ * @brief Decoding cost of yt-dlp info lines: InfoJsonExtractor vs. QJsonDocument
+ *
+ * Both variants turn every recorded line of data/ytdlp_dump.jsonl into a
+ * ParsedEntry with UrlParser::parseSingleEntry(), as the decoder thread
+ * does for a playlist.
+ */
+
+#include "core/download/infojsonextractor.h"
+#include "core/download/urlparser.h"
+#include <QFile>
+#include <QJsonDocument>
+#include <QtTest>
+
+class BenchInfoJsonExtractor : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void extractor();
+    void jsonDocument();
+
+private:
+    QList<QByteArray> m_lines;
+};
+
+void BenchInfoJsonExtractor::initTestCase()
+{
+    QFile file(ZNOTE_TEST_DATA_DIR "/ytdlp_dump.jsonl");
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    for (const QByteArray &line : file.readAll().split('\n')) {
+        if (!line.trimmed().isEmpty()) {
+            m_lines.append(line);
+        }
+    }
+    QVERIFY(!m_lines.isEmpty());
+}
+
+void BenchInfoJsonExtractor::extractor()
+{
+    QBENCHMARK {
+        for (const QByteArray &line : std::as_const(m_lines)) {
+            QJsonObject info;
+            QVERIFY(InfoJsonExtractor::extract(line, &info));
+            QVERIFY(!UrlParser::parseSingleEntry(info).vid.isEmpty());
+        }
+    }
+}
+
+void BenchInfoJsonExtractor::jsonDocument()
+{
+    QBENCHMARK {
+        for (const QByteArray &line : std::as_const(m_lines)) {
+            const QJsonDocument doc = QJsonDocument::fromJson(line);
+            QVERIFY(doc.isObject());
+            QVERIFY(!UrlParser::parseSingleEntry(doc.object()).vid.isEmpty());
+        }
+    }
+}
+
+QTEST_GUILESS_MAIN(BenchInfoJsonExtractor)
+#include "bench_infojsonextractor.moc"
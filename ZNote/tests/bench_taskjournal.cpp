@@ -0,0 +1,96 @@
+/**
+ * @file bench_taskjournal.cpp
+ * @brief Startup cost of restoring a large queue from the task journal
+ *
+ * Writes a journal with 10 000 queued tasks (a tenth of them started), then
+ * measures replay() alone and replay() followed by TaskQueue::enqueue(),
+ * which is what DownloadService::restoreQueue() does before the window is
+ * shown. The target is well under one second for the whole restore.
+ */
+
+#include "core/download/taskjournal.h"
+#include "core/download/taskqueue.h"
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QtTest>
+
+namespace {
+constexpr int kTaskCount = 10000;
+}
+
+class BenchTaskJournal : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void replay();
+    void restore();
+
+private:
+    QTemporaryDir m_dir;
+    QString m_path;
+};
+
+void BenchTaskJournal::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+    m_path = m_dir.filePath("queue.journal");
+
+    QList<DownloadTask> tasks;
+    tasks.reserve(kTaskCount);
+    for (int i = 0; i < kTaskCount; ++i) {
+        DownloadTask task;
+        task.id = QString("task-%1").arg(i);
+        task.index = i % 200 + 1;
+        task.playlistCount = 200;
+        task.type = UrlType::Lists;
+        task.video.title = QString("Playlist entry number %1 with a typical title length").arg(i);
+        task.video.url = QString("https://www.youtube.com/watch?v=%1").arg(i, 11, 36, QChar('0'));
+        task.video.playlistTitle = QString("Playlist %1").arg(i / 200);
+        task.video.formatId = "bv*+ba";
+        task.video.duration = 300 + i % 600;
+        task.savePath = "/home/user/Videos";
+        task.groupId = QString("%1/%2").arg(i / 200 + 1).arg(i / 200);
+        tasks.append(task);
+    }
+
+    TaskJournal journal(m_path);
+    journal.replay();
+    journal.recordEnqueue(tasks);
+    for (int i = 0; i < kTaskCount; i += 10) {
+        journal.recordStart(tasks.at(i).id);
+    }
+}
+
+void BenchTaskJournal::replay()
+{
+    {
+        QElapsedTimer timer;
+        timer.start();
+        TaskJournal journal(m_path);
+        QCOMPARE(journal.replay().size(), kTaskCount);
+        qInfo("first replay of %d tasks: %lld ms", kTaskCount, timer.elapsed());
+    }
+
+    QBENCHMARK {
+        TaskJournal journal(m_path);
+        QCOMPARE(journal.replay().size(), kTaskCount);
+    }
+}
+
+void BenchTaskJournal::restore()
+{
+    QBENCHMARK {
+        TaskJournal journal(m_path);
+        TaskQueue queue(4);
+        const QList<DownloadTask> tasks = journal.replay();
+        for (const DownloadTask &task : tasks) {
+            queue.enqueue(task);
+        }
+        QCOMPARE(queue.getTaskSize(), kTaskCount);
+    }
+}
+
+QTEST_GUILESS_MAIN(BenchTaskJournal)
+#include "bench_taskjournal.moc"
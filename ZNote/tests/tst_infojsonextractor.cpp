@@ -0,0 +1,176 @@
+/**
+ * @file tst_infojsonextractor.cpp
+ * @brief InfoJsonExtractor must give the same entries as a full QJsonDocument parse
+ *
+ * data/ytdlp_dump.jsonl holds `yt-dlp --dump-json` output recorded from a
+ * local test site (a DASH manifest, a direct file, an HTML5 page and a
+ * two-entry playlist). data/ytdlp_dump_edge.jsonl holds variants of the
+ * DASH line with NaN/Infinity values, integers beyond 2^53 and beyond
+ * qint64, \u escapes with surrogate pairs and escaped keys.
+ *
+ * The reference is QJsonDocument::fromJson() on the same line, with the
+ * non-finite tokens replaced by null because QJsonDocument rejects them.
+ */
+
+#include "core/download/infojsonextractor.h"
+#include "core/download/urlparser.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QRegularExpression>
+#include <QtTest>
+#include <limits>
+
+namespace {
+// 与 InfoJsonExtractor 保留的字段一致
+const QStringList kInfoKeys = {
+    "id", "title", "webpage_url", "url", "_type", "duration", "thumbnail", "ext",
+    "filesize", "filesize_approx", "playlist", "playlist_index", "playlist_count", "playlist_title",
+};
+const QStringList kFormatKeys = {
+    "format_id", "ext", "vcodec", "acodec", "height", "filesize", "filesize_approx",
+};
+
+QList<QByteArray> readLines(const QString &name)
+{
+    QFile file(QString(ZNOTE_TEST_DATA_DIR "/%1").arg(name));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+    QList<QByteArray> lines;
+    for (const QByteArray &line : file.readAll().split('\n')) {
+        if (!line.trimmed().isEmpty()) {
+            lines.append(line);
+        }
+    }
+    return lines;
+}
+
+// 测试数据中 NaN/Infinity 只作为值出现，不在字符串中
+QByteArray withNullForNonFinite(const QByteArray &line)
+{
+    static const QRegularExpression nonFinite(R"(([:\[,]\s*)-?(?:NaN|Infinity)(?=\s*[,\]}]))");
+    return QString::fromUtf8(line).replace(nonFinite, "\\1null").toUtf8();
+}
+
+QJsonObject parseFull(const QByteArray &line)
+{
+    QJsonParseError error;
+    const QJsonDocument doc = QJsonDocument::fromJson(withNullForNonFinite(line), &error);
+    return error.error == QJsonParseError::NoError ? doc.object() : QJsonObject();
+}
+
+void compareEntries(const ParsedEntry &actual, const ParsedEntry &expected)
+{
+    QCOMPARE(actual.id, expected.id);
+    QCOMPARE(actual.vid, expected.vid);
+    QCOMPARE(actual.url, expected.url);
+    QCOMPARE(actual.title, expected.title);
+    QCOMPARE(actual.playlistTitle, expected.playlistTitle);
+    QCOMPARE(actual.type, expected.type);
+    QCOMPARE(actual.index, expected.index);
+    QCOMPARE(actual.playlistCount, expected.playlistCount);
+    QCOMPARE(actual.duration, expected.duration);
+    QCOMPARE(actual.filesize, expected.filesize);
+    QCOMPARE(actual.thumbnail, expected.thumbnail);
+    QCOMPARE(actual.formatId, expected.formatId);
+    QCOMPARE(actual.ext, expected.ext);
+    QCOMPARE(actual.resolved, expected.resolved);
+}
+}
+
+class TestInfoJsonExtractor : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void equivalence_data();
+    void equivalence();
+    void edgeValues();
+    void rejectsTruncatedLine();
+};
+
+void TestInfoJsonExtractor::equivalence_data()
+{
+    QTest::addColumn<QByteArray>("line");
+
+    for (const QString &name : {QString("ytdlp_dump.jsonl"), QString("ytdlp_dump_edge.jsonl")}) {
+        const QList<QByteArray> lines = readLines(name);
+        QVERIFY2(!lines.isEmpty(), qPrintable(name));
+        for (int i = 0; i < lines.size(); ++i) {
+            QTest::addRow("%s:%d", qPrintable(name), i + 1) << lines.at(i);
+        }
+    }
+}
+
+void TestInfoJsonExtractor::equivalence()
+{
+    QFETCH(QByteArray, line);
+
+    QJsonObject extracted;
+    QString error;
+    QVERIFY2(InfoJsonExtractor::extract(line, &extracted, &error), qPrintable(error));
+    const QJsonObject full = parseFull(line);
+    QVERIFY(!full.isEmpty());
+
+    // 保留的字段与完整解析的值相同，包括 null 和缺失
+    for (const QString &key : kInfoKeys) {
+        QCOMPARE(extracted.contains(key), full.contains(key));
+        QCOMPARE(extracted.value(key), full.value(key));
+    }
+    const QJsonArray extractedFormats = extracted.value("formats").toArray();
+    const QJsonArray fullFormats = full.value("formats").toArray();
+    QCOMPARE(extractedFormats.size(), fullFormats.size());
+    for (qsizetype i = 0; i < fullFormats.size(); ++i) {
+        const QJsonObject format = extractedFormats.at(i).toObject();
+        const QJsonObject expected = fullFormats.at(i).toObject();
+        for (const QString &key : kFormatKeys) {
+            QCOMPARE(format.contains(key), expected.contains(key));
+            QCOMPARE(format.value(key), expected.value(key));
+        }
+    }
+
+    compareEntries(UrlParser::parseSingleEntry(extracted), UrlParser::parseSingleEntry(full));
+}
+
+void TestInfoJsonExtractor::edgeValues()
+{
+    const QList<QByteArray> lines = readLines("ytdlp_dump_edge.jsonl");
+    QCOMPARE(lines.size(), 3);
+    QJsonObject info;
+
+    // NaN：QJsonDocument 拒绝整行，提取器按 null 读取
+    QVERIFY(QJsonDocument::fromJson(lines.at(0)).isNull());
+    QVERIFY(InfoJsonExtractor::extract(lines.at(0), &info));
+    QVERIFY(info.value("duration").isNull());
+    QVERIFY(info.value("formats").toArray().at(1).toObject().value("height").isNull());
+    QVERIFY(info.value("formats").toArray().at(2).toObject().value("filesize_approx").isNull());
+
+    // 2^53 + 1 和 qint64 最大值保持精确；超出 qint64 的按 double
+    QVERIFY(InfoJsonExtractor::extract(lines.at(1), &info));
+    QCOMPARE(info.value("formats").toArray().at(2).toObject().value("filesize").toInteger(), (Q_INT64_C(1) << 53) + 1);
+    QCOMPARE(info.value("filesize_approx").toInteger(), std::numeric_limits<qint64>::max());
+    QCOMPARE(info.value("formats").toArray().at(0).toObject().value("filesize").toDouble(), 123456789012345678901234.0);
+    QCOMPARE(UrlParser::parseSingleEntry(info).duration, 205);
+
+    // 转义的键和代理对
+    QVERIFY(InfoJsonExtractor::extract(lines.at(2), &info));
+    QCOMPARE(info.value("title").toString(), QString::fromUtf8("Café \U0001F3B5 “Live” \\ /path"));
+    QCOMPARE(info.value("playlist_title").toString(), QString::fromUtf8("\U0001F600 Mix"));
+    QCOMPARE(info.value("playlist_index").toInt(), 3);
+    QCOMPARE(info.value("webpage_url").toString(), QString("http://127.0.0.1:8765/stream.mpd"));
+    QCOMPARE(info.value("formats").toArray().at(2).toObject().value("format_id").toString(), QString("v720"));
+}
+
+void TestInfoJsonExtractor::rejectsTruncatedLine()
+{
+    const QByteArray line = readLines("ytdlp_dump.jsonl").value(0);
+    QVERIFY(!line.isEmpty());
+    QJsonObject info;
+    QString error;
+    QVERIFY(!InfoJsonExtractor::extract(line.left(line.size() / 2), &info, &error));
+    QVERIFY(error.contains("offset"));
+}
+
+QTEST_GUILESS_MAIN(TestInfoJsonExtractor)
+#include "tst_infojsonextractor.moc"
@@ -0,0 +1,153 @@
+/**
+ * @file tst_processpolicy.cpp
+ * @brief ProcessPolicy::apply() checked on a real child process
+ *
+ * Starts `sleep` with a download-stage policy and reads the result back
+ * from /proc and the kernel: nice level, I/O priority, allowed CPUs and
+ * process group. Linux only; cgroups are not covered because they need a
+ * delegated cgroup v2 directory.
+ */
+
+#include "core/download/processpolicy.h"
+#include <QFile>
+#include <QProcess>
+#include <QtTest>
+
+#ifdef Q_OS_LINUX
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+#ifdef Q_OS_LINUX
+constexpr int kNice = 10;
+constexpr int kIoLevel = 7;
+
+QByteArray readProc(qint64 pid, const char *name)
+{
+    QFile file(QString("/proc/%1/%2").arg(pid).arg(name));
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+// /proc/<pid>/stat 中 comm 之后的字段，下标 0 为 state
+QList<QByteArray> statFields(qint64 pid)
+{
+    const QByteArray stat = readProc(pid, "stat");
+    const qsizetype end = stat.lastIndexOf(')');
+    return end < 0 ? QList<QByteArray>() : stat.mid(end + 2).trimmed().split(' ');
+}
+
+QByteArray statusField(qint64 pid, const QByteArray &name)
+{
+    for (const QByteArray &line : readProc(pid, "status").split('\n')) {
+        if (line.startsWith(name + ':')) {
+            return line.mid(name.size() + 1).trimmed();
+        }
+    }
+    return QByteArray();
+}
+
+// 选一个当前进程允许使用的 CPU，容器中不一定包含 CPU 0
+int firstAllowedCpu()
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (::sched_getaffinity(0, sizeof(set), &set) != 0) {
+        return -1;
+    }
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &set)) {
+            return cpu;
+        }
+    }
+    return -1;
+}
+#endif
+}
+
+class TestProcessPolicy : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void cleanup();
+    void appliedToChild();
+    void parseHelpers();
+};
+
+void TestProcessPolicy::cleanup()
+{
+    ProcessPolicy::setSettings(ProcessPolicy::Settings());
+}
+
+void TestProcessPolicy::appliedToChild()
+{
+#ifndef Q_OS_LINUX
+    QSKIP("Reads /proc; Linux only");
+#else
+    const int cpu = firstAllowedCpu();
+    QVERIFY(cpu >= 0);
+
+    ProcessPolicy::Settings settings;
+    settings.download.nice = kNice;
+    settings.download.ioClass = ProcessPolicy::IoClass::BestEffort;
+    settings.download.ioLevel = kIoLevel;
+    settings.download.cpus = {cpu};
+    ProcessPolicy::setSettings(settings);
+
+    QProcess process;
+    process.setProgram("sleep");
+    process.setArguments({"30"});
+    ProcessPolicy::apply(&process, ProcessPolicy::Stage::Download);
+    process.start();
+    QVERIFY2(process.waitForStarted(), qPrintable(process.errorString()));
+    const qint64 pid = process.processId();
+
+    // 没有权限时不能调低 nice 值；测试进程本身已高于 kNice 时保持不变
+    const int ownNice = ::getpriority(PRIO_PROCESS, 0);
+    const QList<QByteArray> fields = statFields(pid);
+    QVERIFY(fields.size() > 16);
+    QCOMPARE(fields.at(16).toInt(), qMax(kNice, ownNice));
+
+    // 子进程自成一个进程组
+    QCOMPARE(fields.at(2).toLongLong(), pid);
+    QCOMPARE(qint64(::getpgid(static_cast<pid_t>(pid))), pid);
+
+    QCOMPARE(statusField(pid, "Cpus_allowed_list"), QByteArray::number(cpu));
+
+    // IOPRIO_WHO_PROCESS；值为 class << 13 | level
+    const long ioprio = ::syscall(SYS_ioprio_get, 1, static_cast<int>(pid));
+    QCOMPARE(ioprio, long((static_cast<int>(ProcessPolicy::IoClass::BestEffort) << 13) | kIoLevel));
+
+    // 其他阶段不受影响
+    QProcess parse;
+    parse.setProgram("sleep");
+    parse.setArguments({"30"});
+    ProcessPolicy::apply(&parse, ProcessPolicy::Stage::Parse);
+    parse.start();
+    QVERIFY(parse.waitForStarted());
+    const QList<QByteArray> parseFields = statFields(parse.processId());
+    QVERIFY(parseFields.size() > 16);
+    QCOMPARE(parseFields.at(16).toInt(), ownNice);
+
+    process.kill();
+    parse.kill();
+    process.waitForFinished();
+    parse.waitForFinished();
+#endif
+}
+
+void TestProcessPolicy::parseHelpers()
+{
+    QCOMPARE(ProcessPolicy::cpuListFromString("0-3,6"), (QList<int>{0, 1, 2, 3, 6}));
+    QVERIFY(ProcessPolicy::cpuListFromString("3-1").isEmpty());
+    QVERIFY(ProcessPolicy::cpuListFromString("x").isEmpty());
+    QCOMPARE(ProcessPolicy::ioClassFromString(" Idle "), ProcessPolicy::IoClass::Idle);
+    QCOMPARE(ProcessPolicy::ioClassFromString("be"), ProcessPolicy::IoClass::BestEffort);
+    QCOMPARE(ProcessPolicy::ioClassFromString("fast"), ProcessPolicy::IoClass::None);
+}
+
+QTEST_GUILESS_MAIN(TestProcessPolicy)
+#include "tst_processpolicy.moc"
@@ -0,0 +1,367 @@
+/**
+ * @file tst_segmenteddownloader.cpp
+ * @brief SegmentedDownloader against a local HTTP server
+ *
+ * RangeServer serves one in-memory file over plain HTTP/1.1 from a
+ * QTcpServer, with "Connection: close" on every response. It can ignore
+ * Range headers, answer every request or every transfer request with an
+ * error status, or cut a transfer off halfway to simulate a dropped
+ * connection. Every Range header it receives is recorded.
+ */
+
+#include "core/download/segmenteddownloader.h"
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QSignalSpy>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QtTest>
+
+namespace {
+// 4 个完整分段（每段至少 1 MiB）加一个不整除的尾部
+constexpr qint64 kFileSize = 4 * 1024 * 1024 + 12345;
+constexpr int kTimeoutMs = 20000;
+
+struct Range
+{
+    qint64 first;
+    qint64 last;
+
+    bool operator==(const Range &other) const
+    {
+        return first == other.first && last == other.last;
+    }
+};
+
+class RangeServer : public QObject
+{
+public:
+    explicit RangeServer(const QByteArray &content, QObject *parent = nullptr)
+        : QObject(parent), m_content(content)
+    {
+        connect(&m_server, &QTcpServer::newConnection, this, [this]() {
+            while (QTcpSocket *socket = m_server.nextPendingConnection()) {
+                connect(socket, &QTcpSocket::readyRead, this, [this, socket]() {
+                    onReadyRead(socket);
+                });
+                connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+                    m_requests.remove(socket);
+                    socket->deleteLater();
+                });
+            }
+        });
+    }
+
+    bool listen()
+    {
+        return m_server.listen(QHostAddress::LocalHost);
+    }
+
+    QUrl url() const
+    {
+        return QUrl(QString("http://127.0.0.1:%1/video.mp4").arg(m_server.serverPort()));
+    }
+
+    bool ignoreRange = false;       ///< Answer every request with 200 and the whole file
+    int errorStatus = 0;            ///< Answer every request with this status (0 = off)
+    int transferErrorStatus = 0;    ///< Same, but only for requests other than the probe
+    int dropsRemaining = 0;         ///< Transfers to cut off after half of their body
+    QList<Range> ranges;            ///< Range headers in arrival order (-1/-1 = none)
+    QList<Range> dropped;           ///< Transfers that were cut off, with the bytes sent
+
+private:
+    void onReadyRead(QTcpSocket *socket)
+    {
+        QByteArray &request = m_requests[socket];
+        request += socket->readAll();
+        if (!request.contains("\r\n\r\n")) {
+            return;
+        }
+        const QByteArray header = request;
+        m_requests.remove(socket);
+        respond(socket, parseRange(header));
+    }
+
+    static Range parseRange(const QByteArray &header)
+    {
+        for (const QByteArray &line : header.split('\n')) {
+            const QByteArray trimmed = line.trimmed();
+            if (!trimmed.toLower().startsWith("range:")) {
+                continue;
+            }
+            // Range: bytes=first-last
+            const QByteArray spec = trimmed.mid(trimmed.indexOf('=') + 1);
+            const qsizetype dash = spec.indexOf('-');
+            return Range{spec.left(dash).toLongLong(), spec.mid(dash + 1).toLongLong()};
+        }
+        return Range{-1, -1};
+    }
+
+    void respond(QTcpSocket *socket, const Range &range)
+    {
+        ranges.append(range);
+        const bool probe = range.first == 0 && range.last == 0;
+
+        const int status = errorStatus > 0 ? errorStatus : (!probe ? transferErrorStatus : 0);
+        if (status > 0) {
+            const QByteArray body = "error page";
+            socket->write("HTTP/1.1 " + QByteArray::number(status) + " Error\r\n"
+                          "Content-Type: text/plain\r\n"
+                          "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+                          "Connection: close\r\n\r\n" + body);
+            socket->disconnectFromHost();
+            return;
+        }
+
+        QByteArray head;
+        QByteArray body;
+        if (ignoreRange || range.first < 0) {
+            head = "HTTP/1.1 200 OK\r\n";
+            body = m_content;
+        } else {
+            const qint64 last = qMin<qint64>(range.last, m_content.size() - 1);
+            head = "HTTP/1.1 206 Partial Content\r\n"
+                   "Content-Range: bytes " + QByteArray::number(range.first) + '-' + QByteArray::number(last)
+                 + '/' + QByteArray::number(m_content.size()) + "\r\n";
+            body = m_content.mid(range.first, last - range.first + 1);
+        }
+        head += "Content-Type: video/mp4\r\n"
+                "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+                "Connection: close\r\n\r\n";
+        socket->write(head);
+
+        // 只发送一半正文就断开，客户端看到的是传输中途连接被关闭
+        if (!probe && dropsRemaining > 0) {
+            --dropsRemaining;
+            const qint64 sent = body.size() / 2;
+            socket->write(body.left(sent));
+            dropped.append(Range{qMax<qint64>(0, range.first), sent});
+            socket->disconnectFromHost();
+            return;
+        }
+
+        socket->write(body);
+        socket->disconnectFromHost();
+    }
+
+    QTcpServer m_server;
+    QByteArray m_content;
+    QHash<QTcpSocket*, QByteArray> m_requests;
+};
+
+QByteArray randomContent(qint64 size)
+{
+    QRandomGenerator random(42);
+    QByteArray content(size, Qt::Uninitialized);
+    for (qint64 i = 0; i < size; ++i) {
+        content[i] = static_cast<char>(random.bounded(256));
+    }
+    return content;
+}
+
+QByteArray readFile(const QString &path)
+{
+    QFile file(path);
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+}
+
+class TestSegmentedDownloader : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void identicalOutput();
+    void resumeAfterDisconnect();
+    void resumeAfterCancel();
+    void fallbackWithoutRange();
+    void notFoundFailsFast();
+    void forbiddenSegmentFailsFast();
+
+private:
+    SegmentedDownloader::Source source(const RangeServer &server, const QString &name) const;
+
+    QByteArray m_content;
+    QTemporaryDir m_dir;
+};
+
+void TestSegmentedDownloader::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+    m_content = randomContent(kFileSize);
+}
+
+SegmentedDownloader::Source TestSegmentedDownloader::source(const RangeServer &server, const QString &name) const
+{
+    SegmentedDownloader::Source source;
+    source.url = server.url();
+    source.filePath = m_dir.filePath(name);
+    return source;
+}
+
+void TestSegmentedDownloader::identicalOutput()
+{
+    RangeServer server(m_content);
+    QVERIFY(server.listen());
+
+    SegmentedDownloader downloader;
+    QSignalSpy finished(&downloader, &SegmentedDownloader::finished);
+    const SegmentedDownloader::Source target = source(server, "identical.mp4");
+    downloader.start(target, 4);
+
+    QVERIFY(finished.wait(kTimeoutMs));
+    QCOMPARE(finished.first().at(0).toBool(), true);
+    QVERIFY(readFile(target.filePath) == m_content);
+    QVERIFY(!QFile::exists(target.filePath + ".part"));
+
+    // 探测请求加 4 个分段
+    QCOMPARE(server.ranges.size(), 5);
+    QCOMPARE(server.ranges.first(), (Range{0, 0}));
+    bool tail = false;
+    for (const Range &range : std::as_const(server.ranges)) {
+        tail = tail || range.last == kFileSize - 1;
+    }
+    QVERIFY(tail);
+}
+
+void TestSegmentedDownloader::resumeAfterDisconnect()
+{
+    RangeServer server(m_content);
+    server.dropsRemaining = 1;
+    QVERIFY(server.listen());
+
+    SegmentedDownloader downloader;
+    QSignalSpy finished(&downloader, &SegmentedDownloader::finished);
+    const SegmentedDownloader::Source target = source(server, "resumed.mp4");
+    downloader.start(target, 4);
+
+    QVERIFY(finished.wait(kTimeoutMs));
+    QCOMPARE(finished.first().at(0).toBool(), true);
+    QVERIFY(readFile(target.filePath) == m_content);
+
+    // 被断开的分段从已写入的位置续传，而不是从分段起点重新下载
+    QCOMPARE(server.dropped.size(), 1);
+    const Range cut = server.dropped.first();
+    bool resumed = false;
+    for (const Range &range : std::as_const(server.ranges)) {
+        resumed = resumed || range.first == cut.first + cut.last;
+    }
+    QVERIFY(resumed);
+    QCOMPARE(server.ranges.size(), 6);
+}
+
+void TestSegmentedDownloader::resumeAfterCancel()
+{
+    RangeServer server(m_content);
+    QVERIFY(server.listen());
+    const SegmentedDownloader::Source target = source(server, "canceled.mp4");
+
+    // 限速保证取消时还没有下载完
+    {
+        SegmentedDownloader downloader;
+        QSignalSpy progress(&downloader, &SegmentedDownloader::progress);
+        QSignalSpy finished(&downloader, &SegmentedDownloader::finished);
+        downloader.setRateLimit(512 * 1024);
+        downloader.start(target, 4);
+        QTRY_VERIFY_WITH_TIMEOUT(!progress.isEmpty() && progress.last().at(0).toLongLong() > 0, kTimeoutMs);
+        downloader.cancel();
+        QVERIFY(finished.wait(kTimeoutMs));
+        QCOMPARE(finished.first().at(0).toBool(), false);
+    }
+    QVERIFY(QFile::exists(target.filePath + ".part"));
+    QVERIFY(QFile::exists(target.filePath + ".part.segments"));
+    const qsizetype firstRun = server.ranges.size();
+
+    SegmentedDownloader downloader;
+    QSignalSpy finished(&downloader, &SegmentedDownloader::finished);
+    downloader.start(target, 4);
+    QVERIFY(finished.wait(kTimeoutMs));
+    QCOMPARE(finished.first().at(0).toBool(), true);
+    QVERIFY(readFile(target.filePath) == m_content);
+    QVERIFY(!QFile::exists(target.filePath + ".part.segments"));
+
+    // 第二次只请求尚未下载的部分（不含探测请求）
+    qint64 requested = 0;
+    for (qsizetype i = firstRun; i < server.ranges.size(); ++i) {
+        const Range &range = server.ranges.at(i);
+        if (!(range == Range{0, 0})) {
+            requested += range.last - range.first + 1;
+        }
+    }
+    QVERIFY(requested > 0);
+    QVERIFY(requested < kFileSize);
+}
+
+void TestSegmentedDownloader::fallbackWithoutRange()
+{
+    RangeServer server(m_content);
+    server.ignoreRange = true;
+    QVERIFY(server.listen());
+
+    SegmentedDownloader downloader;
+    QSignalSpy finished(&downloader, &SegmentedDownloader::finished);
+    QSignalSpy logs(&downloader, &SegmentedDownloader::logMessage);
+    const SegmentedDownloader::Source target = source(server, "single.mp4");
+    downloader.start(target, 4);
+
+    QVERIFY(finished.wait(kTimeoutMs));
+    QCOMPARE(finished.first().at(0).toBool(), true);
+    QVERIFY(readFile(target.filePath) == m_content);
+
+    // 探测请求加一个单连接请求
+    QCOMPARE(server.ranges.size(), 2);
+    bool warned = false;
+    for (const QList<QVariant> &log : std::as_const(logs)) {
+        warned = warned || log.at(0).toString().contains("does not support range");
+    }
+    QVERIFY(warned);
+}
+
+void TestSegmentedDownloader::notFoundFailsFast()
+{
+    RangeServer server(m_content);
+    server.errorStatus = 404;
+    QVERIFY(server.listen());
+
+    SegmentedDownloader downloader;
+    QSignalSpy finished(&downloader, &SegmentedDownloader::finished);
+    const SegmentedDownloader::Source target = source(server, "missing.mp4");
+    QElapsedTimer timer;
+    timer.start();
+    downloader.start(target, 4);
+
+    QVERIFY(finished.wait(kTimeoutMs));
+    QCOMPARE(finished.first().at(0).toBool(), false);
+    // 第一次重试在 1 秒后，失败必须早于它
+    QVERIFY(timer.elapsed() < 1000);
+    QCOMPARE(server.ranges.size(), 1);
+    QVERIFY(!QFile::exists(target.filePath));
+    QVERIFY(!QFile::exists(target.filePath + ".part"));
+}
+
+void TestSegmentedDownloader::forbiddenSegmentFailsFast()
+{
+    RangeServer server(m_content);
+    server.transferErrorStatus = 403;
+    QVERIFY(server.listen());
+
+    SegmentedDownloader downloader;
+    QSignalSpy finished(&downloader, &SegmentedDownloader::finished);
+    const SegmentedDownloader::Source target = source(server, "expired.mp4");
+    QElapsedTimer timer;
+    timer.start();
+    downloader.start(target, 4);
+
+    QVERIFY(finished.wait(kTimeoutMs));
+    QCOMPARE(finished.first().at(0).toBool(), false);
+    QVERIFY(finished.first().at(1).toString().startsWith("Segment"));
+    QVERIFY(timer.elapsed() < 1000);
+    // 没有重试：探测请求之后每个分段最多请求一次
+    QVERIFY(server.ranges.size() <= 5);
+    QVERIFY(!QFile::exists(target.filePath + ".part"));
+}
+
+QTEST_GUILESS_MAIN(TestSegmentedDownloader)
+#include "tst_segmenteddownloader.moc"
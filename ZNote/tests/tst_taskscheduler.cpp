@@ -0,0 +1,137 @@
+/**
+ * @file tst_taskscheduler.cpp
+ * @brief Ordering rules of TaskScheduler
+ *
+ * Completion times of FIFO vs. SJF on a synthetic batch are measured by
+ * bench_taskscheduler.
+ */
+
+#include "core/download/taskscheduler.h"
+#include <QtTest>
+#include <limits>
+
+namespace {
+DownloadTask makeTask(const QString &id, qint64 filesize, int duration = 0)
+{
+    DownloadTask task;
+    task.id = id;
+    task.video.filesize = filesize;
+    task.video.duration = duration;
+    return task;
+}
+}
+
+class TestTaskScheduler : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void estimatedCost();
+    void shortestJobFirstOrder();
+    void fifoWithoutShortestJobFirst();
+    void takeFirstBoundedScan();
+    void duplicatePushReplaces();
+    void moveToFrontKeepsOwnDeadline();
+};
+
+void TestTaskScheduler::estimatedCost()
+{
+    QCOMPARE(TaskScheduler::estimatedCost(makeTask("a", 5000, 60)), qint64(5000));
+    QCOMPARE(TaskScheduler::estimatedCost(makeTask("b", 0, 60)), qint64(60) * 320 * 1024);
+    QCOMPARE(TaskScheduler::estimatedCost(makeTask("c", 0)), std::numeric_limits<qint64>::max());
+}
+
+void TestTaskScheduler::shortestJobFirstOrder()
+{
+    TaskScheduler scheduler;
+    scheduler.setShortestJobFirst(true);
+    scheduler.push(makeTask("unknown-1", 0));
+    scheduler.push(makeTask("large", 100 * 1024 * 1024));
+    scheduler.push(makeTask("duration", 0, 10));   // 10 s -> 3.2 MiB
+    scheduler.push(makeTask("unknown-2", 0));
+    scheduler.push(makeTask("small", 1024 * 1024));
+
+    // 大小未知的排在最后，彼此之间保持入队顺序
+    const QStringList expected = {"small", "duration", "large", "unknown-1", "unknown-2"};
+    QStringList order;
+    while (!scheduler.isEmpty()) {
+        order.append(scheduler.pop().id);
+    }
+    QCOMPARE(order, expected);
+}
+
+void TestTaskScheduler::fifoWithoutShortestJobFirst()
+{
+    TaskScheduler scheduler;
+    scheduler.push(makeTask("unknown", 0));
+    scheduler.push(makeTask("large", 100 * 1024 * 1024));
+    scheduler.push(makeTask("small", 1024 * 1024));
+
+    QCOMPARE(scheduler.pop().id, QString("unknown"));
+    QCOMPARE(scheduler.pop().id, QString("large"));
+    QCOMPARE(scheduler.pop().id, QString("small"));
+}
+
+void TestTaskScheduler::takeFirstBoundedScan()
+{
+    TaskScheduler scheduler;
+    for (int i = 0; i < 10; ++i) {
+        scheduler.push(makeTask(QString::number(i), 1));
+    }
+
+    // 超出扫描上限的任务不交给谓词，即使它会被接受
+    int offered = 0;
+    DownloadTask task;
+    QVERIFY(!scheduler.takeFirst([&](const DownloadTask &candidate) {
+        ++offered;
+        return candidate.id == "5";
+    }, &task, 4));
+    QCOMPARE(offered, 4);
+    QCOMPARE(scheduler.size(), 10);
+
+    QVERIFY(scheduler.takeFirst([](const DownloadTask &candidate) {
+        return candidate.id == "3";
+    }, &task, 4));
+    QCOMPARE(task.id, QString("3"));
+    QCOMPARE(scheduler.size(), 9);
+}
+
+void TestTaskScheduler::duplicatePushReplaces()
+{
+    TaskScheduler scheduler;
+    scheduler.push(makeTask("a", 1));
+    scheduler.push(makeTask("b", 1));
+    DownloadTask again = makeTask("a", 1);
+    again.priority = 5;
+    scheduler.push(again);
+
+    QCOMPARE(scheduler.size(), 2);
+    QCOMPARE(scheduler.peek()->id, QString("a"));
+    QVERIFY(scheduler.remove("a"));
+    QVERIFY(!scheduler.contains("a"));
+    QCOMPARE(scheduler.size(), 1);
+    QCOMPARE(scheduler.pop().id, QString("b"));
+    QVERIFY(scheduler.isEmpty());
+}
+
+void TestTaskScheduler::moveToFrontKeepsOwnDeadline()
+{
+    const QDateTime deadline = QDateTime::fromMSecsSinceEpoch(1700000000000);
+    TaskScheduler scheduler;
+    DownloadTask urgent = makeTask("urgent", 1);
+    urgent.deadline = deadline;
+    scheduler.push(urgent);
+    scheduler.push(makeTask("later", 1));
+
+    QVERIFY(scheduler.moveToFront("later"));
+    // 排到截止时间更早的任务前面，但不继承它的截止时间
+    DownloadTask head = scheduler.pop();
+    QCOMPARE(head.id, QString("later"));
+    QVERIFY(!head.deadline.isValid());
+    DownloadTask next = scheduler.pop();
+    QCOMPARE(next.id, QString("urgent"));
+    QCOMPARE(next.deadline, deadline);
+}
+
+QTEST_GUILESS_MAIN(TestTaskScheduler)
+#include "tst_taskscheduler.moc"